@@ -719,6 +719,36 @@ auto Binder::BindAExpr(duckdb_libpgquery::PGAExpr *root) -> std::unique_ptr<Boun
   BUSTUB_ASSERT(root, "nullptr");
   auto name = std::string((reinterpret_cast<duckdb_libpgquery::PGValue *>(root->name->head->data.ptr_value))->val.str);
 
+  // a [NOT] BETWEEN b AND c is bound as b <= a AND a <= c, or as a < b OR a > c
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN || root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN) {
+    auto bounds = BindExpressionList(reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr));
+    if (bounds.size() != 2) {
+      throw bustub::Exception("BETWEEN should have 2 bounds");
+    }
+    bool negated = root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN;
+    auto lower = std::make_unique<BoundBinaryOp>(negated ? "<" : ">=", BindExpression(root->lexpr),
+                                                 std::move(bounds[0]));
+    auto upper = std::make_unique<BoundBinaryOp>(negated ? ">" : "<=", BindExpression(root->lexpr),
+                                                 std::move(bounds[1]));
+    return std::make_unique<BoundBinaryOp>(negated ? "or" : "and", std::move(lower), std::move(upper));
+  }
+
+  // a [NOT] IN (b, c, ...) is bound as a = b OR a = c ..., or as a <> b AND a <> c ...
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_IN) {
+    auto list = BindExpressionList(reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr));
+    bool negated = name == "<>";
+    std::unique_ptr<BoundExpression> expr = nullptr;
+    for (auto &item : list) {
+      auto cmp = std::make_unique<BoundBinaryOp>(name, BindExpression(root->lexpr), std::move(item));
+      expr = expr == nullptr ? std::move(cmp)
+                             : std::make_unique<BoundBinaryOp>(negated ? "and" : "or", std::move(expr), std::move(cmp));
+    }
+    if (expr == nullptr) {
+      throw bustub::Exception("IN should have at least 1 item");
+    }
+    return expr;
+  }
+
   if (root->kind != duckdb_libpgquery::PG_AEXPR_OP) {
     throw bustub::Exception("unsupported op in AExpr");
   }
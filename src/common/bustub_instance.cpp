@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
+#include <thread>  // NOLINT
 #include <tuple>
 
 #include "binder/binder.h"
@@ -25,6 +27,7 @@
 #include "execution/executors/mock_scan_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/task_scheduler.h"
 #include "fmt/core.h"
 #include "fmt/format.h"
 #include "optimizer/optimizer.h"
@@ -38,7 +41,8 @@
 namespace bustub {
 
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
-  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
+  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_,
+                                           task_scheduler_.get());
 }
 
 BustubInstance::BustubInstance(const std::string &db_file_name) {
@@ -71,6 +75,9 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
+
+  // Workers of parallel pipelines, one per core.
+  SetNumWorkers(std::max(1U, std::thread::hardware_concurrency()));
 }
 
 BustubInstance::BustubInstance() {
@@ -103,6 +110,15 @@ BustubInstance::BustubInstance() {
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
+
+  // Workers of parallel pipelines, one per core.
+  SetNumWorkers(std::max(1U, std::thread::hardware_concurrency()));
+}
+
+void BustubInstance::SetNumWorkers(size_t num_workers) {
+  // The old workers are joined before the new ones start
+  task_scheduler_.reset();
+  task_scheduler_ = std::make_unique<TaskScheduler>(num_workers);
 }
 
 void BustubInstance::CmdDisplayTables(ResultWriter &writer) {
@@ -237,10 +253,20 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
+        // `art` is the parser's default when no `USING` clause is given
+        IndexType index_type;
+        if (index_stmt.index_type_ == "hash") {
+          index_type = IndexType::HashTableIndex;
+        } else if (index_stmt.index_type_ == "art" || index_stmt.index_type_ == "btree") {
+          index_type = IndexType::BPlusTreeIndex;
+        } else {
+          throw NotImplementedException(fmt::format("index type {} is not supported", index_stmt.index_type_));
+        }
+
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
         auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
             txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+            INTEGER_SIZE, IntegerHashFunctionType{}, index_type);
         l.unlock();
 
         if (info == nullptr) {
@@ -391,6 +417,7 @@ BustubInstance::~BustubInstance() {
   if (enable_logging) {
     log_manager_->StopFlushThread();
   }
+  task_scheduler_.reset();
   delete execution_engine_;
   delete catalog_;
   delete checkpoint_manager_;
@@ -20,4 +20,6 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::atomic<size_t> execution_memory_limit(256 * 1024 * 1024);
+
 }  // namespace bustub
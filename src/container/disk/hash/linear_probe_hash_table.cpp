@@ -10,8 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -23,46 +25,371 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                      const KeyComparator &comparator, size_t num_buckets,
-                                      HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+LINEAR_PROBE_HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                   const KeyComparator &comparator, size_t num_buckets,
+                                                   HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = CreateTable(num_buckets);
+}
 
 /*****************************************************************************
- * SEARCH
+ * HELPERS
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage * {
+  return reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetBlockPage(Page *page) -> HASH_TABLE_BLOCK_TYPE * {
+  return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::CreateTable(size_t num_buckets) -> page_id_t {
+  size_t num_blocks = std::max<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1);
+  num_blocks = std::min(num_blocks, HashTableHeaderPage::MaxNumBlocks());
+
+  page_id_t header_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  auto *header_page = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header_page->SetPageId(header_page_id);
+  header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    header_page->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::DeleteTable(page_id_t header_page_id) {
+  auto *header_page = GetHeaderPage(header_page_id);
+  for (size_t i = 0; i < header_page->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(header_page->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <bool Exclusive, typename Visitor>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::ProbeTable(HashTableHeaderPage *header_page, const KeyType &key,
+                                              Visitor &&visitor) -> bool {
+  size_t size = header_page->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % size;
+  for (size_t visited = 0; visited < size;) {
+    page_id_t block_page_id = header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE);
+    Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+    Exclusive ? page->WLatch() : page->RLatch();
+    auto *block = GetBlockPage(page);
+
+    bool stopped = false;
+    bool end_of_run = false;
+    for (auto bucket_ind = static_cast<slot_offset_t>(slot % BLOCK_ARRAY_SIZE);
+         bucket_ind < BLOCK_ARRAY_SIZE && visited < size; bucket_ind++, slot++, visited++) {
+      end_of_run = !block->IsOccupied(bucket_ind);
+      stopped = visitor(block, bucket_ind, slot);
+      if (stopped || end_of_run) {
+        break;
+      }
+    }
+
+    Exclusive ? page->WUnlatch() : page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(block_page_id, Exclusive && stopped);
+    if (stopped || end_of_run) {
+      return stopped;
+    }
+    slot %= size;
+  }
   return false;
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetValueFromTable(HashTableHeaderPage *header_page, const KeyType &key,
+                                                     std::vector<ValueType> *result) -> bool {
+  bool found = false;
+  ProbeTable<false>(header_page, key, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t bucket_ind, size_t slot) {
+    if (block->IsReadable(bucket_ind) && comparator_(block->KeyAt(bucket_ind), key) == 0) {
+      result->push_back(block->ValueAt(bucket_ind));
+      found = true;
+    }
+    return false;
+  });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::ContainsInTable(HashTableHeaderPage *header_page, const KeyType &key,
+                                                   const ValueType &value) -> bool {
+  return ProbeTable<false>(header_page, key,
+                           [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t bucket_ind, size_t slot) {
+                             return block->IsReadable(bucket_ind) &&
+                                    comparator_(block->KeyAt(bucket_ind), key) == 0 &&
+                                    block->ValueAt(bucket_ind) == value;
+                           });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::InsertIntoTable(HashTableHeaderPage *header_page, const KeyType &key,
+                                                   const ValueType &value) -> InsertResult {
+  // Inserts of the same key are serialized, so no duplicate can be claimed between the probe and the claim below
+  std::scoped_lock key_lock(insert_latches_[hash_fn_.GetHash(key) % NUM_INSERT_LATCHES]);
+  size_t size = header_page->GetSize();
+  while (true) {
+    // Look for a duplicate pair, and remember the first reusable slot of the run
+    size_t free_slot = size;
+    bool duplicate =
+        ProbeTable<false>(header_page, key, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t bucket_ind, size_t slot) {
+          if (!block->IsReadable(bucket_ind)) {
+            free_slot = std::min(free_slot, slot);
+            return false;
+          }
+          return comparator_(block->KeyAt(bucket_ind), key) == 0 && block->ValueAt(bucket_ind) == value;
+        });
+    if (duplicate) {
+      return InsertResult::DUPLICATE;
+    }
+    if (free_slot == size) {
+      return InsertResult::FULL;
+    }
+
+    // Claim the slot, a writer of another key may have taken it since the probe
+    page_id_t block_page_id = header_page->GetBlockPageId(free_slot / BLOCK_ARRAY_SIZE);
+    Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+    page->WLatch();
+    auto *block = GetBlockPage(page);
+    auto bucket_ind = static_cast<slot_offset_t>(free_slot % BLOCK_ARRAY_SIZE);
+    bool was_occupied = block->IsOccupied(bucket_ind);
+    bool inserted = block->Insert(bucket_ind, key, value);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(block_page_id, inserted);
+    if (inserted) {
+      if (!was_occupied) {
+        num_occupied_++;
+      }
+      return InsertResult::INSERTED;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::RemoveFromTable(HashTableHeaderPage *header_page, const KeyType &key,
+                                                   const ValueType &value) -> bool {
+  return ProbeTable<true>(header_page, key, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t bucket_ind, size_t slot) {
+    if (block->IsReadable(bucket_ind) && comparator_(block->KeyAt(bucket_ind), key) == 0 &&
+        block->ValueAt(bucket_ind) == value) {
+      block->Remove(bucket_ind);
+      return true;
+    }
+    return false;
+  });
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                            std::vector<ValueType> *result) -> bool {
+  table_latch_.RLock();
+  size_t num_old = result->size();
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    GetValueFromTable(GetHeaderPage(old_header_page_id_), key, result);
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  }
+  size_t num_from_old = result->size();
+  GetValueFromTable(GetHeaderPage(header_page_id_), key, result);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+
+  // A pair migrated while we were probing shows up in both generations
+  if (num_from_old != num_old) {
+    auto old_begin = result->begin() + num_old;
+    auto old_end = result->begin() + num_from_old;
+    result->erase(std::remove_if(old_end, result->end(),
+                                 [&](const ValueType &value) {
+                                   return std::find(old_begin, old_end, value) != old_end;
+                                 }),
+                  result->end());
+  }
+  return result->size() != num_old;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key,
+                                          const ValueType &value) -> bool {
+  while (true) {
+    table_latch_.RLock();
+    auto *header_page = GetHeaderPage(header_page_id_);
+    size_t size = header_page->GetSize();
+    InsertResult result = InsertResult::DUPLICATE;
+    if (old_header_page_id_ == INVALID_PAGE_ID ||
+        !ContainsInTable(GetHeaderPage(old_header_page_id_), key, value)) {
+      result = InsertIntoTable(header_page, key, value);
+    }
+    if (old_header_page_id_ != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    }
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    table_latch_.RUnlock();
+
+    if (result == InsertResult::FULL) {
+      if (!StartResize(size + 1)) {
+        return false;
+      }
+      continue;
+    }
+    if (result == InsertResult::DUPLICATE) {
+      return false;
+    }
+    num_live_++;
+    MigrateBlock();
+    if (num_occupied_ * 4 >= size * 3) {
+      StartResize(0);
+    }
+    return true;
+  }
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key,
+                                          const ValueType &value) -> bool {
+  table_latch_.RLock();
+  bool removed = false;
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    removed = RemoveFromTable(GetHeaderPage(old_header_page_id_), key, value);
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  }
+  if (!removed) {
+    removed = RemoveFromTable(GetHeaderPage(header_page_id_), key, value);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  }
+  table_latch_.RUnlock();
+
+  if (removed) {
+    num_live_--;
+  }
+  MigrateBlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void LINEAR_PROBE_HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  StartResize(2 * initial_size);
+  DrainMigration();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::StartResize(size_t min_num_buckets) -> bool {
+  std::scoped_lock resize_lock(resize_latch_);
+  DrainMigration();
+
+  // Another writer may have resized the table while we were waiting
+  table_latch_.RLock();
+  size_t size = GetHeaderPage(header_page_id_)->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  if (size >= min_num_buckets && num_occupied_ * 4 < size * 3) {
+    return true;
+  }
+
+  // Double the table unless most occupied slots are tombstones, in which case rebuilding at the same size is enough
+  size_t max_size = HashTableHeaderPage::MaxNumBlocks() * BLOCK_ARRAY_SIZE;
+  size_t new_size = std::min(std::max(min_num_buckets, num_live_ * 2 > size ? 2 * size : size), max_size);
+  if (new_size < min_num_buckets || (new_size == size && num_live_ == num_occupied_)) {
+    return false;
+  }
+  page_id_t new_header_page_id = CreateTable(new_size);
+
+  table_latch_.WLock();
+  old_header_page_id_ = header_page_id_;
+  header_page_id_ = new_header_page_id;
+  next_migrate_block_ = 0;
+  migrated_blocks_ = 0;
+  num_occupied_ = 0;
+  table_latch_.WUnlock();
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::MigrateBlock() -> bool {
+  table_latch_.RLock();
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    table_latch_.RUnlock();
+    return false;
+  }
+  auto *old_header_page = GetHeaderPage(old_header_page_id_);
+  size_t num_blocks = old_header_page->NumBlocks();
+  size_t block_idx = next_migrate_block_++;
+  bool finished = false;
+  if (block_idx < num_blocks) {
+    auto *header_page = GetHeaderPage(header_page_id_);
+    page_id_t block_page_id = old_header_page->GetBlockPageId(block_idx);
+    Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+    page->WLatch();
+    auto *block = GetBlockPage(page);
+    for (slot_offset_t bucket_ind = 0; bucket_ind < BLOCK_ARRAY_SIZE; bucket_ind++) {
+      if (block->IsReadable(bucket_ind)) {
+        // Insert before removing, so that concurrent probes of old then new generation always see the pair
+        auto result = InsertIntoTable(header_page, block->KeyAt(bucket_ind), block->ValueAt(bucket_ind));
+        BUSTUB_ENSURE(result != InsertResult::FULL, "the new generation must have room for the old one");
+        block->Remove(bucket_ind);
+      }
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    finished = ++migrated_blocks_ == num_blocks;
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (finished) {
+    table_latch_.WLock();
+    page_id_t old_header_page_id = old_header_page_id_;
+    old_header_page_id_ = INVALID_PAGE_ID;
+    table_latch_.WUnlock();
+    DeleteTable(old_header_page_id);
+    return false;
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::DrainMigration() {
+  while (MigrateBlock()) {
+    std::this_thread::yield();
+  }
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetSize() -> size_t {
+  table_latch_.RLock();
+  size_t size = GetHeaderPage(header_page_id_)->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -38,6 +38,7 @@ Extendible Hash 计算索引的方式是直接取哈希值 H(K) 的低 n 位。
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <mutex>  // NOLINT
 #include <utility>
 
 #include "container/hash/extendible_hash_table.h"
@@ -52,14 +53,14 @@ ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
+auto ExtendibleHashTable<K, V>::IndexOf(const K &key) const -> size_t {
   int mask = (1 << global_depth_) - 1;
   return std::hash<K>()(key) & mask;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::shared_lock<std::shared_mutex> lock(latch_);
   return GetGlobalDepthInternal();
 }
 
@@ -70,7 +71,7 @@ auto ExtendibleHashTable<K, V>::GetGlobalDepthInternal() const -> int {
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::shared_lock<std::shared_mutex> lock(latch_);
   return GetLocalDepthInternal(dir_index);
 }
 
@@ -81,7 +82,7 @@ auto ExtendibleHashTable<K, V>::GetLocalDepthInternal(int dir_index) const -> in
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::shared_lock<std::shared_mutex> lock(latch_);
   return GetNumBucketsInternal();
 }
 
@@ -91,124 +92,153 @@ auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-
-  auto index = IndexOf(key);
-  auto target_bucket = dir_[index];
+auto ExtendibleHashTable<K, V>::GetBucket(const K &key) const -> std::shared_ptr<Bucket> {
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  return dir_[IndexOf(key)];
+}
 
-  return target_bucket->Find(key, value);
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
+  while (true) {
+    auto target_bucket = GetBucket(key);
+    std::shared_lock<std::shared_mutex> bucket_lock(target_bucket->GetLatch());
+    //桶已被分裂，重新从目录中查找
+    if (target_bucket->IsRetired()) {
+      continue;
+    }
+    return target_bucket->Find(key, value);
+  }
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-
-  auto index = IndexOf(key);
-  auto target_bucket = dir_[index];
-
-  return target_bucket->Remove(key);
+  while (true) {
+    auto target_bucket = GetBucket(key);
+    std::unique_lock<std::shared_mutex> bucket_lock(target_bucket->GetLatch());
+    if (target_bucket->IsRetired()) {
+      continue;
+    }
+    return target_bucket->Remove(key);
+  }
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
-  std::scoped_lock<std::mutex> lock(latch_);
-
-  while (dir_[IndexOf(key)]->IsFull()) {
-    auto index = IndexOf(key);
-    auto target_bucket = dir_[index];
-
-    if (target_bucket->GetDepth() == GetGlobalDepthInternal()) {
-      //桶的深度等于全局深度，需要扩容
-      /*
-          global depth++
-          directory 容量翻倍
-          创建一个新的 bucket
-          重新安排指针
-          重新分配 KV 对
-      */
-      global_depth_++;
-      int capacity = dir_.size();
-      dir_.resize(capacity << 1);
-      for (int i = 0; i < capacity; i++) {
-        dir_[i + capacity] = dir_[i];
+  while (true) {
+    auto target_bucket = GetBucket(key);
+    {
+      std::unique_lock<std::shared_mutex> bucket_lock(target_bucket->GetLatch());
+      if (target_bucket->IsRetired()) {
+        continue;
+      }
+      //已存在则更新，桶未满则直接插入，这两种情况都不需要修改目录
+      if (target_bucket->Insert(key, value)) {
+        return;
       }
     }
+    //桶已满，先释放桶锁，再按 目录锁 -> 桶锁 的顺序分裂
+    SplitBucket(target_bucket);
+  }
+}
 
-    int mask = 1 << target_bucket->GetDepth();
-    auto bucket_0 = std::make_shared<Bucket>(bucket_size_, target_bucket->GetDepth() + 1);
-    auto bucket_1 = std::make_shared<Bucket>(bucket_size_, target_bucket->GetDepth() + 1);
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::SplitBucket(const std::shared_ptr<Bucket> &target_bucket) {
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  std::unique_lock<std::shared_mutex> bucket_lock(target_bucket->GetLatch());
+  //释放桶锁期间，其他线程可能已经分裂了这个桶或者删除了其中的键
+  if (target_bucket->IsRetired() || !target_bucket->IsFull()) {
+    return;
+  }
 
-    for (const auto &item : target_bucket->GetItems()) {
-      size_t hash_key = std::hash<K>()(item.first);
-      if ((hash_key & mask) != 0U) {
-        bucket_1->Insert(item.first, item.second);
-      } else {
-        bucket_0->Insert(item.first, item.second);
-      }
+  if (target_bucket->GetDepth() == GetGlobalDepthInternal()) {
+    //桶的深度等于全局深度，需要扩容
+    /*
+        global depth++
+        directory 容量翻倍
+        创建一个新的 bucket
+        重新安排指针
+        重新分配 KV 对
+    */
+    global_depth_++;
+    int capacity = dir_.size();
+    dir_.resize(capacity << 1);
+    for (int i = 0; i < capacity; i++) {
+      dir_[i + capacity] = dir_[i];
     }
+  }
 
-    //桶分裂
-    num_buckets_++;
+  int mask = 1 << target_bucket->GetDepth();
+  auto bucket_0 = std::make_shared<Bucket>(bucket_size_, target_bucket->GetDepth() + 1);
+  auto bucket_1 = std::make_shared<Bucket>(bucket_size_, target_bucket->GetDepth() + 1);
 
-    for (size_t i = 0; i < dir_.size(); i++) {
-      if (dir_[i] == target_bucket) {
-        if ((i & mask) != 0U) {
-          dir_[i] = bucket_1;
-        } else {
-          dir_[i] = bucket_0;
-        }
-      }
+  for (const auto &item : target_bucket->GetItems()) {
+    size_t hash_key = std::hash<K>()(item.first);
+    if ((hash_key & mask) != 0U) {
+      bucket_1->GetItems().push_back(item);
+    } else {
+      bucket_0->GetItems().push_back(item);
     }
   }
 
-  auto index = IndexOf(key);
-  auto target_bucket = dir_[index];
+  //桶分裂
+  num_buckets_++;
 
-  for (auto &item : target_bucket->GetItems()) {
-    if (item.first == key) {
-      item.second = value;
-      return;
+  for (size_t i = 0; i < dir_.size(); i++) {
+    if (dir_[i] == target_bucket) {
+      if ((i & mask) != 0U) {
+        dir_[i] = bucket_1;
+      } else {
+        dir_[i] = bucket_0;
+      }
     }
   }
-
-  target_bucket->Insert(key, value);
+  target_bucket->Retire();
 }
 
 //===--------------------------------------------------------------------===//
 // Bucket
 //===--------------------------------------------------------------------===//
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {}
+ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {
+  items_.reserve(array_size);
+}
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  return std::any_of(list_.begin(), list_.end(), [&key, &value](const auto &item) {
+  for (const auto &item : items_) {
     if (item.first == key) {
       value = item.second;
       return true;
     }
-    return false;
-  });
+  }
+  return false;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  return std::any_of(list_.begin(), list_.end(), [&key, this](const auto &item) {
+  for (auto &item : items_) {
     if (item.first == key) {
-      this->list_.remove(item);
+      //与末尾元素交换后弹出，桶内顺序无关紧要
+      std::swap(item, items_.back());
+      items_.pop_back();
       return true;
     }
-    return false;
-  });
+  }
+  return false;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
+  for (auto &item : items_) {
+    if (item.first == key) {
+      item.second = value;
+      return true;
+    }
+  }
   if (IsFull()) {
     return false;
   }
-  list_.emplace_back(key, value);
+  items_.emplace_back(key, value);
   return true;
 }
 
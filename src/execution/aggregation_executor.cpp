@@ -9,54 +9,453 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <memory>
 #include <vector>
 
+#include "common/config.h"
 #include "execution/executors/aggregation_executor.h"
 
 namespace bustub {
 
+void AggregationHashTable::Merge(AggregationHashTable *other) {
+  if (Size() == 0) {
+    std::swap(blocks_, other->blocks_);
+    std::swap(hashes_, other->hashes_);
+    std::swap(states_, other->states_);
+    std::swap(slots_, other->slots_);
+    std::swap(varlen_bytes_, other->varlen_bytes_);
+    other->Clear();
+    return;
+  }
+  for (size_t group = 0; group < other->Size(); group++) {
+    MergeGroup(*other, group);
+  }
+  other->Clear();
+}
+
+void AggregationHashTable::MergeGroup(const AggregationHashTable &other, size_t group) {
+  auto target = FindOrInsert(other.GetGroupBys(group), other.GetHash(group));
+  Value *aggregates = Row(target) + num_group_bys_;
+  const Value *partials = other.Row(group) + num_group_bys_;
+  for (size_t i = 0; i < kernels_.size(); i++) {
+    if (kernels_[i] == AggregateKernel::VALUE) {
+      MergeAggregateValue(i, &aggregates[i], partials[i]);
+      continue;
+    }
+    const auto *partial = other.State(group, i);
+    if (!partial->valid_) {
+      continue;
+    }
+    auto *state = State(target, i);
+    switch (kernels_[i]) {
+      case AggregateKernel::COUNT_STAR:
+        AggregateOp<AggregateKernel::COUNT_STAR>::Merge(state, partial->value_);
+        break;
+      case AggregateKernel::COUNT:
+        AggregateOp<AggregateKernel::COUNT>::Merge(state, partial->value_);
+        break;
+      case AggregateKernel::SUM_INTEGER:
+        AggregateOp<AggregateKernel::SUM_INTEGER>::Merge(state, partial->value_);
+        break;
+      case AggregateKernel::MIN_INTEGER:
+        AggregateOp<AggregateKernel::MIN_INTEGER>::Merge(state, partial->value_);
+        break;
+      case AggregateKernel::MAX_INTEGER:
+        AggregateOp<AggregateKernel::MAX_INTEGER>::Merge(state, partial->value_);
+        break;
+      case AggregateKernel::VALUE:
+        break;
+    }
+  }
+}
+
+void AggregationHashTable::CombineBatch(const std::vector<uint32_t> &groups,
+                                        const std::vector<const std::vector<Value> *> &inputs) {
+  if (groups.empty()) {
+    return;
+  }
+  size_t stride = kernels_.size();
+  for (size_t i = 0; i < kernels_.size(); i++) {
+    //每个聚合在整列输入上运行一次特化的循环
+    switch (kernels_[i]) {
+      case AggregateKernel::COUNT_STAR:
+        CombineColumn<AggregateKernel::COUNT_STAR>(groups, *inputs[i], &states_[i], stride);
+        break;
+      case AggregateKernel::COUNT:
+        CombineColumn<AggregateKernel::COUNT>(groups, *inputs[i], &states_[i], stride);
+        break;
+      case AggregateKernel::SUM_INTEGER:
+        CombineColumn<AggregateKernel::SUM_INTEGER>(groups, *inputs[i], &states_[i], stride);
+        break;
+      case AggregateKernel::MIN_INTEGER:
+        CombineColumn<AggregateKernel::MIN_INTEGER>(groups, *inputs[i], &states_[i], stride);
+        break;
+      case AggregateKernel::MAX_INTEGER:
+        CombineColumn<AggregateKernel::MAX_INTEGER>(groups, *inputs[i], &states_[i], stride);
+        break;
+      case AggregateKernel::VALUE:
+        for (size_t row = 0; row < groups.size(); row++) {
+          CombineAggregateValue(i, Row(groups[row]) + num_group_bys_ + i, (*inputs[i])[row]);
+        }
+        break;
+    }
+  }
+}
+
+void AggregationHashTable::InsertMerge(const Value *group_bys, hash_t hash, const Value *partial) {
+  auto group = FindOrInsert(group_bys, hash);
+  Value *aggregates = Row(group) + num_group_bys_;
+  for (size_t i = 0; i < kernels_.size(); i++) {
+    auto *state = State(group, i);
+    switch (kernels_[i]) {
+      case AggregateKernel::COUNT_STAR:
+        MergeState<AggregateKernel::COUNT_STAR>(state, partial[i]);
+        break;
+      case AggregateKernel::COUNT:
+        MergeState<AggregateKernel::COUNT>(state, partial[i]);
+        break;
+      case AggregateKernel::SUM_INTEGER:
+        MergeState<AggregateKernel::SUM_INTEGER>(state, partial[i]);
+        break;
+      case AggregateKernel::MIN_INTEGER:
+        MergeState<AggregateKernel::MIN_INTEGER>(state, partial[i]);
+        break;
+      case AggregateKernel::MAX_INTEGER:
+        MergeState<AggregateKernel::MAX_INTEGER>(state, partial[i]);
+        break;
+      case AggregateKernel::VALUE:
+        MergeAggregateValue(i, &aggregates[i], partial[i]);
+        break;
+    }
+  }
+}
+
+auto AggregationHashTable::GetRow(size_t group) -> const Value * {
+  Value *row = Row(group);
+  for (size_t i = 0; i < kernels_.size(); i++) {
+    if (kernels_[i] != AggregateKernel::VALUE) {
+      row[num_group_bys_ + i] = AggregateStateToValue(*State(group, i));
+    }
+  }
+  return row;
+}
+
+void AggregationHashTable::Clear() {
+  blocks_.clear();
+  std::vector<hash_t>().swap(hashes_);
+  std::vector<AggregateState>().swap(states_);
+  std::vector<Slot>().swap(slots_);
+  varlen_bytes_ = 0;
+}
+
+auto AggregationHashTable::GroupEquals(size_t group, const Value *group_bys) const -> bool {
+  const Value *row = Row(group);
+  for (size_t i = 0; i < num_group_bys_; i++) {
+    if (row[i].IsNull() || group_bys[i].IsNull()) {
+      if (row[i].IsNull() != group_bys[i].IsNull()) {
+        return false;
+      }
+    } else if (row[i].CompareEquals(group_bys[i]) != CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto AggregationHashTable::FindOrInsert(const Value *group_bys, hash_t hash) -> uint32_t {
+  // Keep the table at most half full
+  if ((Size() + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  // Linear probing, the hash is compared first so that the group-by values are only compared on a likely hit
+  size_t mask = slots_.size() - 1;
+  size_t idx = hash & mask;
+  for (; slots_[idx].group_ != NO_GROUP; idx = (idx + 1) & mask) {
+    if (slots_[idx].hash_ == hash && GroupEquals(slots_[idx].group_, group_bys)) {
+      return slots_[idx].group_;
+    }
+  }
+
+  auto group = static_cast<uint32_t>(Size());
+  if (group % ROWS_PER_BLOCK == 0) {
+    blocks_.push_back(std::make_unique<Value[]>(ROWS_PER_BLOCK * RowWidth()));
+  }
+  Value *row = Row(group);
+  for (size_t i = 0; i < num_group_bys_; i++) {
+    row[i] = group_bys[i];
+    if (row[i].GetTypeId() == TypeId::VARCHAR && !row[i].IsNull()) {
+      varlen_bytes_ += row[i].GetLength();
+    }
+  }
+  for (size_t i = 0; i < kernels_.size(); i++) {
+    if (kernels_[i] == AggregateKernel::VALUE) {
+      row[num_group_bys_ + i] = GenerateInitialAggregateValue(i);
+    }
+    states_.push_back(InitialAggregateState(kernels_[i]));
+  }
+  hashes_.push_back(hash);
+  slots_[idx] = Slot{hash, group};
+  return group;
+}
+
+void AggregationHashTable::Grow() {
+  std::vector<Slot> old_slots(std::max<size_t>(slots_.size() * 2, 16));
+  std::swap(slots_, old_slots);
+  size_t mask = slots_.size() - 1;
+  for (const auto &slot : old_slots) {
+    if (slot.group_ == NO_GROUP) {
+      continue;
+    }
+    // Groups are distinct, so the first empty slot is the right one
+    size_t idx = slot.hash_ & mask;
+    while (slots_[idx].group_ != NO_GROUP) {
+      idx = (idx + 1) & mask;
+    }
+    slots_[idx] = slot;
+  }
+}
+
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
     : AbstractExecutor(exec_ctx),
       plan_(plan),
       child_(std::move(child)),
-      aht_(plan_->aggregates_, plan_->agg_types_),
-      aht_iterator_(aht_.Begin()) {}
+      aht_(plan_->aggregates_, plan_->agg_types_, plan_->GetGroupBys().size()) {}
 
 //在 Aggregation 的 Init() 函数中，我们就要将所有结果全部计算出来
 void AggregationExecutor::Init() {
-  child_->Init();
-  Tuple tuple{};
-  RID rid{};
-  while (child_->Next(&tuple, &rid)) {
-    //在下层算子传来一个 tuple 时，将 tuple 的 group by 字段和 aggregate 字段分别提取出来，
-    //调用 InsertCombine() 将 group by 和 aggregate 的映射关系存入 SimpleAggregationHashTable。
-    aht_.InsertCombine(MakeAggregateKey(&tuple), MakeAggregateValue(&tuple));
+  aht_.Clear();
+  group_idx_ = 0;
+  spill_files_.clear();
+  spill_depth_ = 0;
+  pending_partitions_.clear();
+  merged_tables_.clear();
+  merged_table_idx_ = 0;
+
+  //下层是 扫描/过滤/投影 组成的流水线时，交给工作线程并行聚合
+  auto pipeline = ParallelPipeline::Make(exec_ctx_, plan_->GetChildPlan());
+  if (pipeline != nullptr) {
+    AggregateParallel(pipeline.get());
+  } else {
+    child_->Init();
+    spill_files_.resize(1);
+    //按批次从下层算子取数据，哈希表超出内存预算时溢出到磁盘
+    TupleBatch batch{};
+    while (child_->NextBatch(&batch)) {
+      AggregateBatch(&aht_, batch);
+      if (aht_.MemoryUsage() > execution_memory_limit) {
+        SpillGroups(&aht_, 0);
+      }
+    }
+    if (!spill_files_[0].empty()) {
+      SpillGroups(&aht_, 0);
+    }
+  }
+  FinishSpill();
+  if (!pending_partitions_.empty() || !merged_tables_.empty()) {
+    LoadNextPartition();
+    return;
   }
   if (aht_.Size() == 0 && GetOutputSchema().GetColumnCount() == 1) {
     aht_.InsertIntialCombine();
   }
-  //将迭代器aht_iterator_初始化为哈希表的begin
-  aht_iterator_ = aht_.Begin();
 }
 
-//在 Next() 中直接利用 hashmap iterator 将结果依次取出。
+void AggregationExecutor::AggregateBatch(AggregationHashTable *aht, const TupleBatch &batch) {
+  //group by 字段和 aggregate 字段都按列整批求值
+  //列引用直接读取批次中已解码的列，不做拷贝
+  std::vector<std::vector<Value>> scratch(plan_->GetGroupBys().size() + plan_->GetAggregates().size());
+  std::vector<const std::vector<Value> *> group_by_columns(plan_->GetGroupBys().size());
+  std::vector<const std::vector<Value> *> aggregate_columns(plan_->GetAggregates().size());
+  for (size_t i = 0; i < group_by_columns.size(); i++) {
+    group_by_columns[i] = &plan_->GetGroupBys()[i]->EvaluateBatchRef(batch, &scratch[i]);
+  }
+  for (size_t i = 0; i < aggregate_columns.size(); i++) {
+    aggregate_columns[i] = &plan_->GetAggregates()[i]->EvaluateBatchRef(batch, &scratch[group_by_columns.size() + i]);
+  }
+  //先逐行找到（或创建）所属分组，再按列把 aggregate 字段合并到各分组中
+  std::vector<Value> group_bys(group_by_columns.size());
+  std::vector<uint32_t> groups(batch.Size());
+  for (size_t row = 0; row < batch.Size(); row++) {
+    for (size_t i = 0; i < group_by_columns.size(); i++) {
+      group_bys[i] = (*group_by_columns[i])[row];
+    }
+    groups[row] = aht->FindOrInsert(group_bys.data(), aht->HashGroupBys(group_bys.data()));
+  }
+  aht->CombineBatch(groups, aggregate_columns);
+}
+
+void AggregationExecutor::AggregateParallel(ParallelPipeline *pipeline) {
+  pipeline->Open();
+  //每个工作线程聚合到自己的局部哈希表中，无需加锁，结束后再合并
+  //局部哈希表超出各自的内存预算时，由该线程溢出到自己的分区文件中
+  size_t num_workers = pipeline->NumWorkers();
+  std::vector<AggregationHashTable> local_tables;
+  local_tables.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; i++) {
+    local_tables.emplace_back(plan_->aggregates_, plan_->agg_types_, plan_->GetGroupBys().size());
+  }
+  spill_files_.resize(num_workers);
+  size_t worker_limit = execution_memory_limit / num_workers;
+  pipeline->Run([this, &local_tables, worker_limit](size_t worker_id, size_t morsel_idx, TupleBatch *batch) {
+    AggregateBatch(&local_tables[worker_id], *batch);
+    if (local_tables[worker_id].MemoryUsage() > worker_limit) {
+      SpillGroups(&local_tables[worker_id], worker_id);
+    }
+  });
+
+  bool spilled =
+      std::any_of(spill_files_.begin(), spill_files_.end(), [](const auto &files) { return !files.empty(); });
+  if (spilled) {
+    for (size_t i = 0; i < num_workers; i++) {
+      SpillGroups(&local_tables[i], i);
+    }
+    return;
+  }
+  size_t num_groups = 0;
+  for (const auto &local_table : local_tables) {
+    num_groups += local_table.Size();
+  }
+  if (num_workers > 1 && num_groups >= PARALLEL_MERGE_MIN_GROUPS) {
+    MergePartitioned(&local_tables);
+    return;
+  }
+  for (auto &local_table : local_tables) {
+    aht_.Merge(&local_table);
+  }
+}
+
+void AggregationExecutor::MergePartitioned(std::vector<AggregationHashTable> *local_tables) {
+  auto *scheduler = exec_ctx_->GetTaskScheduler();
+  size_t num_partitions = 1 << MERGE_RADIX_BITS;
+
+  //第一步：每个工作线程把自己局部表中的分组按哈希值分区
+  std::vector<std::vector<std::vector<uint32_t>>> partition_groups(local_tables->size());
+  scheduler->ParallelFor(local_tables->size(), [&](size_t worker_id, size_t table_idx) {
+    const auto &local_table = (*local_tables)[table_idx];
+    auto &groups = partition_groups[table_idx];
+    groups.resize(num_partitions);
+    for (size_t group = 0; group < local_table.Size(); group++) {
+      groups[HashUtil::RadixPartition(local_table.GetHash(group), MERGE_RADIX_BITS)].push_back(
+          static_cast<uint32_t>(group));
+    }
+  });
+
+  //第二步：每个分区由一个工作线程合并所有局部表中属于该分区的分组
+  merged_tables_.reserve(num_partitions);
+  for (size_t i = 0; i < num_partitions; i++) {
+    merged_tables_.emplace_back(plan_->aggregates_, plan_->agg_types_, plan_->GetGroupBys().size());
+  }
+  //局部表逐个合并，合并完即释放，这样局部表和合并后的表不会同时全部驻留在内存中
+  for (size_t table_idx = 0; table_idx < local_tables->size(); table_idx++) {
+    auto &local_table = (*local_tables)[table_idx];
+    auto &groups = partition_groups[table_idx];
+    scheduler->ParallelFor(num_partitions, [&](size_t worker_id, size_t partition) {
+      merged_tables_[partition].Merge(local_table, groups[partition]);
+    });
+    local_table.Clear();
+    std::vector<std::vector<uint32_t>>().swap(groups);
+  }
+}
+
+void AggregationExecutor::SpillGroups(AggregationHashTable *aht, size_t spiller) {
+  auto &files = spill_files_[spiller];
+  if (files.empty()) {
+    for (size_t i = 0; i < (1 << SPILL_RADIX_BITS); i++) {
+      files.push_back(std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager()));
+    }
+  }
+  //每一层使用哈希值的下一段比特分区，这样再次溢出的分区能继续被切分
+  for (size_t group = 0; group < aht->Size(); group++) {
+    auto partition = HashUtil::RadixPartition(aht->GetHash(group), SPILL_RADIX_BITS * (spill_depth_ + 1)) &
+                     ((1 << SPILL_RADIX_BITS) - 1);
+    files[partition]->Append(MakeOutputTuple(aht, group));
+  }
+  aht->Clear();
+}
+
+void AggregationExecutor::FinishSpill() {
+  for (size_t partition = 0; partition < (1 << SPILL_RADIX_BITS); partition++) {
+    SpilledPartition spilled{{}, spill_depth_ + 1};
+    for (auto &files : spill_files_) {
+      if (!files.empty() && files[partition]->NumTuples() > 0) {
+        spilled.files_.push_back(std::move(files[partition]));
+      }
+    }
+    if (!spilled.files_.empty()) {
+      pending_partitions_.push_back(std::move(spilled));
+    }
+  }
+  spill_files_.clear();
+}
+
+auto AggregationExecutor::LoadNextPartition() -> bool {
+  //并行合并得到的分区表已在内存中，直接换入
+  while (merged_table_idx_ < merged_tables_.size()) {
+    aht_.Clear();
+    group_idx_ = 0;
+    aht_.Merge(&merged_tables_[merged_table_idx_++]);
+    if (aht_.Size() > 0) {
+      return true;
+    }
+  }
+  while (!pending_partitions_.empty()) {
+    auto partition = std::move(pending_partitions_.back());
+    pending_partitions_.pop_back();
+    aht_.Clear();
+    group_idx_ = 0;
+    spill_depth_ = partition.depth_;
+    spill_files_.resize(1);
+
+    //读回的每一行都是某个分组的部分聚合结果，按分组合并
+    Tuple tuple;
+    std::vector<Value> row(aht_.RowWidth());
+    size_t num_group_bys = plan_->GetGroupBys().size();
+    for (auto &file : partition.files_) {
+      while (file->Next(&tuple)) {
+        for (size_t i = 0; i < row.size(); i++) {
+          row[i] = tuple.GetValue(&GetOutputSchema(), i);
+        }
+        aht_.InsertMerge(row.data(), aht_.HashGroupBys(row.data()), row.data() + num_group_bys);
+        if (aht_.MemoryUsage() > execution_memory_limit && spill_depth_ < MAX_SPILL_DEPTH) {
+          SpillGroups(&aht_, 0);
+        }
+      }
+    }
+    if (!spill_files_[0].empty()) {
+      SpillGroups(&aht_, 0);
+    }
+    FinishSpill();
+    if (aht_.Size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//在 Next() 中按分组顺序将结果依次取出，当前分区输出完后再加载下一个溢出的分区。
 
 auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (aht_iterator_ == aht_.End()) {
+  if (group_idx_ == aht_.Size() && !LoadNextPartition()) {
     return false;
   }
-  std::vector<Value> values;
-  //Aggregation 输出的 schema 形式为 group-bys + aggregates。
-  values.insert(values.end(), aht_iterator_.Key().group_bys_.begin(), aht_iterator_.Key().group_bys_.end());
-  values.insert(values.end(), aht_iterator_.Val().aggregates_.begin(), aht_iterator_.Val().aggregates_.end());
-  
-  *tuple = Tuple{values, &GetOutputSchema()};
-  ++aht_iterator_;
+  *tuple = MakeOutputTuple(&aht_, group_idx_++);
   return true;
 }
 
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (group_idx_ == aht_.Size() && !LoadNextPartition()) {
+      break;
+    }
+    const Value *row = aht_.GetRow(group_idx_++);
+    batch->Append(std::vector<Value>(row, row + aht_.RowWidth()), RID{});
+  }
+  return !batch->IsEmpty();
+}
+
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 
 }  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_heap_scan_executor.cpp
+//
+// Identification: src/execution/bitmap_heap_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/bitmap_heap_scan_executor.h"
+#include <algorithm>
+
+#include "execution/executors/index_scan_executor.h"
+
+namespace bustub {
+BitmapHeapScanExecutor::BitmapHeapScanExecutor(ExecutorContext *exec_ctx, const BitmapHeapScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      table_info_{this->exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())},
+      row_reader_{exec_ctx, table_info_, "BitmapHeapScan"},
+      residual_{plan_->residual_predicate_} {}
+
+void BitmapHeapScanExecutor::Init() {
+  row_reader_.LockTable();
+  //各子句的位图求与，为空后就不必再查后面的索引
+  RidBitmap bitmap;
+  for (size_t i = 0; i < plan_->clauses_.size(); i++) {
+    if (i == 0) {
+      bitmap = LookupClause(plan_->clauses_[i]);
+    } else if (bitmap.NumPages() > 0) {
+      bitmap.IntersectWith(LookupClause(plan_->clauses_[i]));
+    }
+  }
+  rids_ = bitmap.ToRids();
+  rid_idx_ = 0;
+  ResetNextFromBatch();
+}
+
+auto BitmapHeapScanExecutor::LookupClause(const std::vector<BitmapIndexLookup> &clause) -> RidBitmap {
+  RidBitmap bitmap;
+  std::vector<RID> rids;
+  for (const auto &lookup : clause) {
+    const auto *index_info = exec_ctx_->GetCatalog()->GetIndex(lookup.index_oid_);
+    rids.clear();
+    for (const auto &range : lookup.key_ranges_) {
+      IndexScanExecutor::ScanRange(index_info, range, exec_ctx_->GetTransaction(), &rids);
+    }
+    for (const auto &rid : rids) {
+      bitmap.Set(rid);
+    }
+  }
+  return bitmap;
+}
+
+auto BitmapHeapScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
+
+auto BitmapHeapScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  //RID 按页有序，同一页的 RID 在一个批次内只取一次页；先加锁再读元组
+  while (batch->IsEmpty()) {
+    if (rid_idx_ == rids_.size()) {
+      return false;
+    }
+    size_t end = std::min(rids_.size(), rid_idx_ + batch->Capacity());
+    row_reader_.ReadRows(rids_, rid_idx_, end, batch);
+    rid_idx_ = end;
+    residual_.Filter(batch);
+  }
+  return true;
+}
+
+}  // namespace bustub
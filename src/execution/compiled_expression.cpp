@@ -0,0 +1,702 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.cpp
+//
+// Identification: src/execution/compiled_expression.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/compiled_expression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// The AVX2 kernels are compiled for AVX2 with a target attribute and picked at runtime, so that the build needs no
+// -mavx2 and the binary still runs on CPUs without AVX2
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BUSTUB_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Load a fixed-width column from the tuple bytes into a lane, the NULL sentinel of the stored type gives NULL */
+template <class Stored, class LaneType>
+void LoadColumn(const TupleBatch &batch, uint32_t col_idx, uint32_t offset, Stored null,
+                std::vector<LaneType> *values, std::vector<uint8_t> *nulls) {
+  if (batch.IsReference()) {
+    // Rows of a join or a projection are read in place from the tuples they refer to
+    for (size_t i = 0; i < batch.Size(); i++) {
+      const char *data = batch.GetColumnData(i, col_idx);
+      Stored value = null;
+      if (data != nullptr) {
+        std::memcpy(&value, data, sizeof(value));
+      }
+      (*values)[i] = static_cast<LaneType>(value);
+      (*nulls)[i] = static_cast<uint8_t>(value == null);
+    }
+    return;
+  }
+  for (size_t i = 0; i < batch.Size(); i++) {
+    Stored value;
+    std::memcpy(&value, batch.GetTuple(i).GetData() + offset, sizeof(value));
+    (*values)[i] = static_cast<LaneType>(value);
+    (*nulls)[i] = static_cast<uint8_t>(value == null);
+  }
+}
+
+/** Apply a binary operator lane by lane, the result is NULL if either operand is */
+template <class Op>
+void BinaryKernel(const std::vector<int32_t> &lhs, const std::vector<uint8_t> &lhs_nulls,
+                  const std::vector<int32_t> &rhs, const std::vector<uint8_t> &rhs_nulls, std::vector<int32_t> *out,
+                  std::vector<uint8_t> *out_nulls, Op op) {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    (*out)[i] = op(lhs[i], rhs[i]);
+    (*out_nulls)[i] = lhs_nulls[i] | rhs_nulls[i];
+  }
+}
+
+/** Integer + and - wrap around like the int32 arithmetic of ArithmeticExpression, without the undefined behavior */
+auto WrappingAdd(int32_t a, int32_t b) -> int32_t {
+  return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+}
+
+auto WrappingSub(int32_t a, int32_t b) -> int32_t {
+  return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+}
+
+template <ComparisonType Cmp, class T>
+inline auto Compare(T a, T b) -> int32_t {
+  if constexpr (Cmp == ComparisonType::Equal) {
+    return static_cast<int32_t>(a == b);
+  } else if constexpr (Cmp == ComparisonType::NotEqual) {
+    return static_cast<int32_t>(a != b);
+  } else if constexpr (Cmp == ComparisonType::LessThan) {
+    return static_cast<int32_t>(a < b);
+  } else if constexpr (Cmp == ComparisonType::LessThanOrEqual) {
+    return static_cast<int32_t>(a <= b);
+  } else if constexpr (Cmp == ComparisonType::GreaterThan) {
+    return static_cast<int32_t>(a > b);
+  } else {
+    return static_cast<int32_t>(a >= b);
+  }
+}
+
+#if defined(BUSTUB_AVX2_KERNELS)
+/** @return whether the CPU supports AVX2, checked once */
+auto HasAvx2() -> bool {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2") != 0;
+  return has_avx2;
+}
+
+/** Compare eight int32 lanes into 0/1 lanes */
+template <ComparisonType Cmp>
+__attribute__((target("avx2"))) inline auto CompareInt32x8(__m256i a, __m256i b) -> __m256i {
+  // AVX2 only has == and >, the other comparisons swap the operands or negate the mask
+  const __m256i one = _mm256_set1_epi32(1);
+  if constexpr (Cmp == ComparisonType::Equal) {
+    return _mm256_and_si256(_mm256_cmpeq_epi32(a, b), one);
+  } else if constexpr (Cmp == ComparisonType::NotEqual) {
+    return _mm256_andnot_si256(_mm256_cmpeq_epi32(a, b), one);
+  } else if constexpr (Cmp == ComparisonType::LessThan) {
+    return _mm256_and_si256(_mm256_cmpgt_epi32(b, a), one);
+  } else if constexpr (Cmp == ComparisonType::LessThanOrEqual) {
+    return _mm256_andnot_si256(_mm256_cmpgt_epi32(a, b), one);
+  } else if constexpr (Cmp == ComparisonType::GreaterThan) {
+    return _mm256_and_si256(_mm256_cmpgt_epi32(a, b), one);
+  } else {
+    return _mm256_andnot_si256(_mm256_cmpgt_epi32(b, a), one);
+  }
+}
+
+/** Compare int32 lanes eight at a time, @return the number of rows compared */
+template <ComparisonType Cmp>
+__attribute__((target("avx2"))) auto CompareInt32Avx2(const int32_t *lhs, const int32_t *rhs, bool rhs_scalar,
+                                                      size_t num_rows, int32_t *out) -> size_t {
+  size_t i = 0;
+  if (rhs_scalar) {
+    // Broadcast the constant only here, a column on the right-hand side may have no rows at all
+    const __m256i constant = _mm256_set1_epi32(rhs[0]);
+    for (; i + 8 <= num_rows; i += 8) {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), CompareInt32x8<Cmp>(a, constant));
+    }
+    return i;
+  }
+  for (; i + 8 <= num_rows; i += 8) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), CompareInt32x8<Cmp>(a, b));
+  }
+  return i;
+}
+
+/** Compare four int64 lanes into all-ones lanes where the comparison holds */
+template <ComparisonType Cmp>
+__attribute__((target("avx2"))) inline auto CompareMask(__m256i a, __m256i b) -> __m256i {
+  // Like int32, only == and > exist, the negated comparisons flip every bit
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  if constexpr (Cmp == ComparisonType::Equal) {
+    return _mm256_cmpeq_epi64(a, b);
+  } else if constexpr (Cmp == ComparisonType::NotEqual) {
+    return _mm256_xor_si256(_mm256_cmpeq_epi64(a, b), ones);
+  } else if constexpr (Cmp == ComparisonType::LessThan) {
+    return _mm256_cmpgt_epi64(b, a);
+  } else if constexpr (Cmp == ComparisonType::LessThanOrEqual) {
+    return _mm256_xor_si256(_mm256_cmpgt_epi64(a, b), ones);
+  } else if constexpr (Cmp == ComparisonType::GreaterThan) {
+    return _mm256_cmpgt_epi64(a, b);
+  } else {
+    return _mm256_xor_si256(_mm256_cmpgt_epi64(b, a), ones);
+  }
+}
+
+/** Compare four double lanes into all-ones lanes where the comparison holds, with the NaN rules of C++ */
+template <ComparisonType Cmp>
+__attribute__((target("avx2"))) inline auto CompareMask(__m256d a, __m256d b) -> __m256i {
+  if constexpr (Cmp == ComparisonType::Equal) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+  } else if constexpr (Cmp == ComparisonType::NotEqual) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_NEQ_UQ));
+  } else if constexpr (Cmp == ComparisonType::LessThan) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_LT_OQ));
+  } else if constexpr (Cmp == ComparisonType::LessThanOrEqual) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_LE_OQ));
+  } else if constexpr (Cmp == ComparisonType::GreaterThan) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_GT_OQ));
+  } else {
+    return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_GE_OQ));
+  }
+}
+
+__attribute__((target("avx2"))) inline auto Load4(const int64_t *lanes) -> __m256i {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes));
+}
+
+__attribute__((target("avx2"))) inline auto Load4(const double *lanes) -> __m256d { return _mm256_loadu_pd(lanes); }
+
+__attribute__((target("avx2"))) inline auto Broadcast4(int64_t value) -> __m256i { return _mm256_set1_epi64x(value); }
+
+__attribute__((target("avx2"))) inline auto Broadcast4(double value) -> __m256d { return _mm256_set1_pd(value); }
+
+/** Narrow the masks of rows 0-3 and 4-7 into eight 0/1 int32 lanes */
+__attribute__((target("avx2"))) inline auto NarrowMasks(__m256i low, __m256i high) -> __m256i {
+  // The low half of every 64-bit mask gives [l0 l1 h0 h1 | l2 l3 h2 h3], then the pairs go back into row order
+  __m256 halves = _mm256_shuffle_ps(_mm256_castsi256_ps(low), _mm256_castsi256_ps(high), _MM_SHUFFLE(2, 0, 2, 0));
+  __m256i rows = _mm256_permute4x64_epi64(_mm256_castps_si256(halves), _MM_SHUFFLE(3, 1, 2, 0));
+  return _mm256_and_si256(rows, _mm256_set1_epi32(1));
+}
+
+/** Compare int64 or double lanes eight at a time, four per register, @return the number of rows compared */
+template <ComparisonType Cmp, class T>
+__attribute__((target("avx2"))) auto Compare64Avx2(const T *lhs, const T *rhs, bool rhs_scalar, size_t num_rows,
+                                                   int32_t *out) -> size_t {
+  size_t i = 0;
+  if (rhs_scalar) {
+    const auto constant = Broadcast4(rhs[0]);
+    for (; i + 8 <= num_rows; i += 8) {
+      __m256i low = CompareMask<Cmp>(Load4(lhs + i), constant);
+      __m256i high = CompareMask<Cmp>(Load4(lhs + i + 4), constant);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), NarrowMasks(low, high));
+    }
+    return i;
+  }
+  for (; i + 8 <= num_rows; i += 8) {
+    __m256i low = CompareMask<Cmp>(Load4(lhs + i), Load4(rhs + i));
+    __m256i high = CompareMask<Cmp>(Load4(lhs + i + 4), Load4(rhs + i + 4));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), NarrowMasks(low, high));
+  }
+  return i;
+}
+
+/** Three-valued and/or of eight rows at a time, the same steps as LogicKernel(), @return the number of rows done */
+template <bool IsAnd>
+__attribute__((target("avx2"))) auto LogicAvx2(const int32_t *lhs, const uint8_t *lhs_nulls, const int32_t *rhs,
+                                               const uint8_t *rhs_nulls, size_t num_rows, int32_t *out,
+                                               uint8_t *out_nulls) -> size_t {
+  const __m256i one = _mm256_set1_epi32(1);
+  // Where the NULL flags of rows 0-3 and 4-7 end up once narrowed back into bytes
+  const __m256i gather_bytes = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+  size_t i = 0;
+  for (; i + 8 <= num_rows; i += 8) {
+    __m256i lhs_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+    __m256i rhs_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    __m256i lhs_known = _mm256_xor_si256(
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(lhs_nulls + i))), one);
+    __m256i rhs_known = _mm256_xor_si256(
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(rhs_nulls + i))), one);
+    __m256i lhs_true = _mm256_and_si256(lhs_lanes, lhs_known);
+    __m256i rhs_true = _mm256_and_si256(rhs_lanes, rhs_known);
+    __m256i lhs_false = _mm256_andnot_si256(lhs_lanes, lhs_known);
+    __m256i rhs_false = _mm256_andnot_si256(rhs_lanes, rhs_known);
+    __m256i is_true = IsAnd ? _mm256_and_si256(lhs_true, rhs_true) : _mm256_or_si256(lhs_true, rhs_true);
+    __m256i is_false = IsAnd ? _mm256_or_si256(lhs_false, rhs_false) : _mm256_and_si256(lhs_false, rhs_false);
+    __m256i is_null = _mm256_xor_si256(_mm256_or_si256(is_true, is_false), one);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), is_true);
+    // Saturating packs leave the flags of rows 0-3 in the first four bytes of each half
+    __m256i words = _mm256_packs_epi32(is_null, is_null);
+    __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), gather_bytes);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out_nulls + i), _mm256_castsi256_si128(bytes));
+  }
+  return i;
+}
+#endif
+
+/** Compare two lanes row by row into a 0/1 lane, a scalar right-hand side is a single constant lane */
+template <ComparisonType Cmp, class T>
+void CompareKernel(const T *lhs, const T *rhs, bool rhs_scalar, size_t num_rows, int32_t *out) {
+  size_t i = 0;
+#if defined(BUSTUB_AVX2_KERNELS)
+  if (HasAvx2()) {
+    if constexpr (std::is_same_v<T, int32_t>) {
+      i = CompareInt32Avx2<Cmp>(lhs, rhs, rhs_scalar, num_rows, out);
+    } else {
+      i = Compare64Avx2<Cmp>(lhs, rhs, rhs_scalar, num_rows, out);
+    }
+  }
+#endif
+  if (rhs_scalar) {
+    T constant = rhs[0];
+    for (; i < num_rows; i++) {
+      out[i] = Compare<Cmp>(lhs[i], constant);
+    }
+    return;
+  }
+  for (; i < num_rows; i++) {
+    out[i] = Compare<Cmp>(lhs[i], rhs[i]);
+  }
+}
+
+template <class T>
+void CompareLanes(ComparisonType type, const std::vector<T> &lhs, const std::vector<T> &rhs, bool rhs_scalar,
+                  std::vector<int32_t> *out) {
+  switch (type) {
+    case ComparisonType::Equal:
+      CompareKernel<ComparisonType::Equal>(lhs.data(), rhs.data(), rhs_scalar, out->size(), out->data());
+      break;
+    case ComparisonType::NotEqual:
+      CompareKernel<ComparisonType::NotEqual>(lhs.data(), rhs.data(), rhs_scalar, out->size(), out->data());
+      break;
+    case ComparisonType::LessThan:
+      CompareKernel<ComparisonType::LessThan>(lhs.data(), rhs.data(), rhs_scalar, out->size(), out->data());
+      break;
+    case ComparisonType::LessThanOrEqual:
+      CompareKernel<ComparisonType::LessThanOrEqual>(lhs.data(), rhs.data(), rhs_scalar, out->size(), out->data());
+      break;
+    case ComparisonType::GreaterThan:
+      CompareKernel<ComparisonType::GreaterThan>(lhs.data(), rhs.data(), rhs_scalar, out->size(), out->data());
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      CompareKernel<ComparisonType::GreaterThanOrEqual>(lhs.data(), rhs.data(), rhs_scalar, out->size(),
+                                                        out->data());
+      break;
+  }
+}
+
+/** The NULL flags of a binary operator: NULL if either operand is */
+void OrNulls(const std::vector<uint8_t> &lhs, const std::vector<uint8_t> &rhs, bool rhs_scalar,
+             std::vector<uint8_t> *out) {
+  if (rhs_scalar) {
+    uint8_t constant = rhs[0];
+    for (size_t i = 0; i < out->size(); i++) {
+      (*out)[i] = lhs[i] | constant;
+    }
+    return;
+  }
+  for (size_t i = 0; i < out->size(); i++) {
+    (*out)[i] = lhs[i] | rhs[i];
+  }
+}
+
+/**
+ * Three-valued and/or of 0/1 lanes without branches: and is false if either side is false, or is true if either side
+ * is true, and otherwise a NULL on either side gives NULL.
+ */
+template <bool IsAnd>
+void LogicKernel(const std::vector<int32_t> &lhs, const std::vector<uint8_t> &lhs_nulls,
+                 const std::vector<int32_t> &rhs, const std::vector<uint8_t> &rhs_nulls, std::vector<int32_t> *out,
+                 std::vector<uint8_t> *out_nulls) {
+  size_t i = 0;
+#if defined(BUSTUB_AVX2_KERNELS)
+  if (HasAvx2()) {
+    i = LogicAvx2<IsAnd>(lhs.data(), lhs_nulls.data(), rhs.data(), rhs_nulls.data(), out->size(), out->data(),
+                         out_nulls->data());
+  }
+#endif
+  for (; i < out->size(); i++) {
+    int32_t lhs_known = lhs_nulls[i] ^ 1;
+    int32_t rhs_known = rhs_nulls[i] ^ 1;
+    int32_t lhs_true = lhs[i] & lhs_known;
+    int32_t rhs_true = rhs[i] & rhs_known;
+    int32_t lhs_false = (lhs[i] ^ 1) & lhs_known;
+    int32_t rhs_false = (rhs[i] ^ 1) & rhs_known;
+    int32_t is_true = IsAnd ? lhs_true & rhs_true : lhs_true | rhs_true;
+    int32_t is_false = IsAnd ? lhs_false | rhs_false : lhs_false & rhs_false;
+    (*out)[i] = is_true;
+    (*out_nulls)[i] = static_cast<uint8_t>((is_true | is_false) ^ 1);
+  }
+}
+
+/** @return the comparison with its operands swapped, e.g. 5 < a becomes a > 5 */
+auto MirrorComparison(ComparisonType type) -> ComparisonType {
+  switch (type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return type;
+  }
+}
+
+}  // namespace
+
+CompiledExpression::CompiledExpression(AbstractExpressionRef expr) : expr_(std::move(expr)) {
+  if (expr_ == nullptr) {
+    return;
+  }
+  auto lane = expr_->GetReturnType() == TypeId::BOOLEAN ? std::make_optional(Lane::INT32)
+                                                         : LaneOf(expr_->GetReturnType());
+  if (!lane.has_value() || !Emit(*expr_, *lane).has_value()) {
+    program_.clear();
+  }
+}
+
+auto CompiledExpression::LaneOf(TypeId type) -> std::optional<Lane> {
+  switch (type) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+      return Lane::INT32;
+    case TypeId::BIGINT:
+      return Lane::INT64;
+    case TypeId::DECIMAL:
+      return Lane::DECIMAL;
+    default:
+      return std::nullopt;
+  }
+}
+
+auto CompiledExpression::Emit(const AbstractExpression &expr, Lane lane) -> std::optional<uint32_t> {
+  // A loaded number may be widened into the lane of its parent, never narrowed, and booleans stay in int32 lanes
+  auto fits = [lane](TypeId type) {
+    if (type == TypeId::BOOLEAN) {
+      return lane == Lane::INT32;
+    }
+    auto type_lane = LaneOf(type);
+    return type_lane.has_value() && *type_lane <= lane;
+  };
+
+  Instruction instruction{};
+  instruction.lane_ = lane;
+  const AbstractExpression *lhs_expr = nullptr;
+  const AbstractExpression *rhs_expr = nullptr;
+  Lane operand_lane = Lane::INT32;
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(&expr); column != nullptr) {
+    if (column->GetTupleIdx() != 0 || !fits(column->GetReturnType())) {
+      return std::nullopt;
+    }
+    instruction.op_ = OpCode::LOAD_COLUMN;
+    instruction.type_ = column->GetReturnType();
+    instruction.col_idx_ = column->GetColIdx();
+  } else if (const auto *constant = dynamic_cast<const ConstantValueExpression *>(&expr); constant != nullptr) {
+    const auto &value = constant->val_;
+    if (!fits(value.GetTypeId())) {
+      return std::nullopt;
+    }
+    instruction.op_ = OpCode::LOAD_CONSTANT;
+    instruction.type_ = value.GetTypeId();
+    instruction.constant_null_ = value.IsNull();
+    if (!value.IsNull()) {
+      switch (value.GetTypeId()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          instruction.constant_ = value.GetAs<int8_t>();
+          break;
+        case TypeId::SMALLINT:
+          instruction.constant_ = value.GetAs<int16_t>();
+          break;
+        case TypeId::INTEGER:
+          instruction.constant_ = value.GetAs<int32_t>();
+          break;
+        case TypeId::BIGINT:
+          instruction.constant_ = value.GetAs<int64_t>();
+          break;
+        default:
+          break;
+      }
+      instruction.decimal_constant_ = value.GetTypeId() == TypeId::DECIMAL ? value.GetAs<double>()
+                                                                           : static_cast<double>(instruction.constant_);
+    }
+  } else if (const auto *arithmetic = dynamic_cast<const ArithmeticExpression *>(&expr); arithmetic != nullptr) {
+    if (lane != Lane::INT32) {
+      return std::nullopt;
+    }
+    instruction.op_ = OpCode::ARITHMETIC;
+    instruction.arithmetic_type_ = arithmetic->compute_type_;
+  } else if (const auto *comparison = dynamic_cast<const ComparisonExpression *>(&expr); comparison != nullptr) {
+    auto lhs_lane = LaneOf(comparison->GetChildAt(0)->GetReturnType());
+    auto rhs_lane = LaneOf(comparison->GetChildAt(1)->GetReturnType());
+    if (lane != Lane::INT32 || !lhs_lane.has_value() || !rhs_lane.has_value()) {
+      return std::nullopt;
+    }
+    instruction.op_ = OpCode::COMPARE;
+    instruction.comparison_type_ = comparison->comp_type_;
+    operand_lane = std::max(*lhs_lane, *rhs_lane);
+    instruction.lane_ = operand_lane;
+    // Keep a constant on the right, where the kernels compare against it without a lane per row
+    lhs_expr = comparison->GetChildAt(0).get();
+    rhs_expr = comparison->GetChildAt(1).get();
+    if (dynamic_cast<const ConstantValueExpression *>(lhs_expr) != nullptr &&
+        dynamic_cast<const ConstantValueExpression *>(rhs_expr) == nullptr) {
+      std::swap(lhs_expr, rhs_expr);
+      instruction.comparison_type_ = MirrorComparison(instruction.comparison_type_);
+    }
+  } else if (const auto *logic = dynamic_cast<const LogicExpression *>(&expr); logic != nullptr) {
+    if (lane != Lane::INT32) {
+      return std::nullopt;
+    }
+    instruction.op_ = logic->logic_type_ == LogicType::And ? OpCode::AND : OpCode::OR;
+  } else {
+    return std::nullopt;
+  }
+
+  // Operands first, so every register is filled before it is read
+  if (instruction.op_ != OpCode::LOAD_COLUMN && instruction.op_ != OpCode::LOAD_CONSTANT) {
+    if (lhs_expr == nullptr) {
+      lhs_expr = expr.GetChildAt(0).get();
+      rhs_expr = expr.GetChildAt(1).get();
+    }
+    auto lhs = Emit(*lhs_expr, operand_lane);
+    auto rhs = lhs.has_value() ? Emit(*rhs_expr, operand_lane) : std::nullopt;
+    if (!rhs.has_value()) {
+      return std::nullopt;
+    }
+    instruction.lhs_ = *lhs;
+    instruction.rhs_ = *rhs;
+    if (instruction.op_ == OpCode::COMPARE && program_[*rhs].op_ == OpCode::LOAD_CONSTANT) {
+      program_[*rhs].scalar_ = true;
+    }
+  }
+  program_.push_back(instruction);
+  return program_.size() - 1;
+}
+
+void CompiledExpression::Run(const TupleBatch &batch, std::vector<Register> *registers) const {
+  size_t num_rows = batch.Size();
+  registers->resize(program_.size());
+  for (size_t reg = 0; reg < program_.size(); reg++) {
+    const auto &instruction = program_[reg];
+    auto &out = (*registers)[reg];
+    // A comparison writes a 0/1 lane whatever the lane of its operands
+    size_t lane_rows = instruction.scalar_ ? 1 : num_rows;
+    Lane out_lane = instruction.op_ == OpCode::COMPARE ? Lane::INT32 : instruction.lane_;
+    switch (out_lane) {
+      case Lane::INT32:
+        out.values_.resize(lane_rows);
+        break;
+      case Lane::INT64:
+        out.bigints_.resize(lane_rows);
+        break;
+      case Lane::DECIMAL:
+        out.decimals_.resize(lane_rows);
+        break;
+    }
+    out.nulls_.resize(lane_rows);
+
+    switch (instruction.op_) {
+      case OpCode::LOAD_COLUMN: {
+        //直接从元组字节中读取定长列
+        const auto &column = batch.GetSchema()->GetColumn(instruction.col_idx_);
+        BUSTUB_ASSERT(column.IsInlined() && column.GetType() == instruction.type_, "column type mismatch");
+        uint32_t offset = column.GetOffset();
+        auto load = [&](auto null) {
+          using Stored = decltype(null);
+          switch (instruction.lane_) {
+            case Lane::INT32:
+              LoadColumn<Stored>(batch, instruction.col_idx_, offset, null, &out.values_, &out.nulls_);
+              break;
+            case Lane::INT64:
+              LoadColumn<Stored>(batch, instruction.col_idx_, offset, null, &out.bigints_, &out.nulls_);
+              break;
+            case Lane::DECIMAL:
+              LoadColumn<Stored>(batch, instruction.col_idx_, offset, null, &out.decimals_, &out.nulls_);
+              break;
+          }
+        };
+        switch (instruction.type_) {
+          case TypeId::BOOLEAN:
+            load(BUSTUB_BOOLEAN_NULL);
+            break;
+          case TypeId::TINYINT:
+            load(BUSTUB_INT8_NULL);
+            break;
+          case TypeId::SMALLINT:
+            load(BUSTUB_INT16_NULL);
+            break;
+          case TypeId::INTEGER:
+            load(BUSTUB_INT32_NULL);
+            break;
+          case TypeId::BIGINT:
+            load(BUSTUB_INT64_NULL);
+            break;
+          case TypeId::DECIMAL:
+            load(BUSTUB_DECIMAL_NULL);
+            break;
+          default:
+            UNREACHABLE("column type not compiled");
+        }
+        break;
+      }
+      case OpCode::LOAD_CONSTANT:
+        switch (instruction.lane_) {
+          case Lane::INT32:
+            std::fill(out.values_.begin(), out.values_.end(), static_cast<int32_t>(instruction.constant_));
+            break;
+          case Lane::INT64:
+            std::fill(out.bigints_.begin(), out.bigints_.end(), instruction.constant_);
+            break;
+          case Lane::DECIMAL:
+            std::fill(out.decimals_.begin(), out.decimals_.end(), instruction.decimal_constant_);
+            break;
+        }
+        std::fill(out.nulls_.begin(), out.nulls_.end(), static_cast<uint8_t>(instruction.constant_null_));
+        break;
+      case OpCode::ARITHMETIC: {
+        const auto &lhs = (*registers)[instruction.lhs_];
+        const auto &rhs = (*registers)[instruction.rhs_];
+        if (instruction.arithmetic_type_ == ArithmeticType::Plus) {
+          BinaryKernel(lhs.values_, lhs.nulls_, rhs.values_, rhs.nulls_, &out.values_, &out.nulls_, WrappingAdd);
+        } else {
+          BinaryKernel(lhs.values_, lhs.nulls_, rhs.values_, rhs.nulls_, &out.values_, &out.nulls_, WrappingSub);
+        }
+        // An integer Value holding the NULL sentinel is NULL
+        for (size_t i = 0; i < num_rows; i++) {
+          out.nulls_[i] |= static_cast<uint8_t>(out.values_[i] == BUSTUB_INT32_NULL);
+        }
+        break;
+      }
+      case OpCode::COMPARE: {
+        const auto &lhs = (*registers)[instruction.lhs_];
+        const auto &rhs = (*registers)[instruction.rhs_];
+        bool rhs_scalar = program_[instruction.rhs_].scalar_;
+        switch (instruction.lane_) {
+          case Lane::INT32:
+            CompareLanes(instruction.comparison_type_, lhs.values_, rhs.values_, rhs_scalar, &out.values_);
+            break;
+          case Lane::INT64:
+            CompareLanes(instruction.comparison_type_, lhs.bigints_, rhs.bigints_, rhs_scalar, &out.values_);
+            break;
+          case Lane::DECIMAL:
+            CompareLanes(instruction.comparison_type_, lhs.decimals_, rhs.decimals_, rhs_scalar, &out.values_);
+            break;
+        }
+        OrNulls(lhs.nulls_, rhs.nulls_, rhs_scalar, &out.nulls_);
+        break;
+      }
+      case OpCode::AND:
+      case OpCode::OR: {
+        //三值逻辑：与运算有假即假，或运算有真即真，否则有 NULL 即 NULL
+        const auto &lhs = (*registers)[instruction.lhs_];
+        const auto &rhs = (*registers)[instruction.rhs_];
+        if (instruction.op_ == OpCode::AND) {
+          LogicKernel<true>(lhs.values_, lhs.nulls_, rhs.values_, rhs.nulls_, &out.values_, &out.nulls_);
+        } else {
+          LogicKernel<false>(lhs.values_, lhs.nulls_, rhs.values_, rhs.nulls_, &out.values_, &out.nulls_);
+        }
+        break;
+      }
+    }
+  }
+}
+
+void CompiledExpression::EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const {
+  if (!IsCompiled()) {
+    expr_->EvaluateBatch(batch, result);
+    return;
+  }
+  std::vector<Register> registers;
+  Run(batch, &registers);
+  const auto &out = registers.back();
+  auto type = expr_->GetReturnType();
+  result->clear();
+  result->reserve(batch.Size());
+  for (size_t i = 0; i < batch.Size(); i++) {
+    if (out.nulls_[i] != 0) {
+      result->push_back(ValueFactory::GetNullValueByType(type));
+      continue;
+    }
+    switch (type) {
+      case TypeId::BOOLEAN:
+        result->push_back(ValueFactory::GetBooleanValue(out.values_[i] != 0));
+        break;
+      case TypeId::TINYINT:
+        result->push_back(ValueFactory::GetTinyIntValue(static_cast<int8_t>(out.values_[i])));
+        break;
+      case TypeId::SMALLINT:
+        result->push_back(ValueFactory::GetSmallIntValue(static_cast<int16_t>(out.values_[i])));
+        break;
+      case TypeId::INTEGER:
+        result->push_back(ValueFactory::GetIntegerValue(out.values_[i]));
+        break;
+      case TypeId::BIGINT:
+        result->push_back(ValueFactory::GetBigIntValue(out.bigints_[i]));
+        break;
+      case TypeId::DECIMAL:
+        result->push_back(ValueFactory::GetDecimalValue(out.decimals_[i]));
+        break;
+      default:
+        UNREACHABLE("result type not compiled");
+    }
+  }
+}
+
+auto CompiledExpression::EvaluateBatchRef(const TupleBatch &batch, std::vector<Value> *scratch) const
+    -> const std::vector<Value> & {
+  if (!IsCompiled()) {
+    return expr_->EvaluateBatchRef(batch, scratch);
+  }
+  EvaluateBatch(batch, scratch);
+  return *scratch;
+}
+
+void CompiledExpression::Filter(TupleBatch *batch) const {
+  if (expr_ == nullptr || batch->IsEmpty()) {
+    return;
+  }
+  if (!IsCompiled()) {
+    std::vector<Value> predicate;
+    expr_->EvaluateBatch(*batch, &predicate);
+    batch->Select(predicate);
+    return;
+  }
+  std::vector<Register> registers;
+  Run(*batch, &registers);
+  const auto &out = registers.back();
+  std::vector<uint8_t> keep(batch->Size());
+  for (size_t i = 0; i < keep.size(); i++) {
+    keep[i] = static_cast<uint8_t>(out.values_[i] & (out.nulls_[i] ^ 1));
+  }
+  batch->Select(keep);
+}
+
+}  // namespace bustub
@@ -17,12 +17,15 @@
 
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/bitmap_heap_scan_executor.h"
 #include "execution/executors/delete_executor.h"
 #include "execution/executors/filter_executor.h"
 #include "execution/executors/hash_join_executor.h"
+#include "execution/executors/index_only_scan_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/limit_executor.h"
+#include "execution/executors/merge_join_executor.h"
 #include "execution/executors/mock_scan_executor.h"
 #include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
@@ -55,6 +58,18 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan.get()));
     }
 
+    // Create a new index-only scan executor
+    case PlanType::IndexOnlyScan: {
+      return std::make_unique<IndexOnlyScanExecutor>(exec_ctx,
+                                                     dynamic_cast<const IndexOnlyScanPlanNode *>(plan.get()));
+    }
+
+    // Create a new bitmap heap scan executor
+    case PlanType::BitmapHeapScan: {
+      return std::make_unique<BitmapHeapScanExecutor>(exec_ctx,
+                                                      dynamic_cast<const BitmapHeapScanPlanNode *>(plan.get()));
+    }
+
     // Create a new insert executor
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan.get());
@@ -114,6 +129,14 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
     }
 
+    // Create a new merge join executor
+    case PlanType::MergeJoin: {
+      auto merge_join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan.get());
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetLeftPlan());
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetRightPlan());
+      return std::make_unique<MergeJoinExecutor>(exec_ctx, merge_join_plan, std::move(left), std::move(right));
+    }
+
     // Create a new mock scan executor
     case PlanType::MockScan: {
       const auto *mock_scan_plan = dynamic_cast<const MockScanPlanNode *>(plan.get());
@@ -6,7 +6,10 @@ namespace bustub {
 
 FilterExecutor::FilterExecutor(ExecutorContext *exec_ctx, const FilterPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      predicate_(plan_->GetPredicate()) {}
 
 void FilterExecutor::Init() {
   // Initialize the child executor
@@ -31,4 +34,15 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 }
 
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  // The child batch is filtered in place, batches with no matching tuple are skipped
+  while (child_executor_->NextBatch(batch)) {
+    predicate_.Filter(batch);
+    if (!batch->IsEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace bustub
@@ -11,6 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/hash_join_executor.h"
+
+#include <algorithm>
+#include <utility>
+
 #include "type/value_factory.h"
 
 // Note for 2022 Fall: You don't need to implement HashJoinExecutor to pass all tests. You ONLY need to implement it
@@ -18,6 +22,72 @@
 
 namespace bustub {
 
+void JoinHashTable::Insert(Value key, hash_t hash, const Tuple &tuple) {
+  if (key.IsNull()) {
+    return;
+  }
+  // Keep the table at most half full
+  if ((num_keys_ + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  auto entry = static_cast<uint32_t>(entries_.size());
+  entries_.push_back(Entry{hash, std::move(key), arena_.Store(tuple), NO_ENTRY});
+  auto &slot = slots_[FindSlot(hash, entries_.back().key_)];
+  if (slot.head_ == NO_ENTRY) {
+    slot.head_ = entry;
+    num_keys_++;
+  } else {
+    entries_[slot.tail_].next_ = entry;
+  }
+  slot.tail_ = entry;
+}
+
+auto JoinHashTable::Find(const Value &key, hash_t hash) const -> uint32_t {
+  if (slots_.empty()) {
+    return NO_ENTRY;
+  }
+  return slots_[FindSlot(hash, key)].head_;
+}
+
+void JoinHashTable::Clear() {
+  entries_.clear();
+  slots_.clear();
+  num_keys_ = 0;
+  arena_.Clear();
+}
+
+auto JoinHashTable::FindSlot(hash_t hash, const Value &key) const -> size_t {
+  // Linear probing, the hash is compared first so that the key comparison only runs on a likely hit
+  size_t mask = slots_.size() - 1;
+  for (size_t idx = hash & mask;; idx = (idx + 1) & mask) {
+    const auto &slot = slots_[idx];
+    if (slot.head_ == NO_ENTRY) {
+      return idx;
+    }
+    const auto &head = entries_[slot.head_];
+    if (head.hash_ == hash && head.key_.CompareEquals(key) == CmpBool::CmpTrue) {
+      return idx;
+    }
+  }
+}
+
+void JoinHashTable::Grow() {
+  std::vector<Slot> old_slots(std::max<size_t>(slots_.size() * 2, 16));
+  std::swap(slots_, old_slots);
+  size_t mask = slots_.size() - 1;
+  for (const auto &slot : old_slots) {
+    if (slot.head_ == NO_ENTRY) {
+      continue;
+    }
+    // Chains hold distinct keys, so the first empty slot is the right one
+    size_t idx = entries_[slot.head_].hash_ & mask;
+    while (slots_[idx].head_ != NO_ENTRY) {
+      idx = (idx + 1) & mask;
+    }
+    slots_[idx] = slot;
+  }
+}
+
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
@@ -32,60 +102,412 @@ HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlan
 }
 
 void HashJoinExecutor::Init() {
-  left_executor_->Init();
-  right_executor_->Init();
-
-  Tuple tmp_tuple{};
-  RID rid;
-  while (right_executor_->Next(&tmp_tuple, &rid)) {
-    auto join_key = plan_->RightJoinKeyExpression().Evaluate(&tmp_tuple, plan_->GetRightPlan()->OutputSchema());
-    hash_join_table_[HashUtil::HashValue(&join_key)].push_back(tmp_tuple);
-  }
-
-  while (left_executor_->Next(&tmp_tuple, &rid)) {
-    auto join_key = plan_->LeftJoinKeyExpression().Evaluate(&tmp_tuple, plan_->GetLeftPlan()->OutputSchema());
-    if (hash_join_table_.count(HashUtil::HashValue(&join_key)) > 0) {
-      auto right_tuples = hash_join_table_[HashUtil::HashValue(&join_key)];
-      for (const auto &tuple : right_tuples) {
-        auto right_join_key = plan_->RightJoinKeyExpression().Evaluate(&tuple, plan_->GetRightPlan()->OutputSchema());
-        if (right_join_key.CompareEquals(join_key) == CmpBool::CmpTrue) {
-          std::vector<Value> values{};
-          values.reserve(plan_->GetLeftPlan()->OutputSchema().GetColumnCount() +
-                         plan_->GetRightPlan()->OutputSchema().GetColumnCount());
-          for (uint32_t col_idx = 0; col_idx < plan_->GetLeftPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-            values.push_back(tmp_tuple.GetValue(&plan_->GetLeftPlan()->OutputSchema(), col_idx));
-          }
-          for (uint32_t col_idx = 0; col_idx < plan_->GetRightPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-            values.push_back(tuple.GetValue(&plan_->GetRightPlan()->OutputSchema(), col_idx));
-          }
-          output_tuples_.emplace_back(values, &GetOutputSchema());
-        }
+  hash_table_.Clear();
+  partitioned_tables_.clear();
+  build_files_.clear();
+  probe_files_.clear();
+  partition_idx_ = NO_PARTITION;
+  // The build side is consumed before the probe side is opened, so that a parallel build has given back its table
+  // lock in READ_COMMITTED by the time the probe side scans
+  auto pipeline = ParallelPipeline::Make(exec_ctx_, plan_->GetRightPlan());
+  if (pipeline != nullptr) {
+    BuildParallel(pipeline.get());
+  } else {
+    right_executor_->Init();
+    // The build side is pulled batch by batch, so that the join keys are evaluated over whole batches
+    TupleBatch batch{};
+    std::vector<Value> join_keys;
+    while (right_executor_->NextBatch(&batch)) {
+      plan_->RightJoinKeyExpression().EvaluateBatch(batch, &join_keys);
+      for (size_t i = 0; i < batch.Size(); i++) {
+        AddBuildRow(std::move(join_keys[i]), batch.GetTuple(i));
+      }
+    }
+  }
+
+  // A build side that had to spill is probed serially, partition by partition
+  probe_pipeline_ = build_files_.empty() ? ParallelPipeline::Make(exec_ctx_, plan_->GetLeftPlan()) : nullptr;
+  if (probe_pipeline_ != nullptr) {
+    probe_pipeline_->Open();
+  } else {
+    left_executor_->Init();
+  }
+  next_morsel_ = 0;
+  round_output_.clear();
+  round_morsel_idx_ = 0;
+  round_row_idx_ = 0;
+
+  probe_batch_.Reset(&plan_->GetLeftPlan()->OutputSchema());
+  probe_keys_.clear();
+  probe_idx_ = 0;
+  match_ = JoinHashTable::NO_ENTRY;
+  probe_matched_ = false;
+  probe_done_ = false;
+  ResetNextFromBatch();
+}
+
+void HashJoinExecutor::BuildParallel(ParallelPipeline *pipeline) {
+  struct BuildRow {
+    hash_t hash_;
+    Value key_;
+    Tuple tuple_;
+  };
+  const size_t num_partitions = 1 << PARALLEL_RADIX_BITS;
+
+  // Pass 1: the workers scan the build side and split every morsel into radix partitions. The morsels run in rounds,
+  // so that the bytes kept so far are checked against the budget after every round rather than at the end
+  pipeline->Open();
+  auto num_morsels = pipeline->NumMorsels();
+  std::vector<std::vector<std::vector<BuildRow>>> morsel_rows(num_morsels);
+  std::vector<size_t> morsel_bytes(num_morsels, 0);
+  auto partition_sink = [this, &morsel_rows, &morsel_bytes, num_partitions](size_t worker_id, size_t morsel_idx,
+                                                                            TupleBatch *batch) {
+    std::vector<Value> join_keys;
+    plan_->RightJoinKeyExpression().EvaluateBatch(*batch, &join_keys);
+    auto &partitions = morsel_rows[morsel_idx];
+    partitions.resize(num_partitions);
+    for (size_t i = 0; i < batch->Size(); i++) {
+      if (join_keys[i].IsNull()) {
+        continue;
       }
-    } else if (plan_->GetJoinType() == JoinType::LEFT) {
-      std::vector<Value> values{};
-      values.reserve(plan_->GetLeftPlan()->OutputSchema().GetColumnCount() +
-                     plan_->GetRightPlan()->OutputSchema().GetColumnCount());
-      for (uint32_t col_idx = 0; col_idx < plan_->GetLeftPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-        values.push_back(tmp_tuple.GetValue(&plan_->GetLeftPlan()->OutputSchema(), col_idx));
+      auto hash = HashUtil::HashValue(&join_keys[i]);
+      auto tuple = batch->TakeTuple(i);
+      morsel_bytes[morsel_idx] += sizeof(BuildRow) + tuple.GetLength();
+      partitions[HashUtil::RadixPartition(hash, PARALLEL_RADIX_BITS)].push_back(
+          BuildRow{hash, std::move(join_keys[i]), std::move(tuple)});
+    }
+  };
+  size_t total_bytes = 0;
+  size_t next_morsel = 0;
+  while (next_morsel < num_morsels && total_bytes <= execution_memory_limit) {
+    size_t end = std::min(next_morsel + 2 * pipeline->NumWorkers(), num_morsels);
+    pipeline->RunMorsels(next_morsel, end, partition_sink);
+    for (; next_morsel < end; next_morsel++) {
+      total_bytes += morsel_bytes[next_morsel];
+    }
+  }
+
+  if (total_bytes > execution_memory_limit) {
+    // Too large for memory: the rows kept so far go through the serial build, which spills, in table order so that
+    // the chains keep the order of the table. The remaining morsels follow one at a time, each on a single worker.
+    for (size_t morsel_idx = 0; morsel_idx < next_morsel; morsel_idx++) {
+      for (auto &rows : morsel_rows[morsel_idx]) {
+        for (auto &row : rows) {
+          AddBuildRow(std::move(row.key_), row.tuple_);
+        }
+        std::vector<BuildRow>().swap(rows);
       }
-      for (uint32_t col_idx = 0; col_idx < plan_->GetRightPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-        values.push_back(
-            ValueFactory::GetNullValueByType(plan_->GetRightPlan()->OutputSchema().GetColumn(col_idx).GetType()));
+    }
+    auto serial_sink = [this](size_t worker_id, size_t morsel_idx, TupleBatch *batch) {
+      std::vector<Value> join_keys;
+      plan_->RightJoinKeyExpression().EvaluateBatch(*batch, &join_keys);
+      for (size_t i = 0; i < batch->Size(); i++) {
+        AddBuildRow(std::move(join_keys[i]), batch->GetTuple(i));
       }
-      output_tuples_.emplace_back(values, &GetOutputSchema());
+    };
+    for (; next_morsel < num_morsels; next_morsel++) {
+      pipeline->RunMorsels(next_morsel, next_morsel + 1, serial_sink);
     }
+    pipeline->Close();
+    return;
   }
+  pipeline->Close();
 
-  output_tuples_iter_ = output_tuples_.cbegin();
+  // Pass 2: every partition is built into its own table by one worker
+  partitioned_tables_.resize(num_partitions);
+  exec_ctx_->GetTaskScheduler()->ParallelFor(num_partitions, [this, &morsel_rows](size_t worker_id, size_t partition) {
+    auto &table = partitioned_tables_[partition];
+    for (auto &partitions : morsel_rows) {
+      if (partitions.empty()) {
+        continue;
+      }
+      for (auto &row : partitions[partition]) {
+        table.Insert(std::move(row.key_), row.hash_, row.tuple_);
+      }
+      std::vector<BuildRow>().swap(partitions[partition]);
+    }
+  });
 }
 
-auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (output_tuples_iter_ == output_tuples_.cend()) {
+auto HashJoinExecutor::NextProbeRound() -> bool {
+  auto num_morsels = probe_pipeline_->NumMorsels();
+  if (next_morsel_ == num_morsels) {
     return false;
   }
-  *tuple = *output_tuples_iter_;
-  ++output_tuples_iter_;
+  // A round gives every worker a couple of morsels, so that work stealing can even out their costs
+  size_t begin = next_morsel_;
+  size_t end = std::min(begin + 2 * probe_pipeline_->NumWorkers(), num_morsels);
+  round_output_.clear();
+  round_output_.resize(end - begin);
+  probe_pipeline_->RunMorsels(begin, end, [this, begin](size_t worker_id, size_t morsel_idx, TupleBatch *batch) {
+    std::vector<Value> scratch;
+    std::vector<Value> values;
+    const auto &join_keys = plan_->LeftJoinKeyExpression().EvaluateBatchRef(*batch, &scratch);
+    auto &output = round_output_[morsel_idx - begin];
+    for (size_t i = 0; i < batch->Size(); i++) {
+      const auto &left_tuple = batch->GetTuple(i);
+      const JoinHashTable *table;
+      bool matched = false;
+      for (auto entry = FindMatch(join_keys[i], &table); entry != JoinHashTable::NO_ENTRY;
+           entry = table->Next(entry)) {
+        output.push_back(MakeJoinRow(left_tuple, &table->GetTuple(entry), &values));
+        matched = true;
+      }
+      if (!matched && plan_->GetJoinType() == JoinType::LEFT) {
+        output.push_back(MakeJoinRow(left_tuple, nullptr, &values));
+      }
+    }
+  });
+  next_morsel_ = end;
+  if (next_morsel_ == num_morsels) {
+    probe_pipeline_->Close();
+  }
+  round_morsel_idx_ = 0;
+  round_row_idx_ = 0;
   return true;
 }
 
+auto HashJoinExecutor::FindMatch(const Value &key, const JoinHashTable **table) const -> uint32_t {
+  if (partitioned_tables_.empty()) {
+    *table = &hash_table_;
+    return hash_table_.Find(key);
+  }
+  if (key.IsNull()) {
+    *table = &partitioned_tables_[0];
+    return JoinHashTable::NO_ENTRY;
+  }
+  auto hash = HashUtil::HashValue(&key);
+  *table = &partitioned_tables_[HashUtil::RadixPartition(hash, PARALLEL_RADIX_BITS)];
+  return (*table)->Find(key, hash);
+}
+
+void HashJoinExecutor::AddBuildRow(Value key, const Tuple &tuple) {
+  if (key.IsNull()) {
+    return;
+  }
+  if (!build_files_.empty()) {
+    auto partition = HashUtil::RadixPartition(HashUtil::HashValue(&key), SPILL_RADIX_BITS);
+    if (build_files_[partition] != nullptr) {
+      build_files_[partition]->Append(tuple);
+      return;
+    }
+  }
+  hash_table_.Insert(std::move(key), tuple);
+  if (hash_table_.MemoryUsage() > execution_memory_limit) {
+    SpillBuildSide();
+  }
+}
+
+void HashJoinExecutor::SpillBuildSide() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  if (build_files_.empty()) {
+    // First overflow: every partition but partition 0 goes to disk
+    build_files_.resize(1 << SPILL_RADIX_BITS);
+    probe_files_.resize(1 << SPILL_RADIX_BITS);
+    for (size_t partition = 1; partition < build_files_.size(); partition++) {
+      build_files_[partition] = std::make_unique<TmpTupleFile>(bpm);
+      probe_files_[partition] = std::make_unique<TmpTupleFile>(bpm);
+    }
+  } else {
+    // Partition 0 alone outgrew the memory limit, it goes to disk as well
+    build_files_[0] = std::make_unique<TmpTupleFile>(bpm);
+    probe_files_[0] = std::make_unique<TmpTupleFile>(bpm);
+  }
+
+  JoinHashTable resident;
+  for (uint32_t entry = 0; entry < hash_table_.Size(); entry++) {
+    auto partition = HashUtil::RadixPartition(hash_table_.GetHash(entry), SPILL_RADIX_BITS);
+    if (build_files_[partition] != nullptr) {
+      build_files_[partition]->Append(hash_table_.GetTuple(entry));
+    } else {
+      resident.Insert(hash_table_.GetKey(entry), hash_table_.GetHash(entry), hash_table_.GetTuple(entry));
+    }
+  }
+  hash_table_ = std::move(resident);
+}
+
+auto HashJoinExecutor::PullProbeBatch() -> bool {
+  if (partition_idx_ == NO_PARTITION) {
+    if (left_executor_->NextBatch(&probe_batch_)) {
+      return true;
+    }
+    if (build_files_.empty()) {
+      return false;
+    }
+    // The left child is done, go on with the spilled partitions
+    partition_idx_ = 0;
+    if (build_files_[0] != nullptr) {
+      LoadPartition(0);
+    }
+  }
+
+  const auto &left_schema = plan_->GetLeftPlan()->OutputSchema();
+  while (partition_idx_ < probe_files_.size()) {
+    if (probe_files_[partition_idx_] != nullptr) {
+      probe_batch_.Reset(&left_schema);
+      Tuple tuple;
+      while (!probe_batch_.IsFull() && probe_files_[partition_idx_]->Next(&tuple)) {
+        probe_batch_.Append(std::move(tuple), RID{});
+      }
+      if (!probe_batch_.IsEmpty()) {
+        return true;
+      }
+      // Give the pages of a finished partition back to the buffer pool
+      build_files_[partition_idx_].reset();
+      probe_files_[partition_idx_].reset();
+    }
+    partition_idx_++;
+    if (partition_idx_ < build_files_.size() && build_files_[partition_idx_] != nullptr) {
+      LoadPartition(partition_idx_);
+    }
+  }
+  return false;
+}
+
+void HashJoinExecutor::SpillProbeRows() {
+  std::vector<Value> keep;
+  keep.reserve(probe_batch_.Size());
+  size_t num_kept = 0;
+  for (size_t i = 0; i < probe_batch_.Size(); i++) {
+    // A NULL key matches nothing, the row is handled right away
+    bool spill = false;
+    if (!probe_keys_[i].IsNull()) {
+      auto partition = HashUtil::RadixPartition(HashUtil::HashValue(&probe_keys_[i]), SPILL_RADIX_BITS);
+      if (probe_files_[partition] != nullptr) {
+        probe_files_[partition]->Append(probe_batch_.GetTuple(i));
+        spill = true;
+      }
+    }
+    keep.push_back(ValueFactory::GetBooleanValue(!spill));
+    if (!spill) {
+      if (num_kept != i) {
+        probe_keys_[num_kept] = std::move(probe_keys_[i]);
+      }
+      num_kept++;
+    }
+  }
+  probe_keys_.erase(probe_keys_.begin() + num_kept, probe_keys_.end());
+  probe_batch_.Select(keep);
+}
+
+void HashJoinExecutor::LoadPartition(size_t partition) {
+  hash_table_.Clear();
+  auto *file = build_files_[partition].get();
+  TupleBatch batch{};
+  batch.Reset(&plan_->GetRightPlan()->OutputSchema());
+  std::vector<Value> join_keys;
+  Tuple tuple;
+  bool more = true;
+  while (more) {
+    more = file->Next(&tuple);
+    if (more) {
+      batch.Append(std::move(tuple), RID{});
+    }
+    if (batch.IsFull() || (!more && !batch.IsEmpty())) {
+      plan_->RightJoinKeyExpression().EvaluateBatch(batch, &join_keys);
+      for (size_t i = 0; i < batch.Size(); i++) {
+        hash_table_.Insert(std::move(join_keys[i]), batch.GetTuple(i));
+      }
+      batch.Reset(&plan_->GetRightPlan()->OutputSchema());
+    }
+  }
+}
+
+auto HashJoinExecutor::NextProbeBatch() -> bool {
+  while (PullProbeBatch()) {
+    if (probe_batch_.IsEmpty()) {
+      continue;
+    }
+    plan_->LeftJoinKeyExpression().EvaluateBatch(probe_batch_, &probe_keys_);
+    if (partition_idx_ == NO_PARTITION && !probe_files_.empty()) {
+      SpillProbeRows();
+      if (probe_batch_.IsEmpty()) {
+        continue;
+      }
+    }
+    probe_idx_ = 0;
+    match_ = FindMatch(probe_keys_[0], &match_table_);
+    probe_matched_ = false;
+    return true;
+  }
+  return false;
+}
+
+void HashJoinExecutor::EmitRow(TupleBatch *batch, const Tuple *right) {
+  if (batch->IsEmpty()) {
+    batch->ResetJoin(&GetOutputSchema(), probe_batch_, &plan_->GetRightPlan()->OutputSchema());
+  }
+  batch->AppendReference(probe_batch_, probe_idx_, right);
+}
+
+auto HashJoinExecutor::MakeJoinRow(const Tuple &left, const Tuple *right, std::vector<Value> *values) const -> Tuple {
+  const auto &left_schema = plan_->GetLeftPlan()->OutputSchema();
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  values->clear();
+  values->reserve(left_schema.GetColumnCount() + right_schema.GetColumnCount());
+  for (uint32_t col_idx = 0; col_idx < left_schema.GetColumnCount(); col_idx++) {
+    values->push_back(left.GetValue(&left_schema, col_idx));
+  }
+  for (uint32_t col_idx = 0; col_idx < right_schema.GetColumnCount(); col_idx++) {
+    values->push_back(right != nullptr
+                          ? right->GetValue(&right_schema, col_idx)
+                          : ValueFactory::GetNullValueByType(right_schema.GetColumn(col_idx).GetType()));
+  }
+  return Tuple{*values, &GetOutputSchema()};
+}
+
+auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
+
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  if (probe_pipeline_ != nullptr) {
+    //并行探测：逐轮输出每个 morsel 的结果
+    while (!batch->IsFull()) {
+      if (round_morsel_idx_ == round_output_.size()) {
+        if (!NextProbeRound()) {
+          break;
+        }
+        continue;
+      }
+      auto &rows = round_output_[round_morsel_idx_];
+      if (round_row_idx_ == rows.size()) {
+        round_morsel_idx_++;
+        round_row_idx_ = 0;
+        continue;
+      }
+      batch->Append(std::move(rows[round_row_idx_++]), RID{});
+    }
+    return !batch->IsEmpty();
+  }
+
+  //从上次停下的位置继续探测，输出批次满了就返回
+  while (!probe_done_ && !batch->IsFull()) {
+    if (probe_idx_ >= probe_batch_.Size()) {
+      // The output rows refer to the probe batch, they are handed over before it is replaced
+      if (!batch->IsEmpty()) {
+        break;
+      }
+      if (!NextProbeBatch()) {
+        probe_done_ = true;
+        break;
+      }
+    }
+    if (match_ != JoinHashTable::NO_ENTRY) {
+      EmitRow(batch, &match_table_->GetTuple(match_));
+      match_ = match_table_->Next(match_);
+      probe_matched_ = true;
+      continue;
+    }
+    if (!probe_matched_ && plan_->GetJoinType() == JoinType::LEFT) {
+      EmitRow(batch, nullptr);
+    }
+    probe_idx_++;
+    if (probe_idx_ < probe_batch_.Size()) {
+      match_ = FindMatch(probe_keys_[probe_idx_], &match_table_);
+      probe_matched_ = false;
+    }
+  }
+  return !batch->IsEmpty();
+}
+
 }  // namespace bustub
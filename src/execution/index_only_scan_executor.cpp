@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.cpp
+//
+// Identification: src/execution/index_only_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/index_only_scan_executor.h"
+#include <algorithm>
+
+#include "execution/executors/index_scan_executor.h"
+
+namespace bustub {
+IndexOnlyScanExecutor::IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      index_info_{this->exec_ctx_->GetCatalog()->GetIndex(plan_->index_oid_)},
+      table_info_{this->exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_)},
+      row_reader_{exec_ctx, table_info_, "IndexOnlyScan"},
+      residual_{plan_->residual_predicate_} {}
+
+void IndexOnlyScanExecutor::Init() {
+  row_reader_.LockTable();
+  auto *txn = exec_ctx_->GetTransaction();
+  keys_.clear();
+  rids_.clear();
+  key_idx_ = 0;
+  for (const auto &range : plan_->key_ranges_) {
+    IndexScanExecutor::ScanRange(index_info_, range, txn, &rids_, &keys_);
+  }
+  ResetNextFromBatch();
+}
+
+auto IndexOnlyScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
+
+auto IndexOnlyScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  //一个批次全部被过滤掉时继续读下一批
+  while (batch->IsEmpty()) {
+    if (key_idx_ == keys_.size()) {
+      return false;
+    }
+    size_t begin = key_idx_;
+    size_t end = std::min(keys_.size(), begin + batch->Capacity());
+    key_idx_ = end;
+    //先加锁再输出键值，拿到锁后确认索引项仍在，等锁期间被删除或改了键的行不再输出
+    for (size_t i = begin; i < end; i++) {
+      row_reader_.LockRow(rids_[i]);
+    }
+    entry_found_.assign(end - begin, true);
+    if (row_reader_.LocksRows()) {
+      FindEntries(begin, end);
+    }
+    for (size_t i = begin; i < end; i++) {
+      if (entry_found_[i - begin]) {
+        batch->Append(std::vector<Value>{keys_[i]}, rids_[i]);
+      }
+    }
+    residual_.Filter(batch);
+  }
+  return true;
+}
+
+void IndexOnlyScanExecutor::FindEntries(size_t begin, size_t end) {
+  entry_keys_.clear();
+  for (size_t i = begin; i < end; i++) {
+    entry_keys_.emplace_back(std::vector<Value>{keys_[i]}, index_info_->index_->GetKeySchema());
+  }
+  entry_matches_.clear();
+  index_info_->index_->ScanKeys(entry_keys_, &entry_matches_, exec_ctx_->GetTransaction());
+  entry_found_.assign(end - begin, false);
+  for (const auto &[key_idx, rid] : entry_matches_) {
+    if (rid == rids_[begin + key_idx]) {
+      entry_found_[key_idx] = true;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -10,7 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
-#include "execution/expressions/constant_value_expression.h"
+#include <algorithm>
 
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
@@ -18,65 +18,76 @@ IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanP
       plan_{plan},
       index_info_{this->exec_ctx_->GetCatalog()->GetIndex(plan_->index_oid_)},
       table_info_{this->exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_)},
-      tree_{dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info_->index_.get())},
-      //根据是否存在过滤谓词filter_predicate_，将iter_初始化为空还是树的begin
-      iter_{plan_->filter_predicate_ != nullptr ? BPlusTreeIndexIteratorForOneIntegerColumn(nullptr, nullptr)
-                                                : tree_->GetBeginIterator()} {}
+      row_reader_{exec_ctx, table_info_, "IndexScan"},
+      residual_{plan_->residual_predicate_} {}
 
 void IndexScanExecutor::Init() {
-  if (plan_->filter_predicate_ != nullptr) {
-    if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
-      try {
-        bool is_locked = exec_ctx_->GetLockManager()->LockTable(
-            exec_ctx_->GetTransaction(), LockManager::LockMode::INTENTION_SHARED, table_info_->oid_);
-        if (!is_locked) {
-          throw ExecutionException("IndexScan Executor Get Table Lock Failed");
-        }
-      } catch (TransactionAbortException& e) {
-        throw ExecutionException("IndexScan Executor Get Table Lock Failed" + e.GetInfo());
+  row_reader_.LockTable();
+  auto *txn = exec_ctx_->GetTransaction();
+  //初始化，按计划中的各个键范围遍历索引，把命中的 RID 放在 rids_ 中，之后 Next 按批读取
+  rids_.clear();
+  rid_idx_ = 0;
+  for (const auto &range : plan_->key_ranges_) {
+    ScanRange(index_info_, range, txn, &rids_);
+  }
+  ResetNextFromBatch();
+}
+
+void IndexScanExecutor::ScanRange(const IndexInfo *index_info, const IndexKeyRange &range, Transaction *txn,
+                                  std::vector<RID> *rids, std::vector<Value> *keys) {
+  auto *key_schema = index_info->index_->GetKeySchema();
+  auto *tree = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info->index_.get());
+  //等值查找直接走 ScanKey，哈希索引只支持这种
+  if (range.IsPoint() || tree == nullptr) {
+    BUSTUB_ASSERT(range.IsPoint(), "only a B+ tree index can scan a key range");
+    index_info->index_->ScanKey(Tuple{{*range.lower_}, key_schema}, rids, txn);
+    if (keys != nullptr) {
+      keys->resize(rids->size(), *range.lower_);
+    }
+    return;
+  }
+  IntegerKeyType lower_key;
+  if (range.lower_.has_value()) {
+    lower_key.SetFromKey(Tuple{{*range.lower_}, key_schema});
+  }
+  //迭代器析构时释放叶子的读锁，不能赋值，只能直接构造
+  auto iter = range.lower_.has_value() ? tree->GetBeginIterator(lower_key) : tree->GetBeginIterator();
+  for (; !iter.IsEnd(); ++iter) {
+    const auto &[key, rid] = *iter;
+    Value value = key.ToValue(key_schema, 0);
+    if (range.lower_.has_value() && !range.lower_inclusive_ && value.CompareEquals(*range.lower_) == CmpBool::CmpTrue) {
+      continue;
+    }
+    if (range.upper_.has_value()) {
+      if (value.CompareGreaterThan(*range.upper_) == CmpBool::CmpTrue) {
+        break;
+      }
+      if (!range.upper_inclusive_ && value.CompareEquals(*range.upper_) == CmpBool::CmpTrue) {
+        break;
       }
     }
-    //初始化，如果存在过滤谓词，将过滤后的迭代器放在rids中，之后next使用rids中的元素
-    const auto *right_expr =
-        dynamic_cast<const ConstantValueExpression *>(plan_->filter_predicate_->children_[1].get());
-    Value v = right_expr->val_;
-    tree_->ScanKey(Tuple{{v}, index_info_->index_->GetKeySchema()}, &rids_, exec_ctx_->GetTransaction());
-    rid_iter_ = rids_.begin();
+    rids->push_back(rid);
+    if (keys != nullptr) {
+      keys->push_back(std::move(value));
+    }
   }
 }
 
-//使用我们在 Project 2 中实现的 B+Tree Index Iterator，遍历 B+ 树叶子节点。
-//由于我们实现的是非聚簇索引，在叶子节点只能获取到 RID，需要拿着 RID 去 table 查询对应的 tuple。
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (plan_->filter_predicate_ != nullptr) {
-    if (rid_iter_ != rids_.end()) {
-      *rid = *rid_iter_;
-      if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
-        try {
-          bool is_locked = exec_ctx_->GetLockManager()->LockRow(exec_ctx_->GetTransaction(),
-                                                                LockManager::LockMode::SHARED, table_info_->oid_, *rid);
-          if (!is_locked) {
-            throw ExecutionException("IndexScan Executor Get Table Lock Failed");
-          }
-        } catch (TransactionAbortException& e) {
-          throw ExecutionException("IndexScan Executor Get Row Lock Failed");
-        }
-      }
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
 
-      auto result = table_info_->table_->GetTuple(*rid, tuple, exec_ctx_->GetTransaction());
-      rid_iter_++;
-      return result;
+auto IndexScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  //一个批次全部被过滤掉时继续读下一批；先加锁再读元组，残余谓词只作用于加锁后的版本
+  while (batch->IsEmpty()) {
+    if (rid_idx_ == rids_.size()) {
+      return false;
     }
-    return false;
-  }
-  if (iter_ == tree_->GetEndIterator()) {
-    return false;
+    size_t end = std::min(rids_.size(), rid_idx_ + batch->Capacity());
+    row_reader_.ReadRows(rids_, rid_idx_, end, batch);
+    rid_idx_ = end;
+    residual_.Filter(batch);
   }
-  *rid = (*iter_).second;
-  auto result = table_info_->table_->GetTuple(*rid, tuple, exec_ctx_->GetTransaction());
-  ++iter_;
-
-  return result;
+  return true;
 }
 
 }  // namespace bustub
@@ -39,4 +39,19 @@ auto LimitExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   return true;
 }
 
+auto LimitExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (count_ >= plan_->GetLimit()) {
+    batch->Reset(&GetOutputSchema());
+    return false;
+  }
+
+  if (!child_executor_->NextBatch(batch)) {
+    return false;
+  }
+
+  batch->Truncate(plan_->GetLimit() - count_);
+  count_ += batch->Size();
+  return true;
+}
+
 }  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// locked_row_reader.cpp
+//
+// Identification: src/execution/locked_row_reader.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/locked_row_reader.h"
+
+#include <utility>
+
+#include "common/exception.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+
+namespace bustub {
+
+auto LockedRowReader::LocksRows() const -> bool {
+  return exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED;
+}
+
+void LockedRowReader::LockTable() const {
+  auto *txn = exec_ctx_->GetTransaction();
+  if (!LocksRows() || txn->IsTableSharedLocked(table_info_->oid_) || txn->IsTableExclusiveLocked(table_info_->oid_) ||
+      txn->IsTableSharedIntentionExclusiveLocked(table_info_->oid_)) {
+    return;
+  }
+  try {
+    bool is_locked =
+        exec_ctx_->GetLockManager()->LockTable(txn, LockManager::LockMode::INTENTION_SHARED, table_info_->oid_);
+    if (!is_locked) {
+      throw ExecutionException(executor_name_ + " Executor Get Table Lock Failed");
+    }
+  } catch (TransactionAbortException &e) {
+    throw ExecutionException(executor_name_ + " Executor Get Table Lock Failed" + e.GetInfo());
+  }
+}
+
+void LockedRowReader::LockRow(const RID &rid) const {
+  if (!LocksRows()) {
+    return;
+  }
+  try {
+    bool is_locked = exec_ctx_->GetLockManager()->LockRow(exec_ctx_->GetTransaction(), LockManager::LockMode::SHARED,
+                                                          table_info_->oid_, rid);
+    if (!is_locked) {
+      throw ExecutionException(executor_name_ + " Executor Get Row Lock Failed");
+    }
+  } catch (TransactionAbortException &e) {
+    throw ExecutionException(executor_name_ + " Executor Get Row Lock Failed");
+  }
+}
+
+void LockedRowReader::ReadRows(const std::vector<RID> &rids, size_t begin, size_t end, TupleBatch *batch) {
+  batch_rids_.assign(rids.begin() + begin, rids.begin() + end);
+  for (const auto &rid : batch_rids_) {
+    LockRow(rid);
+  }
+  table_info_->table_->GetTuples(batch_rids_, &batch_tuples_, &batch_found_, exec_ctx_->GetTransaction());
+  for (size_t i = 0; i < batch_rids_.size(); i++) {
+    if (batch_found_[i]) {
+      batch->Append(std::move(batch_tuples_[i]), batch_rids_[i]);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/merge_join_executor.h"
+
+#include "common/exception.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left_child,
+                                     std::unique_ptr<AbstractExecutor> &&right_child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_child)),
+      right_executor_(std::move(right_child)) {
+  if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
+    throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
+  }
+}
+
+void MergeJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  has_left_key_ = false;
+  has_right_key_ = false;
+  right_run_.clear();
+  run_loaded_ = false;
+  run_idx_ = 0;
+  AdvanceRight();
+}
+
+auto MergeJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (true) {
+    // Join the current left tuple with the rest of the run
+    if (run_idx_ < right_run_.size()) {
+      *tuple = MakeJoinRow(&right_run_[run_idx_++]);
+      return true;
+    }
+
+    RID left_rid;
+    if (!left_executor_->Next(&left_tuple_, &left_rid)) {
+      return false;
+    }
+    auto key = plan_->LeftJoinKeyExpression().Evaluate(&left_tuple_, left_executor_->GetOutputSchema());
+    if (!key.IsNull()) {
+      if (has_left_key_ && key.CompareLessThan(left_key_) == CmpBool::CmpTrue) {
+        throw ExecutionException("Merge Join left input is not sorted");
+      }
+      left_key_ = key;
+      has_left_key_ = true;
+      // Duplicate left keys join with the run that is already loaded
+      if (!run_loaded_ || key.CompareEquals(run_key_) != CmpBool::CmpTrue) {
+        LoadRightRun(key);
+      }
+      run_idx_ = 0;
+      if (!right_run_.empty()) {
+        continue;
+      }
+    }
+    // 左连接：没有匹配的左侧元组用 NULL 补齐右侧
+    run_idx_ = right_run_.size();
+    if (plan_->GetJoinType() == JoinType::LEFT) {
+      *tuple = MakeJoinRow(nullptr);
+      return true;
+    }
+  }
+}
+
+void MergeJoinExecutor::AdvanceRight() {
+  RID rid;
+  right_valid_ = right_executor_->Next(&right_tuple_, &rid);
+  if (!right_valid_) {
+    return;
+  }
+  auto key = plan_->RightJoinKeyExpression().Evaluate(&right_tuple_, right_executor_->GetOutputSchema());
+  if (key.IsNull()) {
+    // Never matches, LoadRightRun skips it
+    has_right_key_ = false;
+    return;
+  }
+  if (has_right_key_ && key.CompareLessThan(right_key_) == CmpBool::CmpTrue) {
+    throw ExecutionException("Merge Join right input is not sorted");
+  }
+  right_key_ = key;
+  has_right_key_ = true;
+}
+
+void MergeJoinExecutor::LoadRightRun(const Value &key) {
+  right_run_.clear();
+  run_key_ = key;
+  run_loaded_ = true;
+  while (right_valid_ && (!has_right_key_ || right_key_.CompareLessThan(key) == CmpBool::CmpTrue)) {
+    AdvanceRight();
+  }
+  while (right_valid_ && has_right_key_ && right_key_.CompareEquals(key) == CmpBool::CmpTrue) {
+    right_run_.push_back(right_tuple_);
+    AdvanceRight();
+  }
+}
+
+auto MergeJoinExecutor::MakeJoinRow(const Tuple *right_tuple) const -> Tuple {
+  const auto &left_schema = left_executor_->GetOutputSchema();
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(left_schema.GetColumnCount() + right_schema.GetColumnCount());
+  for (uint32_t idx = 0; idx < left_schema.GetColumnCount(); idx++) {
+    values.push_back(left_tuple_.GetValue(&left_schema, idx));
+  }
+  for (uint32_t idx = 0; idx < right_schema.GetColumnCount(); idx++) {
+    values.push_back(right_tuple != nullptr ? right_tuple->GetValue(&right_schema, idx)
+                                            : ValueFactory::GetNullValueByType(right_schema.GetColumn(idx).GetType()));
+  }
+  return Tuple{values, &GetOutputSchema()};
+}
+
+}  // namespace bustub
@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/nested_index_join_executor.h"
+
+#include <algorithm>
+
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -21,54 +24,120 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
       plan_{plan},
       child_(std::move(child_executor)),
       index_info_{this->exec_ctx_->GetCatalog()->GetIndex(plan_->index_oid_)},
-      table_info_{this->exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_)},
-      tree_{dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info_->index_.get())} {
+      table_info_{this->exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_)} {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestIndexJoinExecutor::Init() { child_->Init(); }
+void NestIndexJoinExecutor::Init() {
+  child_->Init();
+  output_rows_.clear();
+  output_idx_ = 0;
+  outer_done_ = false;
+  ResetNextFromBatch();
+}
 
 //具体实现和 NestedLoopJoin 差不多，只是在尝试匹配右表 tuple 时，
-//会拿 join key 去 B+Tree Index 里进行查询。如果查询到结果，就拿着查到的 RID 去右表获取 tuple 
-//然后装配成结果输出。
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  Tuple left_tuple{};
-  RID emit_rid{};
-  std::vector<Value> vals;
-  while (child_->Next(&left_tuple, &emit_rid)) {
-    Value value = plan_->KeyPredicate()->Evaluate(&left_tuple, child_->GetOutputSchema());
-    std::vector<RID> rids;
-
-    //根据左表值遍历得到右表对应的key
-    tree_->ScanKey(Tuple{{value}, index_info_->index_->GetKeySchema()}, &rids, exec_ctx_->GetTransaction());
-
-    Tuple right_tuple{};
-    if (!rids.empty()) {
-      table_info_->table_->GetTuple(rids[0], &right_tuple, exec_ctx_->GetTransaction());
-      for (uint32_t idx = 0; idx < child_->GetOutputSchema().GetColumnCount(); idx++) {
-        vals.push_back(left_tuple.GetValue(&child_->GetOutputSchema(), idx));
+//会拿 join key 去 B+Tree Index 里进行查询。如果查询到结果，就拿着查到的 RID 去右表获取 tuple
+//然后装配成结果输出。这里一次处理左表的一整批：
+//1. 整批的键一起查索引（B+ 树内部排序后一次扫过叶子）；
+//2. 命中的 RID 排序后按页读取右表元组；
+//3. 按左表行的顺序输出每一个匹配。
+auto NestIndexJoinExecutor::ProbeBatch() -> bool {
+  while (child_->NextBatch(&outer_batch_)) {
+    if (outer_batch_.IsEmpty()) {
+      continue;
+    }
+    std::vector<Value> scratch;
+    const auto &keys = plan_->KeyPredicate()->EvaluateBatchRef(outer_batch_, &scratch);
+    // A NULL key never joins
+    std::vector<Tuple> key_tuples;
+    std::vector<uint32_t> key_rows;
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (!keys[i].IsNull()) {
+        key_tuples.emplace_back(std::vector<Value>{keys[i]}, index_info_->index_->GetKeySchema());
+        key_rows.push_back(static_cast<uint32_t>(i));
       }
-      for (uint32_t idx = 0; idx < plan_->InnerTableSchema().GetColumnCount(); idx++) {
-        vals.push_back(right_tuple.GetValue(&plan_->InnerTableSchema(), idx));
+    }
+    std::vector<std::pair<size_t, RID>> matches;
+    index_info_->index_->ScanKeys(key_tuples, &matches, exec_ctx_->GetTransaction());
+
+    // Read the inner tuples in RID order, then put the matches back in the order of the outer rows
+    std::sort(matches.begin(), matches.end(), [](const auto &a, const auto &b) {
+      return a.second.Get() != b.second.Get() ? a.second.Get() < b.second.Get() : a.first < b.first;
+    });
+    std::vector<RID> rids;
+    rids.reserve(matches.size());
+    for (const auto &[key_idx, rid] : matches) {
+      rids.push_back(rid);
+    }
+    std::vector<Tuple> inner_tuples;
+    std::vector<bool> found;
+    table_info_->table_->GetTuples(rids, &inner_tuples, &found, exec_ctx_->GetTransaction());
+    std::vector<uint32_t> order;
+    for (size_t i = 0; i < matches.size(); i++) {
+      if (found[i]) {
+        order.push_back(static_cast<uint32_t>(i));
       }
-      *tuple = Tuple(vals, &GetOutputSchema());
-      return true;
     }
-    if (plan_->GetJoinType() == JoinType::LEFT) {
-      for (uint32_t idx = 0; idx < child_->GetOutputSchema().GetColumnCount(); idx++) {
-        vals.push_back(left_tuple.GetValue(&child_->GetOutputSchema(), idx));
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return matches[a].first < matches[b].first; });
+
+    output_rows_.clear();
+    output_idx_ = 0;
+    size_t next = 0;
+    size_t next_key = 0;
+    for (size_t outer_idx = 0; outer_idx < outer_batch_.Size(); outer_idx++) {
+      bool matched = false;
+      if (next_key < key_rows.size() && key_rows[next_key] == outer_idx) {
+        for (; next < order.size() && matches[order[next]].first == next_key; next++) {
+          output_rows_.push_back(MakeJoinRow(outer_idx, &inner_tuples[order[next]]));
+          matched = true;
+        }
+        next_key++;
       }
-      for (uint32_t idx = 0; idx < plan_->InnerTableSchema().GetColumnCount(); idx++) {
-        vals.push_back(ValueFactory::GetNullValueByType(plan_->InnerTableSchema().GetColumn(idx).GetType()));
+      //LEFT JOIN 注意处理空值。
+      if (!matched && plan_->GetJoinType() == JoinType::LEFT) {
+        output_rows_.push_back(MakeJoinRow(outer_idx, nullptr));
       }
-      *tuple = Tuple(vals, &GetOutputSchema());
-      return true;
     }
+    return true;
   }
   return false;
 }
 
+auto NestIndexJoinExecutor::MakeJoinRow(size_t outer_idx, const Tuple *inner) -> Tuple {
+  const auto &outer_schema = child_->GetOutputSchema();
+  const auto &inner_schema = plan_->InnerTableSchema();
+  values_.clear();
+  values_.reserve(outer_schema.GetColumnCount() + inner_schema.GetColumnCount());
+  for (uint32_t col_idx = 0; col_idx < outer_schema.GetColumnCount(); col_idx++) {
+    values_.push_back(outer_batch_.GetColumn(col_idx)[outer_idx]);
+  }
+  for (uint32_t col_idx = 0; col_idx < inner_schema.GetColumnCount(); col_idx++) {
+    values_.push_back(inner != nullptr ? inner->GetValue(&inner_schema, col_idx)
+                                       : ValueFactory::GetNullValueByType(inner_schema.GetColumn(col_idx).GetType()));
+  }
+  return Tuple{values_, &GetOutputSchema()};
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
+
+auto NestIndexJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (output_idx_ < output_rows_.size()) {
+      batch->Append(std::move(output_rows_[output_idx_++]), RID{});
+      continue;
+    }
+    if (outer_done_ || !ProbeBatch()) {
+      outer_done_ = true;
+      break;
+    }
+  }
+  return !batch->IsEmpty();
+}
+
 }  // namespace bustub
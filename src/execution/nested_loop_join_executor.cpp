@@ -13,7 +13,6 @@
 #include "execution/executors/nested_loop_join_executor.h"
 #include "binder/table_ref/bound_join_ref.h"
 #include "common/exception.h"
-#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -33,55 +32,109 @@ NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const
 void NestedLoopJoinExecutor::Init() {
   left_executor_->Init();
   right_executor_->Init();
-  Tuple tuple{};
-  RID rid{};
-  //初始化时，将右边表每行取出来存在right_tuples_中
-  while (right_executor_->Next(&tuple, &rid)) {
-    right_tuples_.push_back(tuple);
+  right_chunks_.clear();
+  left_block_.Reset(&left_executor_->GetOutputSchema());
+  left_idx_ = 0;
+  left_matched_.clear();
+  left_done_ = false;
+  matches_.clear();
+  match_idx_ = 0;
+  emit_null_row_ = false;
+  ResetNextFromBatch();
+
+  //初始化时，将右边表按批缓存，每批填满 BUSTUB_BATCH_SIZE 行；列只在谓词用到时才解码
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  TupleBatch batch;
+  while (right_executor_->NextBatch(&batch)) {
+    for (size_t i = 0; i < batch.Size(); i++) {
+      if (right_chunks_.empty() || right_chunks_.back().IsFull()) {
+        right_chunks_.emplace_back();
+        right_chunks_.back().Reset(&right_schema);
+      }
+      right_chunks_.back().Append(batch.GetTuple(i), RID{});
+    }
   }
+  chunk_idx_ = NumChunks();
 }
 
-//Join 输出的 schema 为 left schema + right schema。
-auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  RID emit_rid{};
-  while (right_tuple_idx_ >= 0 || left_executor_->Next(&left_tuple_, &emit_rid)) {
-    std::vector<Value> vals;
-    for (uint32_t ridx = (right_tuple_idx_ < 0 ? 0 : right_tuple_idx_); ridx < right_tuples_.size(); ridx++) {
-      auto &right_tuple = right_tuples_[ridx];
-      if (Matched(&left_tuple_, &right_tuple)) {
-        for (uint32_t idx = 0; idx < left_executor_->GetOutputSchema().GetColumnCount(); idx++) {
-          vals.push_back(left_tuple_.GetValue(&left_executor_->GetOutputSchema(), idx));
-        }
-        for (uint32_t idx = 0; idx < right_executor_->GetOutputSchema().GetColumnCount(); idx++) {
-          vals.push_back(right_tuple.GetValue(&right_executor_->GetOutputSchema(), idx));
-        }
-        *tuple = Tuple(vals, &GetOutputSchema());
-        right_tuple_idx_ = ridx + 1;
-        return true;
-      }
+auto NestedLoopJoinExecutor::LoadLeftBlock() -> bool {
+  while (left_executor_->NextBatch(&left_block_)) {
+    if (left_block_.IsEmpty()) {
+      continue;
     }
-    //LEFT JOIN 注意处理空值。
-    if (right_tuple_idx_ == -1 && plan_->GetJoinType() == JoinType::LEFT) {
-      for (uint32_t idx = 0; idx < left_executor_->GetOutputSchema().GetColumnCount(); idx++) {
-        vals.push_back(left_tuple_.GetValue(&left_executor_->GetOutputSchema(), idx));
-      }
-      for (uint32_t idx = 0; idx < right_executor_->GetOutputSchema().GetColumnCount(); idx++) {
-        vals.push_back(ValueFactory::GetNullValueByType(right_executor_->GetOutputSchema().GetColumn(idx).GetType()));
+    left_matched_.assign(left_block_.Size(), false);
+    return true;
+  }
+  return false;
+}
+
+//块内先按右侧分块、再按左侧行推进：一个右侧分块与整个左侧块连接完毕后才换下一个分块
+auto NestedLoopJoinExecutor::NextPair() -> bool {
+  left_idx_++;
+  if (left_idx_ >= left_block_.Size()) {
+    left_idx_ = 0;
+    chunk_idx_++;
+  }
+  if (chunk_idx_ >= NumChunks()) {
+    if (left_done_ || !LoadLeftBlock()) {
+      left_done_ = true;
+      return false;
+    }
+    left_idx_ = 0;
+    chunk_idx_ = 0;
+  }
+
+  matches_.clear();
+  match_idx_ = 0;
+  if (!right_chunks_.empty()) {
+    const auto &chunk = right_chunks_[chunk_idx_];
+    plan_->Predicate().EvaluateJoinBatch(left_block_, left_idx_, chunk, &predicate_);
+    for (size_t i = 0; i < chunk.Size(); i++) {
+      if (!predicate_[i].IsNull() && predicate_[i].GetAs<bool>()) {
+        matches_.push_back(static_cast<uint32_t>(i));
       }
-      *tuple = Tuple(vals, &GetOutputSchema());
-      return true;
     }
-    right_tuple_idx_ = -1;
+    if (!matches_.empty()) {
+      left_matched_[left_idx_] = true;
+    }
   }
-  return false;
+  //LEFT JOIN 注意处理空值：左侧行与最后一个分块连接之后仍未匹配，则与空值拼接输出
+  emit_null_row_ =
+      plan_->GetJoinType() == JoinType::LEFT && chunk_idx_ + 1 == NumChunks() && !left_matched_[left_idx_];
+  return true;
+}
+
+//Join 输出的 schema 为 left schema + right schema，输出行只引用左右两侧的元组，不拷贝列值。
+void NestedLoopJoinExecutor::EmitRow(TupleBatch *batch, const TupleBatch *chunk, size_t right_idx) {
+  if (batch->IsEmpty()) {
+    batch->ResetJoin(&GetOutputSchema(), left_block_, &right_executor_->GetOutputSchema());
+  }
+  batch->AppendReference(left_block_, left_idx_, chunk != nullptr ? &chunk->GetTuple(right_idx) : nullptr);
 }
 
-//调用Evaluate()函数判断是否匹配
-auto NestedLoopJoinExecutor::Matched(Tuple *left_tuple, Tuple *right_tuple) const -> bool {
-  auto value = plan_->Predicate().EvaluateJoin(left_tuple, left_executor_->GetOutputSchema(), right_tuple,
-                                               right_executor_->GetOutputSchema());
+auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
 
-  return !value.IsNull() && value.GetAs<bool>();
+auto NestedLoopJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (match_idx_ < matches_.size()) {
+      EmitRow(batch, &right_chunks_[chunk_idx_], matches_[match_idx_++]);
+      continue;
+    }
+    if (emit_null_row_) {
+      emit_null_row_ = false;
+      EmitRow(batch, nullptr, 0);
+      continue;
+    }
+    // The output rows refer to the left block, they are handed over before the next block is loaded
+    if (!batch->IsEmpty() && left_idx_ + 1 >= left_block_.Size() && chunk_idx_ + 1 >= NumChunks()) {
+      break;
+    }
+    if (!NextPair()) {
+      break;
+    }
+  }
+  return !batch->IsEmpty();
 }
 
 }  // namespace bustub
@@ -0,0 +1,270 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_pipeline.cpp
+//
+// Identification: src/execution/parallel_pipeline.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/parallel_pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+#include "concurrency/lock_manager.h"
+#include "execution/executors/mock_scan_executor.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+namespace {
+/** No table page holds more tuples than this, a batch with this much room left always takes a whole page */
+constexpr size_t MAX_TUPLES_PER_PAGE = BUSTUB_PAGE_SIZE / 8;
+static_assert(BUSTUB_BATCH_SIZE >= 2 * MAX_TUPLES_PER_PAGE, "a batch must hold at least two table pages");
+}  // namespace
+
+ParallelPipeline::ParallelPipeline(ExecutorContext *exec_ctx, const AbstractPlanNode *scan,
+                                   std::vector<const AbstractPlanNode *> ops, const TableInfo *table_info)
+    : exec_ctx_(exec_ctx), scan_(scan), ops_(std::move(ops)), table_info_(table_info) {
+  if (const auto *seq_scan = dynamic_cast<const SeqScanPlanNode *>(scan); seq_scan != nullptr) {
+    scan_predicate_ = CompiledExpression{seq_scan->filter_predicate_};
+  }
+  for (const auto *op : ops_) {
+    auto &exprs = op_exprs_.emplace_back();
+    if (op->GetType() == PlanType::Filter) {
+      exprs.emplace_back(dynamic_cast<const FilterPlanNode *>(op)->GetPredicate());
+      continue;
+    }
+    for (const auto &expr : dynamic_cast<const ProjectionPlanNode *>(op)->GetExpressions()) {
+      exprs.emplace_back(expr);
+    }
+  }
+  if (scan->GetType() == PlanType::MockScan) {
+    const auto *mock_scan = dynamic_cast<const MockScanPlanNode *>(scan);
+    mock_func_ = GetFunctionOf(mock_scan);
+    mock_size_ = GetSizeOf(mock_scan);
+  }
+}
+
+auto ParallelPipeline::Make(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan)
+    -> std::unique_ptr<ParallelPipeline> {
+  if (exec_ctx->GetTaskScheduler() == nullptr) {
+    return nullptr;
+  }
+
+  // Walk down the filters and projections to the scan
+  std::vector<const AbstractPlanNode *> ops;
+  const AbstractPlanNode *node = plan.get();
+  while (node->GetType() == PlanType::Filter || node->GetType() == PlanType::Projection) {
+    ops.push_back(node);
+    node = node->GetChildAt(0).get();
+  }
+  std::reverse(ops.begin(), ops.end());
+
+  // A mock scan takes no locks, its rows are split into morsels unless they come in random order
+  if (node->GetType() == PlanType::MockScan) {
+    const auto *mock_scan = dynamic_cast<const MockScanPlanNode *>(node);
+    if (GetShuffled(mock_scan) || GetSizeOf(mock_scan) <= MOCK_MORSEL_ROWS) {
+      return nullptr;
+    }
+    return std::unique_ptr<ParallelPipeline>(new ParallelPipeline(exec_ctx, node, std::move(ops), nullptr));
+  }
+  if (node->GetType() != PlanType::SeqScan) {
+    return nullptr;
+  }
+  const auto *scan = dynamic_cast<const SeqScanPlanNode *>(node);
+
+  // A table lock the transaction already holds cannot be traded for the S lock of the pipeline
+  auto *txn = exec_ctx->GetTransaction();
+  auto oid = scan->GetTableOid();
+  if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED && !txn->IsTableSharedLocked(oid) &&
+      !txn->IsTableExclusiveLocked(oid) && !txn->IsTableSharedIntentionExclusiveLocked(oid) &&
+      (txn->IsTableIntentionSharedLocked(oid) || txn->IsTableIntentionExclusiveLocked(oid))) {
+    return nullptr;
+  }
+
+  auto *table_info = exec_ctx->GetCatalog()->GetTable(oid);
+  auto pipeline = std::unique_ptr<ParallelPipeline>(new ParallelPipeline(exec_ctx, scan, std::move(ops), table_info));
+  // A table that fits in one morsel is not worth the hand-off to the workers
+  if (pipeline->CollectPageIds().size() <= static_cast<size_t>(PARALLEL_MORSEL_PAGES)) {
+    return nullptr;
+  }
+  return pipeline;
+}
+
+void ParallelPipeline::Open() {
+  if (table_info_ == nullptr) {
+    return;
+  }
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED && !txn->IsTableSharedLocked(oid) &&
+      !txn->IsTableExclusiveLocked(oid) && !txn->IsTableSharedIntentionExclusiveLocked(oid)) {
+    try {
+      if (!exec_ctx_->GetLockManager()->LockTable(txn, LockManager::LockMode::SHARED, oid)) {
+        throw ExecutionException("Parallel Pipeline Get Table Lock Failed");
+      }
+    } catch (TransactionAbortException &e) {
+      throw ExecutionException("Parallel Pipeline Get Table Lock Failed" + e.GetInfo());
+    }
+    table_locked_ = true;
+  }
+  // The page list is only stable once the table is locked
+  page_ids_ = CollectPageIds();
+}
+
+auto ParallelPipeline::NumMorsels() const -> size_t {
+  if (table_info_ == nullptr) {
+    return (mock_size_ + MOCK_MORSEL_ROWS - 1) / MOCK_MORSEL_ROWS;
+  }
+  return (page_ids_.size() + PARALLEL_MORSEL_PAGES - 1) / PARALLEL_MORSEL_PAGES;
+}
+
+void ParallelPipeline::Run(const Sink &sink) {
+  RunMorsels(0, NumMorsels(), sink);
+  Close();
+}
+
+void ParallelPipeline::RunMorsels(size_t begin, size_t end, const Sink &sink) {
+  exec_ctx_->GetTaskScheduler()->ParallelFor(end - begin, [this, begin, &sink](size_t worker_id, size_t task_idx) {
+    if (table_info_ == nullptr) {
+      RunMockMorsel(worker_id, begin + task_idx, sink);
+    } else {
+      RunMorsel(worker_id, begin + task_idx, sink);
+    }
+  });
+}
+
+void ParallelPipeline::Close() {
+  // Same as the sequential scan, READ_COMMITTED gives the lock back as soon as the table is read
+  if (table_locked_ && exec_ctx_->GetTransaction()->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    exec_ctx_->GetLockManager()->UnlockTable(exec_ctx_->GetTransaction(), table_info_->oid_);
+    table_locked_ = false;
+  }
+}
+
+auto ParallelPipeline::CollectPageIds() const -> std::vector<page_id_t> {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id = table_info_->table_->GetFirstPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids.push_back(page_id);
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw ExecutionException("Parallel Pipeline Fetch Page Failed");
+    }
+    page->RLatch();
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return page_ids;
+}
+
+void ParallelPipeline::RunMorsel(size_t worker_id, size_t morsel_idx, const Sink &sink) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  TupleBatch batches[2];
+  TupleBatch *batch = &batches[0];
+  TupleBatch *scratch = &batches[1];
+  batch->Reset(&scan_->OutputSchema());
+  TupleBatch page_batch{MAX_TUPLES_PER_PAGE};
+
+  auto flush = [&]() {
+    ApplyOperators(&batch, &scratch);
+    if (!batch->IsEmpty()) {
+      sink(worker_id, morsel_idx, batch);
+    }
+    batch->Reset(&scan_->OutputSchema());
+  };
+
+  size_t begin = morsel_idx * PARALLEL_MORSEL_PAGES;
+  size_t end = std::min(begin + PARALLEL_MORSEL_PAGES, page_ids_.size());
+  for (size_t i = begin; i < end; i++) {
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(page_ids_[i]));
+    if (page == nullptr) {
+      throw ExecutionException("Parallel Pipeline Fetch Page Failed");
+    }
+    page->RLatch();
+    // The scan predicate runs on the tuples in place, only the tuples that satisfy it are copied out of the page
+    page_batch.Reset(&scan_->OutputSchema());
+    RID rid;
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      Tuple view;
+      page->GetTupleView(rid, &view);
+      page_batch.Append(std::move(view), rid);
+    }
+    scan_predicate_.Filter(&page_batch);
+    for (size_t row_idx = 0; row_idx < page_batch.Size(); row_idx++) {
+      batch->Append(page_batch.GetTuple(row_idx), page_batch.GetRID(row_idx));
+    }
+    page_batch.Reset(&scan_->OutputSchema());
+    page->RUnlatch();
+    bpm->UnpinPage(page_ids_[i], false);
+    if (batch->Size() + MAX_TUPLES_PER_PAGE > batch->Capacity()) {
+      flush();
+    }
+  }
+  if (!batch->IsEmpty()) {
+    flush();
+  }
+}
+
+void ParallelPipeline::RunMockMorsel(size_t worker_id, size_t morsel_idx, const Sink &sink) {
+  TupleBatch batches[2];
+  TupleBatch *batch = &batches[0];
+  TupleBatch *scratch = &batches[1];
+
+  size_t begin = morsel_idx * MOCK_MORSEL_ROWS;
+  size_t end = std::min(begin + MOCK_MORSEL_ROWS, mock_size_);
+  for (size_t cursor = begin; cursor < end;) {
+    batch->Reset(&scan_->OutputSchema());
+    for (; cursor < end && !batch->IsFull(); cursor++) {
+      batch->Append(mock_func_(cursor), RID{0});
+    }
+    ApplyOperators(&batch, &scratch);
+    if (!batch->IsEmpty()) {
+      sink(worker_id, morsel_idx, batch);
+    }
+  }
+}
+
+void ParallelPipeline::ApplyOperators(TupleBatch **batch, TupleBatch **scratch) const {
+  for (size_t op_idx = 0; op_idx < ops_.size(); op_idx++) {
+    const auto *op = ops_[op_idx];
+    const auto &exprs = op_exprs_[op_idx];
+    if ((*batch)->IsEmpty()) {
+      return;
+    }
+    if (op->GetType() == PlanType::Filter) {
+      exprs[0].Filter(*batch);
+      continue;
+    }
+
+    // Projection: evaluate the expressions column by column into the scratch batch, which becomes the output
+    std::vector<std::vector<Value>> computed(exprs.size());
+    std::vector<const std::vector<Value> *> columns(exprs.size());
+    for (size_t col_idx = 0; col_idx < exprs.size(); col_idx++) {
+      columns[col_idx] = &exprs[col_idx].EvaluateBatchRef(**batch, &computed[col_idx]);
+    }
+    (*scratch)->Reset(&op->OutputSchema());
+    std::vector<Value> values;
+    for (size_t row_idx = 0; row_idx < (*batch)->Size(); row_idx++) {
+      values.clear();
+      for (const auto *column : columns) {
+        values.push_back((*column)[row_idx]);
+      }
+      (*scratch)->Append(values, (*batch)->GetRID(row_idx));
+    }
+    std::swap(*batch, *scratch);
+  }
+}
+
+}  // namespace bustub
@@ -1,11 +1,22 @@
 #include "execution/executors/projection_executor.h"
+#include "execution/expressions/column_value_expression.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 ProjectionExecutor::ProjectionExecutor(ExecutorContext *exec_ctx, const ProjectionPlanNode *plan,
                                        std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  for (const auto &expr : plan_->GetExpressions()) {
+    exprs_.emplace_back(expr);
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(expr.get());
+    if (column == nullptr || column->GetTupleIdx() != 0) {
+      columns_only_ = false;
+    } else {
+      col_idxs_.push_back(column->GetColIdx());
+    }
+  }
+}
 
 void ProjectionExecutor::Init() {
   // Initialize the child executor
@@ -33,4 +44,38 @@ auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
 
   return true;
 }
+
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    return false;
+  }
+
+  //只选列的投影不拷贝列值，输出行引用子节点的行
+  if (columns_only_) {
+    batch->ResetProjection(&GetOutputSchema(), child_batch_, col_idxs_);
+    for (size_t row_idx = 0; row_idx < child_batch_.Size(); row_idx++) {
+      batch->AppendReference(child_batch_, row_idx);
+    }
+    return true;
+  }
+
+  // Compute expressions, one column at a time
+  columns_.resize(exprs_.size());
+  std::vector<const std::vector<Value> *> columns(exprs_.size());
+  for (size_t col_idx = 0; col_idx < exprs_.size(); col_idx++) {
+    columns[col_idx] = &exprs_[col_idx].EvaluateBatchRef(child_batch_, &columns_[col_idx]);
+  }
+
+  std::vector<Value> values{};
+  for (size_t row_idx = 0; row_idx < child_batch_.Size(); row_idx++) {
+    values.clear();
+    for (const auto *column : columns) {
+      values.push_back((*column)[row_idx]);
+    }
+    batch->Append(values, child_batch_.GetRID(row_idx));
+  }
+
+  return true;
+}
 }  // namespace bustub
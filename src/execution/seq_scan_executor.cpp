@@ -12,17 +12,26 @@
 
 #include "execution/executors/seq_scan_executor.h"
 
+#include <utility>
+
+#include "storage/page/table_page.h"
+
 namespace bustub {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx), plan_(plan) {
+    : AbstractExecutor(exec_ctx), plan_(plan), filter_(plan_->filter_predicate_) {
   //根据ExecutorContext获得table_info_
   this->table_info_ = this->exec_ctx_->GetCatalog()->GetTable(plan_->table_oid_);
 }
 
 void SeqScanExecutor::Init() {
   //初始时，先进行一些多版本并发控制的操作
-  if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
+  auto *txn = exec_ctx_->GetTransaction();
+  table_locked_ = false;
+  //表上已经持有 S/X/SIX 锁（例如并行流水线加的 S 锁）时，已经覆盖了 IS 锁，不再重复加锁
+  if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED && !txn->IsTableSharedLocked(table_info_->oid_) &&
+      !txn->IsTableExclusiveLocked(table_info_->oid_) &&
+      !txn->IsTableSharedIntentionExclusiveLocked(table_info_->oid_)) {
     //在 READ_UNCOMMITTED 下不用加锁，其余两种隔离级别下需要加锁
     try {
       bool is_locked = exec_ctx_->GetLockManager()->LockTable(
@@ -34,27 +43,19 @@ void SeqScanExecutor::Init() {
     } catch (TransactionAbortException& e) {
       throw ExecutionException("SeqScan Executor Get Table Lock Failed" + e.GetInfo());
     }
+    table_locked_ = true;
   }
   //将table_iter_初始化为表的begin();
   this->table_iter_ = table_info_->table_->Begin(exec_ctx_->GetTransaction());
+  page_id_ = table_info_->table_->GetFirstPageId();
+  next_slot_ = 0;
 }
 
 //依靠迭代器遍历即可
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   do {
     if (table_iter_ == table_info_->table_->End()) {
-    //遍历到了结尾，进行多版本并发控制
-      if (exec_ctx_->GetTransaction()->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
-        //在 READ_COMMITTED 下，在 Next() 函数中，若表中已经没有数据，则提前释放之前持有的锁。
-        //在REPEATABLE_READ 下，在 Commit/Abort 时统一释放，无需手动释放。
-        const auto locked_row_set = exec_ctx_->GetTransaction()->GetSharedRowLockSet()->at(table_info_->oid_);
-        table_oid_t oid = table_info_->oid_;
-        for (auto rid : locked_row_set) {
-          exec_ctx_->GetLockManager()->UnlockRow(exec_ctx_->GetTransaction(), oid, rid);
-        }
-
-        exec_ctx_->GetLockManager()->UnlockTable(exec_ctx_->GetTransaction(), table_info_->oid_);
-      }
+      UnlockOnExhausted();
       return false;
     }
     //更新两个输入输出参数行对应的tuple指针和行rid
@@ -66,11 +67,69 @@ auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
            !plan_->filter_predicate_->Evaluate(tuple, table_info_->schema_).GetAs<bool>());
 
   //上面的循环将前面不符合过滤条件的都遍历了，接下来我们仅需给当前符合 predicate 的行加上 S 锁
+  LockRow(*rid);
+  return true;
+}
+
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  //逐页读取，直到批次填满或者表遍历结束
+  while (!batch->IsFull() && page_id_ != INVALID_PAGE_ID) {
+    ScanPage(batch);
+  }
+  if (batch->IsEmpty()) {
+    UnlockOnExhausted();
+    return false;
+  }
+
+  for (size_t i = 0; i < batch->Size(); i++) {
+    LockRow(batch->GetRID(i));
+  }
+  return true;
+}
+
+void SeqScanExecutor::ScanPage(TupleBatch *batch) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id_));
+  if (page == nullptr) {
+    throw ExecutionException("SeqScan Executor Fetch Page Failed");
+  }
+  page->RLatch();
+
+  //谓词直接在页内的元组字节上求值，只有满足条件的元组才被拷贝出来
+  page_batch_.Reset(&GetOutputSchema());
+  size_t room = batch->Capacity() - batch->Size();
+  RID rid;
+  bool found = next_slot_ == 0 ? page->GetFirstTupleRid(&rid)
+                               : page->GetNextTupleRid(RID{page_id_, next_slot_ - 1}, &rid);
+  for (; found && page_batch_.Size() < room; found = page->GetNextTupleRid(rid, &rid)) {
+    Tuple view;
+    page->GetTupleView(rid, &view);
+    page_batch_.Append(std::move(view), rid);
+    next_slot_ = rid.GetSlotNum() + 1;
+  }
+  filter_.Filter(&page_batch_);
+  for (size_t i = 0; i < page_batch_.Size(); i++) {
+    batch->Append(page_batch_.GetTuple(i), page_batch_.GetRID(i));
+  }
+  page_batch_.Reset(&GetOutputSchema());
+
+  page_id_t next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  bpm->UnpinPage(page_id_, false);
+  //本页已读完时移到下一页，否则下次从 next_slot_ 继续
+  if (!found) {
+    page_id_ = next_page_id;
+    next_slot_ = 0;
+  }
+}
+
+void SeqScanExecutor::LockRow(const RID &rid) {
   if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
     try {
       //再给行加 S 锁
       bool is_locked = exec_ctx_->GetLockManager()->LockRow(exec_ctx_->GetTransaction(), LockManager::LockMode::SHARED,
-                                                            table_info_->oid_, *rid);
+                                                            table_info_->oid_, rid);
       if (!is_locked) {
         throw ExecutionException("SeqScan Executor Get Table Lock Failed");
       }
@@ -78,8 +137,25 @@ auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
       throw ExecutionException("SeqScan Executor Get Row Lock Failed");
     }
   }
+}
 
-  return true;
+void SeqScanExecutor::UnlockOnExhausted() {
+  //遍历到了结尾，进行多版本并发控制
+  if (exec_ctx_->GetTransaction()->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    //在 READ_COMMITTED 下，在 Next() 函数中，若表中已经没有数据，则提前释放之前持有的锁。
+    //在REPEATABLE_READ 下，在 Commit/Abort 时统一释放，无需手动释放。
+    const auto locked_row_set = exec_ctx_->GetTransaction()->GetSharedRowLockSet()->at(table_info_->oid_);
+    table_oid_t oid = table_info_->oid_;
+    for (auto rid : locked_row_set) {
+      exec_ctx_->GetLockManager()->UnlockRow(exec_ctx_->GetTransaction(), oid, rid);
+    }
+
+    //只释放自己加的表锁
+    if (table_locked_) {
+      exec_ctx_->GetLockManager()->UnlockTable(exec_ctx_->GetTransaction(), table_info_->oid_);
+      table_locked_ = false;
+    }
+  }
 }
 
 }  // namespace bustub
@@ -1,66 +1,157 @@
 #include "execution/executors/sort_executor.h"
 
+#include <algorithm>
+#include <iterator>
+
+#include "common/config.h"
+#include "execution/parallel_sort.h"
+#include "execution/tuple_batch.h"
+
 namespace bustub {
 
 SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_{plan}, child_{std::move(child_executor)} {}
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      child_{std::move(child_executor)},
+      normalizer_{plan_->GetOrderBy(), &child_->GetOutputSchema()} {}
 
 void SortExecutor::Init() {
   //Sort 也是 pipeline breaker。在 Init() 中读取所有下层算子的 tuple，并按 ORDER BY 的字段升序或降序排序。
+  //超出内存预算的部分先排好序写入临时文件，Next() 时再归并。
   child_->Init();
-  Tuple child_tuple{};
-  RID child_rid;
-  while (child_->Next(&child_tuple, &child_rid)) {
-    child_tuples_.push_back(child_tuple);
+  tuples_.clear();
+  arena_.Clear();
+  keys_.clear();
+  run_bytes_ = 0;
+  next_idx_ = 0;
+  runs_.clear();
+  head_tuples_.clear();
+  head_keys_.clear();
+  run_done_.clear();
+
+  TupleBatch batch{};
+  while (child_->NextBatch(&batch)) {
+    normalizer_.EncodeBatch(batch, &keys_);
+    for (size_t i = 0; i < batch.Size(); i++) {
+      run_bytes_ += sizeof(SortKey) + sizeof(Tuple) + batch.GetTuple(i).GetLength();
+      tuples_.push_back(arena_.Store(batch.GetTuple(i)));
+    }
+    if (run_bytes_ > execution_memory_limit) {
+      SpillRun();
+    }
+  }
+
+  if (runs_.empty()) {
+    SortRows();
+    return;
   }
 
-  //自定义排序规则，直接传入一个 lambda 匿名函数。由于要访问成员 plan_ 来获取排序的字段，
-  //lambda 需要捕获 this 指针。另外，排序字段可以有多个，按先后顺序比较。第一个不相等，直接得到结果；相等，则比较第二个。不会出现所有字段全部相等的情况。
-  std::sort(
-      child_tuples_.begin(), child_tuples_.end(),
-      [order_bys = plan_->order_bys_, schema = child_->GetOutputSchema()](const Tuple &tuple_a, const Tuple &tuple_b) {
-        for (const auto &order_key : order_bys) {
-          switch (order_key.first) {
-            case OrderByType::INVALID:
-            case OrderByType::DEFAULT:
-            case OrderByType::ASC:
-              if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                        .CompareLessThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return true;
-              } else if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                               .CompareGreaterThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return false;
-              }
-              break;
-            case OrderByType::DESC:
-              if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                        .CompareGreaterThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return true;
-              } else if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                               .CompareLessThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return false;
-              }
-              break;
-          }
-        }
-        return false;
-      });
-
-  child_iter_ = child_tuples_.begin();
+  // The last run is merged with the others from disk as well, so that only one page per run stays in memory
+  if (!tuples_.empty()) {
+    SpillRun();
+  }
+  MergePasses();
+  StartMerge();
 }
 
-//next直接将容器中的tuple迭代取出即可
+//next直接按排好序的键取出对应的tuple即可，外部排序时取败者树的胜者
 auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (child_iter_ == child_tuples_.end()) {
-    return false;
+  if (runs_.empty()) {
+    if (next_idx_ == keys_.size()) {
+      return false;
+    }
+    *tuple = std::move(tuples_[keys_[next_idx_++].row_idx_]);
+    *rid = tuple->GetRid();
+    return true;
   }
 
-  *tuple = *child_iter_;
+  if (!NextMerged(tuple)) {
+    return false;
+  }
   *rid = tuple->GetRid();
-  ++child_iter_;
+  return true;
+}
 
+//每个参与归并的 run 要占一页内存，run 太多时先分多趟两两（或多路）归并成更少、更长的 run
+void SortExecutor::MergePasses() {
+  size_t fan_in = std::max<size_t>(2, execution_memory_limit / BUSTUB_PAGE_SIZE);
+  while (runs_.size() > fan_in) {
+    auto inputs = std::move(runs_);
+    std::vector<std::unique_ptr<TmpTupleFile>> merged;
+    for (size_t begin = 0; begin < inputs.size(); begin += fan_in) {
+      size_t end = std::min(begin + fan_in, inputs.size());
+      runs_.assign(std::make_move_iterator(inputs.begin() + begin), std::make_move_iterator(inputs.begin() + end));
+      if (runs_.size() == 1) {
+        merged.push_back(std::move(runs_[0]));
+        continue;
+      }
+      StartMerge();
+      auto run = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+      Tuple tuple;
+      while (NextMerged(&tuple)) {
+        run->Append(tuple);
+      }
+      merged.push_back(std::move(run));
+    }
+    // The input runs of this pass are deleted together with their pages here
+    runs_ = std::move(merged);
+  }
+}
+
+void SortExecutor::StartMerge() {
+  head_tuples_.assign(runs_.size(), Tuple{});
+  head_keys_.resize(runs_.size());
+  run_done_.assign(runs_.size(), false);
+  for (size_t run_idx = 0; run_idx < runs_.size(); run_idx++) {
+    AdvanceRun(run_idx);
+  }
+  merge_tree_.Build(runs_.size(), [this](size_t a, size_t b) { return HeadLess(a, b); });
+}
+
+auto SortExecutor::NextMerged(Tuple *tuple) -> bool {
+  size_t winner = merge_tree_.Winner();
+  if (run_done_[winner]) {
+    return false;
+  }
+  *tuple = std::move(head_tuples_[winner]);
+  AdvanceRun(winner);
+  merge_tree_.Replay([this](size_t a, size_t b) { return HeadLess(a, b); });
   return true;
 }
 
+auto SortExecutor::HeadLess(size_t run_a, size_t run_b) const -> bool {
+  return !run_done_[run_a] &&
+         (run_done_[run_b] ||
+          normalizer_.Less(head_keys_[run_a], head_tuples_[run_a], head_keys_[run_b], head_tuples_[run_b]));
+}
+
+//只移动定长的排序键，键的前缀相同时才回到 tuple 上比较完整的键
+void SortExecutor::SortRows() {
+  ParallelSort(exec_ctx_->GetTaskScheduler(), &keys_, [this](const SortKey &a, const SortKey &b) {
+    return normalizer_.Less(a, tuples_[a.row_idx_], b, tuples_[b.row_idx_]);
+  });
+}
+
+void SortExecutor::SpillRun() {
+  SortRows();
+  auto run = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+  for (const auto &key : keys_) {
+    run->Append(tuples_[key.row_idx_]);
+  }
+  runs_.push_back(std::move(run));
+  tuples_.clear();
+  arena_.Reset();
+  keys_.clear();
+  run_bytes_ = 0;
+}
+
+void SortExecutor::AdvanceRun(size_t run_idx) {
+  if (runs_[run_idx]->Next(&head_tuples_[run_idx])) {
+    normalizer_.Encode(head_tuples_[run_idx], static_cast<uint32_t>(run_idx), &head_keys_[run_idx]);
+  } else {
+    run_done_[run_idx] = true;
+  }
+}
+
 }  // namespace bustub
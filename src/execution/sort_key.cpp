@@ -0,0 +1,174 @@
+#include "execution/sort_key.h"
+
+#include <algorithm>
+
+#include "type/type_id.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the bytes of a fixed-size value, 0 for types whose values are stored elsewhere */
+auto FixedWidth(TypeId type) -> size_t {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return 1;
+    case TypeId::SMALLINT:
+      return 2;
+    case TypeId::INTEGER:
+      return 4;
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/** Store the leading `width` bytes of the big-endian form of the low `full_width` bytes of `bits`. */
+void StoreBigEndian(uint64_t bits, size_t full_width, size_t width, char *dst) {
+  for (size_t i = 0; i < width; i++) {
+    dst[i] = static_cast<char>(bits >> (8 * (full_width - 1 - i)));
+  }
+}
+
+/** @return a signed integer as bits that order like the integer when compared unsigned */
+auto FlipSign(int64_t value, size_t full_width) -> uint64_t {
+  return static_cast<uint64_t>(value) ^ (uint64_t{1} << (8 * full_width - 1));
+}
+
+}  // namespace
+
+SortKeyNormalizer::SortKeyNormalizer(const std::vector<OrderBy> &order_bys, const Schema *schema)
+    : order_bys_(order_bys), schema_(schema) {
+  // Lay the keys out one after another until one of them does not fit, the keys after it are left to FullLess
+  for (const auto &[order_by_type, expr] : order_bys_) {
+    if (prefix_size_ == SORT_KEY_PREFIX_SIZE) {
+      exact_ = false;
+      break;
+    }
+    TypeId type = expr->GetReturnType();
+    size_t space = SORT_KEY_PREFIX_SIZE - prefix_size_ - 1;
+    size_t width = FixedWidth(type);
+    bool truncated = width == 0 || width > space;
+    if (truncated) {
+      width = type == TypeId::INVALID ? 0 : space;
+    }
+    layouts_.push_back({type, order_by_type == OrderByType::DESC, prefix_size_, width});
+    prefix_size_ += 1 + width;
+    if (truncated) {
+      exact_ = false;
+      break;
+    }
+  }
+}
+
+void SortKeyNormalizer::EncodeBatch(const TupleBatch &batch, std::vector<SortKey> *keys) const {
+  size_t first = keys->size();
+  keys->resize(first + batch.Size());
+  for (size_t i = 0; i < batch.Size(); i++) {
+    auto &key = (*keys)[first + i];
+    memset(key.prefix_, 0, SORT_KEY_PREFIX_SIZE);
+    key.row_idx_ = static_cast<uint32_t>(first + i);
+  }
+  std::vector<Value> scratch;
+  for (size_t k = 0; k < layouts_.size(); k++) {
+    const auto &column = order_bys_[k].second->EvaluateBatchRef(batch, &scratch);
+    for (size_t i = 0; i < batch.Size(); i++) {
+      EncodeValue(layouts_[k], column[i], (*keys)[first + i].prefix_);
+    }
+  }
+}
+
+void SortKeyNormalizer::Encode(const Tuple &tuple, uint32_t row_idx, SortKey *key) const {
+  memset(key->prefix_, 0, SORT_KEY_PREFIX_SIZE);
+  key->row_idx_ = row_idx;
+  for (size_t k = 0; k < layouts_.size(); k++) {
+    EncodeValue(layouts_[k], order_bys_[k].second->Evaluate(&tuple, *schema_), key->prefix_);
+  }
+}
+
+void SortKeyNormalizer::EncodeValue(const KeyLayout &layout, const Value &value, char *prefix) const {
+  char *dst = prefix + layout.offset_;
+  if (value.IsNull()) {
+    dst[0] = 0;
+    memset(dst + 1, 0, layout.width_);
+  } else if (value.GetTypeId() != layout.type_ && layout.type_ != TypeId::INVALID) {
+    EncodeValue(layout, value.CastAs(layout.type_), prefix);
+    return;
+  } else {
+    dst[0] = 1;
+    char *data = dst + 1;
+    size_t full_width = FixedWidth(layout.type_);
+    switch (layout.type_) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        StoreBigEndian(FlipSign(value.GetAs<int8_t>(), 1), 1, layout.width_, data);
+        break;
+      case TypeId::SMALLINT:
+        StoreBigEndian(FlipSign(value.GetAs<int16_t>(), 2), 2, layout.width_, data);
+        break;
+      case TypeId::INTEGER:
+        StoreBigEndian(FlipSign(value.GetAs<int32_t>(), 4), 4, layout.width_, data);
+        break;
+      case TypeId::BIGINT:
+        StoreBigEndian(FlipSign(value.GetAs<int64_t>(), 8), 8, layout.width_, data);
+        break;
+      case TypeId::TIMESTAMP:
+        StoreBigEndian(value.GetAs<uint64_t>(), 8, layout.width_, data);
+        break;
+      case TypeId::DECIMAL: {
+        // Negative numbers order backwards by their bits, so all of their bits are inverted
+        auto decimal = value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(bits));
+        constexpr uint64_t sign = uint64_t{1} << 63;
+        bits = (bits & sign) != 0 ? ~bits : bits | sign;
+        StoreBigEndian(bits, full_width, layout.width_, data);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        // The string without its terminating '\0', zero-padded like a shorter string sorts first
+        size_t length = value.GetLength() - 1;
+        size_t stored = std::min<size_t>(length, layout.width_);
+        memcpy(data, value.GetData(), stored);
+        memset(data + stored, 0, layout.width_ - stored);
+        break;
+      }
+      default:
+        memset(data, 0, layout.width_);
+        break;
+    }
+  }
+  if (layout.desc_) {
+    for (size_t i = 0; i <= layout.width_; i++) {
+      dst[i] = static_cast<char>(~dst[i]);
+    }
+  }
+}
+
+auto SortKeyNormalizer::FullLess(const Tuple &tuple_a, const Tuple &tuple_b) const -> bool {
+  for (const auto &[order_by_type, expr] : order_bys_) {
+    auto key_a = expr->Evaluate(&tuple_a, *schema_);
+    auto key_b = expr->Evaluate(&tuple_b, *schema_);
+    bool desc = order_by_type == OrderByType::DESC;
+    if (key_a.IsNull() || key_b.IsNull()) {
+      if (key_a.IsNull() && key_b.IsNull()) {
+        continue;
+      }
+      // NULL sorts before any value
+      return key_a.IsNull() != desc;
+    }
+    if (key_a.CompareLessThan(key_b) == CmpBool::CmpTrue) {
+      return !desc;
+    }
+    if (key_a.CompareGreaterThan(key_b) == CmpBool::CmpTrue) {
+      return desc;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler.cpp
+//
+// Identification: src/execution/task_scheduler.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/task_scheduler.h"
+
+#include <exception>
+#include <utility>
+
+namespace bustub {
+
+TaskScheduler::TaskScheduler(size_t num_workers) {
+  BUSTUB_ASSERT(num_workers > 0, "at least one worker");
+  for (size_t i = 0; i < num_workers; i++) {
+    queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void TaskScheduler::ParallelFor(size_t num_tasks, const std::function<void(size_t, size_t)> &task) {
+  // The state of one call lives on the stack of the caller, which only returns once the last task signalled it
+  struct Job {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    size_t remaining_;
+    std::exception_ptr error_;
+  } job;
+  job.remaining_ = num_tasks;
+
+  for (size_t task_idx = 0; task_idx < num_tasks; task_idx++) {
+    Submit(task_idx % queues_.size(), [&job, &task, task_idx](size_t worker_id) {
+      std::exception_ptr error;
+      try {
+        task(worker_id, task_idx);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::scoped_lock lock(job.latch_);
+      if (error != nullptr && job.error_ == nullptr) {
+        job.error_ = error;
+      }
+      if (--job.remaining_ == 0) {
+        job.cv_.notify_all();
+      }
+    });
+  }
+
+  std::unique_lock lock(job.latch_);
+  job.cv_.wait(lock, [&job] { return job.remaining_ == 0; });
+  if (job.error_ != nullptr) {
+    std::rethrow_exception(job.error_);
+  }
+}
+
+void TaskScheduler::Submit(size_t worker_id, Task &&task) {
+  // Count the task before it becomes visible, so that pending_ never drops below the number of queued tasks
+  {
+    std::scoped_lock lock(latch_);
+    pending_++;
+  }
+  {
+    std::scoped_lock lock(queues_[worker_id]->latch_);
+    queues_[worker_id]->tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+auto TaskScheduler::TakeTask(size_t worker_id, Task *task) -> bool {
+  {
+    auto &own = *queues_[worker_id];
+    std::scoped_lock lock(own.latch_);
+    if (!own.tasks_.empty()) {
+      *task = std::move(own.tasks_.front());
+      own.tasks_.pop_front();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < queues_.size(); i++) {
+    auto &victim = *queues_[(worker_id + i) % queues_.size()];
+    std::scoped_lock lock(victim.latch_);
+    if (!victim.tasks_.empty()) {
+      *task = std::move(victim.tasks_.back());
+      victim.tasks_.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::WorkerLoop(size_t worker_id) {
+  while (true) {
+    Task task;
+    if (TakeTask(worker_id, &task)) {
+      pending_--;
+      task(worker_id);
+      continue;
+    }
+    std::unique_lock lock(latch_);
+    cv_.wait(lock, [this] { return stop_ || pending_ > 0; });
+    if (stop_ && pending_ == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -4,55 +4,37 @@ namespace bustub {
 
 TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_{plan}, child_{std::move(child_executor)} {}
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      child_{std::move(child_executor)},
+      normalizer_{plan_->GetOrderBy(), &child_->GetOutputSchema()} {}
 
 void TopNExecutor::Init() {
 
   //直接用 std::priority_queue 加自定义比较函数，然后在 Init() 中遍历下层算子所有 tuple，
   //全部塞进优先队列后截取前 n 个。再 Next() 里一个一个输出
   child_->Init();
+  child_tuples_ = {};
 
-  auto cmp = [order_bys = plan_->order_bys_, schema = child_->GetOutputSchema()](const Tuple &a, const Tuple &b) {
-    for (const auto &order_key : order_bys) {
-      switch (order_key.first) {
-        case OrderByType::INVALID:
-        case OrderByType::DEFAULT:
-        case OrderByType::ASC:
-          if (static_cast<bool>(
-                  order_key.second->Evaluate(&a, schema).CompareLessThan(order_key.second->Evaluate(&b, schema)))) {
-            return true;
-          } else if (static_cast<bool>(order_key.second->Evaluate(&a, schema)
-                                           .CompareGreaterThan(order_key.second->Evaluate(&b, schema)))) {
-            return false;
-          }
-          break;
-        case OrderByType::DESC:
-          if (static_cast<bool>(
-                  order_key.second->Evaluate(&a, schema).CompareGreaterThan(order_key.second->Evaluate(&b, schema)))) {
-            return true;
-          } else if (static_cast<bool>(order_key.second->Evaluate(&a, schema)
-                                           .CompareLessThan(order_key.second->Evaluate(&b, schema)))) {
-            return false;
-          }
-          break;
-      }
-    }
-    return false;
-  };
+  //与 Sort 共用排序键，NULL 的顺序也一致
+  using Row = std::pair<SortKey, Tuple>;
+  auto cmp = [this](const Row &a, const Row &b) { return normalizer_.Less(a.first, a.second, b.first, b.second); };
 
-  std::priority_queue<Tuple, std::vector<Tuple>, decltype(cmp)> pq(cmp);
+  std::priority_queue<Row, std::vector<Row>, decltype(cmp)> pq(cmp);
 
   Tuple child_tuple{};
   RID child_rid;
   while (child_->Next(&child_tuple, &child_rid)) {
-    pq.push(child_tuple);
+    Row row{SortKey{}, child_tuple};
+    normalizer_.Encode(row.second, 0, &row.first);
+    pq.push(std::move(row));
     if (pq.size() > plan_->GetN()) {
       pq.pop();
     }
   }
 
   while (!pq.empty()) {
-    child_tuples_.push(pq.top());
+    child_tuples_.push(pq.top().second);
     pq.pop();
   }
 }
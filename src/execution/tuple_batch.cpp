@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/macros.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TupleBatch::TupleBatch(size_t capacity) : capacity_(capacity) {
+  tuples_.reserve(capacity);
+  rids_.reserve(capacity);
+}
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  tuples_.clear();
+  rids_.clear();
+  arena_.Reset();
+  layout_.clear();
+  num_sources_ = 0;
+  refs_.clear();
+  columns_.resize(schema == nullptr ? 0 : schema->GetColumnCount());
+  column_decoded_.assign(columns_.size(), false);
+}
+
+void TupleBatch::Append(Tuple &&tuple, RID rid) {
+  BUSTUB_ASSERT(!IsFull(), "append to a full batch");
+  BUSTUB_ASSERT(!IsReference(), "append a tuple to a batch of references");
+  tuples_.push_back(std::move(tuple));
+  rids_.push_back(rid);
+  std::fill(column_decoded_.begin(), column_decoded_.end(), false);
+}
+
+void TupleBatch::Append(const Tuple &tuple, RID rid) { Append(arena_.Store(tuple), rid); }
+
+void TupleBatch::Append(const std::vector<Value> &values, RID rid) { Append(arena_.Store(values, schema_), rid); }
+
+auto TupleBatch::TakeTuple(size_t row_idx) -> Tuple {
+  const auto &tuple = GetTuple(row_idx);
+  return tuple.IsAllocated() ? std::move(tuples_[row_idx]) : tuple.DeepCopy();
+}
+
+void TupleBatch::ResetJoin(const Schema *schema, const TupleBatch &left, const Schema *right_schema) {
+  Reset(schema);
+  // A row of a join of joined rows refers to all of their tuples, so that nothing is materialized in between
+  if (left.IsReference()) {
+    layout_ = left.layout_;
+    num_sources_ = left.num_sources_;
+  } else {
+    for (uint32_t col_idx = 0; col_idx < left.schema_->GetColumnCount(); col_idx++) {
+      layout_.push_back({0, col_idx, left.schema_});
+    }
+    num_sources_ = 1;
+  }
+  for (uint32_t col_idx = 0; col_idx < right_schema->GetColumnCount(); col_idx++) {
+    layout_.push_back({static_cast<uint32_t>(num_sources_), col_idx, right_schema});
+  }
+  num_sources_++;
+  BUSTUB_ASSERT(layout_.size() == schema->GetColumnCount(), "join schema mismatch");
+}
+
+void TupleBatch::ResetProjection(const Schema *schema, const TupleBatch &child, const std::vector<uint32_t> &col_idxs) {
+  Reset(schema);
+  for (auto col_idx : col_idxs) {
+    layout_.push_back(child.IsReference() ? child.layout_[col_idx] : ColumnSource{0, col_idx, child.schema_});
+  }
+  num_sources_ = std::max<size_t>(child.num_sources_, 1);
+  BUSTUB_ASSERT(layout_.size() == schema->GetColumnCount(), "projection schema mismatch");
+}
+
+void TupleBatch::AppendReference(const TupleBatch &base, size_t row_idx, const Tuple *right) {
+  BUSTUB_ASSERT(!IsFull(), "append to a full batch");
+  BUSTUB_ASSERT(IsReference(), "append a reference to a batch of tuples");
+  if (base.IsReference()) {
+    auto begin = base.refs_.begin() + row_idx * base.num_sources_;
+    refs_.insert(refs_.end(), begin, begin + base.num_sources_);
+  } else {
+    refs_.push_back(&base.tuples_[row_idx]);
+  }
+  // A join has one more source than its left side, the right tuple
+  bool is_join = num_sources_ > std::max<size_t>(base.num_sources_, 1);
+  if (is_join) {
+    refs_.push_back(right);
+  }
+  tuples_.emplace_back();
+  rids_.push_back(is_join ? RID{} : base.GetRID(row_idx));
+  std::fill(column_decoded_.begin(), column_decoded_.end(), false);
+}
+
+void TupleBatch::Select(const std::vector<Value> &predicate) {
+  BUSTUB_ASSERT(predicate.size() == tuples_.size(), "one predicate value per row");
+  std::vector<uint8_t> keep(predicate.size());
+  for (size_t i = 0; i < predicate.size(); i++) {
+    keep[i] = static_cast<uint8_t>(!predicate[i].IsNull() && predicate[i].GetAs<bool>());
+  }
+  Select(keep);
+}
+
+void TupleBatch::Select(const std::vector<uint8_t> &keep) {
+  BUSTUB_ASSERT(keep.size() == tuples_.size(), "one flag per row");
+  size_t kept = 0;
+  for (size_t i = 0; i < tuples_.size(); i++) {
+    if (keep[i] == 0) {
+      continue;
+    }
+    if (kept != i) {
+      tuples_[kept] = std::move(tuples_[i]);
+      rids_[kept] = rids_[i];
+      std::copy_n(refs_.begin() + i * num_sources_, num_sources_, refs_.begin() + kept * num_sources_);
+      // keep the decoded columns in step with the rows, so they are not decoded again
+      for (size_t col = 0; col < columns_.size(); col++) {
+        if (column_decoded_[col]) {
+          columns_[col][kept] = std::move(columns_[col][i]);
+        }
+      }
+    }
+    kept++;
+  }
+  Truncate(kept);
+}
+
+void TupleBatch::Truncate(size_t size) {
+  if (size >= tuples_.size()) {
+    return;
+  }
+  tuples_.resize(size);
+  rids_.resize(size);
+  refs_.resize(size * num_sources_);
+  for (size_t col = 0; col < columns_.size(); col++) {
+    if (column_decoded_[col]) {
+      columns_[col].resize(size);
+    }
+  }
+}
+
+auto TupleBatch::GetColumn(uint32_t col_idx) const -> const std::vector<Value> & {
+  BUSTUB_ASSERT(col_idx < columns_.size(), "column out of range");
+  auto &column = columns_[col_idx];
+  if (!column_decoded_[col_idx]) {
+    column.clear();
+    column.reserve(tuples_.size());
+    if (IsReference()) {
+      for (size_t row_idx = 0; row_idx < tuples_.size(); row_idx++) {
+        column.push_back(ReadReference(row_idx, col_idx));
+      }
+    } else {
+      for (const auto &tuple : tuples_) {
+        column.push_back(tuple.GetValueView(schema_, col_idx));
+      }
+    }
+    column_decoded_[col_idx] = true;
+  }
+  return column;
+}
+
+auto TupleBatch::ReadReference(size_t row_idx, uint32_t col_idx) const -> Value {
+  const auto &source = layout_[col_idx];
+  const Tuple *tuple = refs_[row_idx * num_sources_ + source.source_];
+  if (tuple == nullptr) {
+    return ValueFactory::GetNullValueByType(schema_->GetColumn(col_idx).GetType());
+  }
+  return tuple->GetValueView(source.schema_, source.col_idx_);
+}
+
+void TupleBatch::Materialize(size_t row_idx) const {
+  std::vector<Value> values;
+  values.reserve(layout_.size());
+  for (uint32_t col_idx = 0; col_idx < layout_.size(); col_idx++) {
+    values.push_back(column_decoded_[col_idx] ? columns_[col_idx][row_idx] : ReadReference(row_idx, col_idx));
+  }
+  tuples_[row_idx] = arena_.Store(values, schema_);
+}
+
+}  // namespace bustub
@@ -40,6 +40,7 @@ class LogManager;
 class CheckpointManager;
 class Catalog;
 class ExecutionEngine;
+class TaskScheduler;
 
 class ResultWriter {
  public:
@@ -217,6 +218,12 @@ class BustubInstance {
 
   ~BustubInstance();
 
+  /**
+   * Replace the workers of parallel pipelines, which default to one per core. No query may be running.
+   * @param num_workers the number of workers
+   */
+  void SetNumWorkers(size_t num_workers);
+
   /**
    * Execute a SQL query in the BusTub instance.
    */
@@ -252,6 +259,7 @@ class BustubInstance {
   CheckpointManager *checkpoint_manager_;
   Catalog *catalog_;
   ExecutionEngine *execution_engine_;
+  std::unique_ptr<TaskScheduler> task_scheduler_;
   std::shared_mutex catalog_lock_;
 
   auto GetSessionVariable(const std::string &key) -> std::string {
@@ -27,6 +27,9 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** Bytes of working memory an executor may hold (e.g. a hash join build side) before it spills to disk. */
+extern std::atomic<size_t> execution_memory_limit;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
@@ -35,6 +38,9 @@ static constexpr int BUSTUB_PAGE_SIZE = 4096;
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
+static constexpr int HASH_INDEX_INITIAL_SIZE = 1024;  // initial number of buckets of a linear probe hash index
+static constexpr int BUSTUB_BATCH_SIZE = 1024;        // max number of rows in a TupleBatch
+static constexpr int PARALLEL_MORSEL_PAGES = 8;       // number of table pages in a morsel of a parallel scan
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
 
 using frame_id_t = int32_t;    // frame id type
@@ -49,6 +49,17 @@ class HashUtil {
     return (l % PRIME_FACTOR + r % PRIME_FACTOR) % PRIME_FACTOR;
   }
 
+  /**
+   * Pick a partition by the top bits of a scrambled hash, so that the partition does not depend on the low bits
+   * that hash tables use for their slots.
+   * @param hash the hash
+   * @param radix_bits log2 of the number of partitions, at least 1
+   * @return the partition of the hash, smaller than 2^radix_bits
+   */
+  static inline auto RadixPartition(hash_t hash, size_t radix_bits) -> size_t {
+    return static_cast<uint64_t>(hash * 0x9E3779B97F4A7C15ULL) >> (64 - radix_bits);
+  }
+
   template <typename T>
   static inline auto Hash(const T *ptr) -> hash_t {
     return HashBytes(reinterpret_cast<const char *>(ptr), sizeof(T));
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
@@ -24,12 +27,21 @@
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
+#define LINEAR_PROBE_HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
 
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Resizing is incremental: growing the table only allocates a new, empty
+ * generation of block pages and publishes it. From then on inserts go to the
+ * new generation, and every insert or remove migrates one block of the old
+ * generation into it. Lookups and removes check the old generation first and
+ * the new one second, so they never miss a pair that is being migrated. The
+ * table latch is only taken in write mode to publish or retire a generation,
+ * which are constant-time pointer swaps, so readers are never blocked by
+ * data movement.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -73,7 +85,8 @@ class LinearProbeHashTable {
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided, and waits
+   * until every pair has been migrated to the resized table.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
@@ -85,20 +98,68 @@ class LinearProbeHashTable {
   auto GetSize() -> size_t;
 
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
-  void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
-  void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
+  /** Outcome of inserting into one generation of the table. */
+  enum class InsertResult { INSERTED, DUPLICATE, FULL };
+
+  auto GetHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage *;
+  auto GetBlockPage(Page *page) -> HASH_TABLE_BLOCK_TYPE *;
+
+  /** Allocates a generation with room for at least num_buckets pairs and returns its header page id. */
+  auto CreateTable(size_t num_buckets) -> page_id_t;
+  /** Deletes the header and block pages of a generation that is no longer reachable. */
+  void DeleteTable(page_id_t header_page_id);
+
+  /**
+   * Walks the probe sequence of key in one generation, from its home slot up to and including the first never
+   * occupied slot, latching one block page at a time. visitor(block, bucket_ind, slot) is called on every slot and
+   * stops the walk by returning true.
+   * @return true if the visitor stopped the walk
+   */
+  template <bool Exclusive, typename Visitor>
+  auto ProbeTable(HashTableHeaderPage *header_page, const KeyType &key, Visitor &&visitor) -> bool;
+
+  auto GetValueFromTable(HashTableHeaderPage *header_page, const KeyType &key, std::vector<ValueType> *result)
+      -> bool;
+  auto ContainsInTable(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value) -> bool;
+  auto InsertIntoTable(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value) -> InsertResult;
+  auto RemoveFromTable(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Publishes a new generation if the current one is too full, or smaller than min_num_buckets. An unfinished
+   * migration is drained first. Must be called without holding the table latch.
+   * @return false if the table cannot grow to min_num_buckets
+   */
+  auto StartResize(size_t min_num_buckets) -> bool;
+  /**
+   * Moves the next block of the old generation into the current one, and retires the old generation once it is
+   * empty. Must be called without holding the table latch.
+   * @return true if a migration is still in progress
+   */
+  auto MigrateBlock() -> bool;
+  void DrainMigration();
 
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts, removes and migration steps, writer only publishes or retires a generation
   ReaderWriterLatch table_latch_;
+  // Serializes resizes
+  std::mutex resize_latch_;
+  // Serializes inserts of keys that hash to the same latch, from the duplicate probe up to claiming a slot
+  static constexpr size_t NUM_INSERT_LATCHES = 64;
+  std::array<std::mutex, NUM_INSERT_LATCHES> insert_latches_;
+
+  // Generation being drained into header_page_id_, INVALID_PAGE_ID if no resize is in progress
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  // Next block of the old generation to migrate, and number of blocks migrated so far
+  std::atomic<size_t> next_migrate_block_{0};
+  std::atomic<size_t> migrated_blocks_{0};
+  // Occupied slots (including tombstones) of the current generation
+  std::atomic<size_t> num_occupied_{0};
+  // Pairs stored in the table
+  std::atomic<size_t> num_live_{0};
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
@@ -17,9 +17,9 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
 #include <memory>
-#include <mutex>  // NOLINT
+#include <shared_mutex>
 #include <utility>
 #include <vector>
 
@@ -29,6 +29,13 @@ namespace bustub {
 
 /**
  * ExtendibleHashTable implements a hash table using the extendible hashing algorithm.
+ *
+ * Concurrency: the directory and every bucket have their own reader/writer latch, and the directory latch is
+ * always taken before a bucket latch. Find/Insert/Remove only hold the directory latch in shared mode while
+ * copying the bucket pointer out, then work under the bucket latch alone; a split retires the old bucket, so
+ * an operation that latched a retired bucket simply looks it up again. Only a split takes the directory latch
+ * exclusively, so operations on different buckets never block each other.
+ *
  * @tparam K key type
  * @tparam V value type
  */
@@ -107,13 +114,14 @@ class ExtendibleHashTable : public HashTable<K, V> {
 
   /**
    * Bucket class for each hash table bucket that the directory points to.
+   * The pairs are kept in a flat vector reserved to the bucket size, so a bucket is one contiguous scan.
    */
   class Bucket {
    public:
     explicit Bucket(size_t size, int depth = 0);
 
     /** @brief Check if a bucket is full. */
-    inline auto IsFull() const -> bool { return list_.size() == size_; }
+    inline auto IsFull() const -> bool { return items_.size() == size_; }
 
     /** @brief Get the local depth of the bucket. */
     inline auto GetDepth() const -> int { return depth_; }
@@ -121,7 +129,16 @@ class ExtendibleHashTable : public HashTable<K, V> {
     /** @brief Increment the local depth of a bucket. */
     inline void IncrementDepth() { depth_++; }
 
-    inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
+    inline auto GetItems() -> std::vector<std::pair<K, V>> & { return items_; }
+
+    /** @brief Latch protecting the items of this bucket. */
+    inline auto GetLatch() const -> std::shared_mutex & { return latch_; }
+
+    /** @brief A bucket is retired once a split has replaced it in the directory. */
+    inline auto IsRetired() const -> bool { return retired_.load(std::memory_order_acquire); }
+
+    /** @brief Retire the bucket, must hold its latch in exclusive mode. */
+    inline void Retire() { retired_.store(true, std::memory_order_release); }
 
     /**
      *
@@ -158,29 +175,34 @@ class ExtendibleHashTable : public HashTable<K, V> {
     auto Insert(const K &key, const V &value) -> bool;
 
    private:
-    // TODO(student): You may add additional private members and helper functions
     size_t size_;
     int depth_;
-    std::list<std::pair<K, V>> list_;
+    std::vector<std::pair<K, V>> items_;
+    mutable std::shared_mutex latch_;
+    std::atomic<bool> retired_{false};
   };
 
  private:
-  // TODO(student): You may add additional private members and helper functions and remove the ones
-  // you don't need.
-
   int global_depth_;    // The global depth of the directory
   size_t bucket_size_;  // The size of a bucket
   int num_buckets_;     // The number of buckets in the hash table
-  mutable std::mutex latch_;
+  mutable std::shared_mutex latch_;           // The directory latch
   std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table
 
-  // The following functions are completely optional, you can delete them if you have your own ideas.
+  /**
+   * @brief Copy out the bucket the key hashes to, holding the directory latch in shared mode only meanwhile.
+   * The bucket may be retired by the time the caller latches it.
+   * @param key The key to be hashed.
+   * @return The bucket the key currently hashes to.
+   */
+  auto GetBucket(const K &key) const -> std::shared_ptr<Bucket>;
 
   /**
-   * @brief Redistribute the kv pairs in a full bucket.
-   * @param bucket The bucket to be redistributed.
+   * @brief Split the given bucket if it is still full and still in the directory.
+   * Takes the directory latch in exclusive mode and then the bucket latch.
+   * @param bucket The bucket to be split.
    */
-  auto RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void;
+  void SplitBucket(const std::shared_ptr<Bucket> &bucket);
 
   /*****************************************************************
    * Must acquire latch_ first before calling the below functions. *
@@ -191,7 +213,7 @@ class ExtendibleHashTable : public HashTable<K, V> {
    * @param key The key to be hashed.
    * @return The entry index in the directory.
    */
-  auto IndexOf(const K &key) -> size_t;
+  auto IndexOf(const K &key) const -> size_t;
 
   auto GetGlobalDepthInternal() const -> int;
   auto GetLocalDepthInternal(int dir_index) const -> int;
@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregate_kernel.h
+//
+// Identification: src/include/execution/aggregate_kernel.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/plans/aggregation_plan.h"
+#include "type/type_id.h"
+#include "type/value.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** How the running state of an aggregate is kept */
+enum class AggregateKernel : uint8_t {
+  /** A Value, updated through Value::Add/Min/Max, for any aggregate the kernels below do not cover */
+  VALUE,
+  /** count(*) as an int64_t */
+  COUNT_STAR,
+  /** count(expr) of any input type as an int64_t */
+  COUNT,
+  /** sum/min/max over integers as an int64_t */
+  SUM_INTEGER,
+  MIN_INTEGER,
+  MAX_INTEGER,
+};
+
+/**
+ * @return the kernel of an aggregate over inputs of the given type
+ */
+inline auto PickAggregateKernel(AggregationType agg_type, TypeId input_type) -> AggregateKernel {
+  switch (agg_type) {
+    case AggregationType::CountStarAggregate:
+      return AggregateKernel::COUNT_STAR;
+    case AggregationType::CountAggregate:
+      return AggregateKernel::COUNT;
+    case AggregationType::SumAggregate:
+      return input_type == TypeId::INTEGER ? AggregateKernel::SUM_INTEGER : AggregateKernel::VALUE;
+    case AggregationType::MinAggregate:
+      return input_type == TypeId::INTEGER ? AggregateKernel::MIN_INTEGER : AggregateKernel::VALUE;
+    case AggregationType::MaxAggregate:
+      return input_type == TypeId::INTEGER ? AggregateKernel::MAX_INTEGER : AggregateKernel::VALUE;
+  }
+  return AggregateKernel::VALUE;
+}
+
+/**
+ * AggregateState is the running state of one aggregate of one group under a typed kernel. `valid_` is false while
+ * the aggregate is still NULL.
+ */
+struct AggregateState {
+  int64_t value_;
+  bool valid_;
+};
+
+/**
+ * The typed aggregate kernels. Every kernel knows how to fold one non-NULL input, and one NULL input, into a state,
+ * and how to merge two states. The loops below are instantiated once per kernel, so the per-row work is a few
+ * integer instructions instead of a switch on the aggregation type and a virtual call per Value operation.
+ * 类型特化的聚合内核：每种聚合在编译期生成各自的循环，逐行只做几条整数运算。
+ */
+template <AggregateKernel K>
+struct AggregateOp;
+
+template <>
+struct AggregateOp<AggregateKernel::COUNT_STAR> {
+  static constexpr bool READS_INPUT = false;
+  static void Combine(AggregateState *state, int64_t input) { state->value_++; }
+  static void CombineNull(AggregateState *state) { state->value_++; }
+  static void Merge(AggregateState *state, int64_t partial) { state->value_ += partial; }
+};
+
+template <>
+struct AggregateOp<AggregateKernel::COUNT> {
+  static constexpr bool READS_INPUT = false;
+  static void Combine(AggregateState *state, int64_t input) {
+    state->value_++;
+    state->valid_ = true;
+  }
+  //count 在看到第一行后即从 NULL 变为 0
+  static void CombineNull(AggregateState *state) { state->valid_ = true; }
+  static void Merge(AggregateState *state, int64_t partial) {
+    state->value_ += partial;
+    state->valid_ = true;
+  }
+};
+
+template <>
+struct AggregateOp<AggregateKernel::SUM_INTEGER> {
+  static constexpr bool READS_INPUT = true;
+  static void Combine(AggregateState *state, int64_t input) {
+    state->value_ = state->valid_ ? state->value_ + input : input;
+    state->valid_ = true;
+  }
+  static void CombineNull(AggregateState *state) {}
+  static void Merge(AggregateState *state, int64_t partial) { Combine(state, partial); }
+};
+
+template <>
+struct AggregateOp<AggregateKernel::MIN_INTEGER> {
+  static constexpr bool READS_INPUT = true;
+  static void Combine(AggregateState *state, int64_t input) {
+    state->value_ = state->valid_ ? std::min(state->value_, input) : input;
+    state->valid_ = true;
+  }
+  static void CombineNull(AggregateState *state) {}
+  static void Merge(AggregateState *state, int64_t partial) { Combine(state, partial); }
+};
+
+template <>
+struct AggregateOp<AggregateKernel::MAX_INTEGER> {
+  static constexpr bool READS_INPUT = true;
+  static void Combine(AggregateState *state, int64_t input) {
+    state->value_ = state->valid_ ? std::max(state->value_, input) : input;
+    state->valid_ = true;
+  }
+  static void CombineNull(AggregateState *state) {}
+  static void Merge(AggregateState *state, int64_t partial) { Combine(state, partial); }
+};
+
+/** @return an integer input of a typed kernel, cast if the expression produced another type */
+inline auto AggregateInput(const Value &input) -> int64_t {
+  return input.GetTypeId() == TypeId::INTEGER ? input.GetAs<int32_t>() : input.CastAs(TypeId::INTEGER).GetAs<int32_t>();
+}
+
+/**
+ * Fold a column of inputs into the states of their groups.
+ * @param groups the group of every row
+ * @param column the input of every row, not read by kernels that do not need it
+ * @param states the states of all groups, `stride` states per group
+ * @param stride the number of aggregates per group
+ */
+template <AggregateKernel K>
+void CombineColumn(const std::vector<uint32_t> &groups, const std::vector<Value> &column, AggregateState *states,
+                   size_t stride) {
+  using Op = AggregateOp<K>;
+  for (size_t row = 0; row < groups.size(); row++) {
+    AggregateState *state = &states[groups[row] * stride];
+    if constexpr (K == AggregateKernel::COUNT_STAR) {
+      Op::CombineNull(state);
+    } else if (column[row].IsNull()) {
+      Op::CombineNull(state);
+    } else if constexpr (Op::READS_INPUT) {
+      Op::Combine(state, AggregateInput(column[row]));
+    } else {
+      Op::Combine(state, 0);
+    }
+  }
+}
+
+/** Merge a partial aggregate, as produced by AggregateStateToValue(), into a state. */
+template <AggregateKernel K>
+void MergeState(AggregateState *state, const Value &partial) {
+  if (!partial.IsNull()) {
+    AggregateOp<K>::Merge(state, AggregateInput(partial));
+  }
+}
+
+/** @return the initial state of an aggregate */
+inline auto InitialAggregateState(AggregateKernel kernel) -> AggregateState {
+  //count(*) 的初值为 0，其余为 NULL
+  return {0, kernel == AggregateKernel::COUNT_STAR};
+}
+
+/** @return the state of an aggregate as the INTEGER Value the aggregation outputs */
+inline auto AggregateStateToValue(const AggregateState &state) -> Value {
+  if (!state.valid_) {
+    return ValueFactory::GetNullValueByType(TypeId::INTEGER);
+  }
+  if (state.value_ > BUSTUB_INT32_MAX || state.value_ < BUSTUB_INT32_MIN) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+  }
+  return ValueFactory::GetIntegerValue(static_cast<int32_t>(state.value_));
+}
+
+}  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.h
+//
+// Identification: src/include/execution/compiled_expression.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/tuple_batch.h"
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * CompiledExpression is an expression flattened, once per query, into a program of vector instructions.
+ *
+ * Each instruction runs over a whole batch and fills its own register: one value and one NULL flag per row.
+ * Columns are loaded straight from the tuple bytes and booleans are kept as 0/1 lanes. The loop of every operator is
+ * its own template instantiation without branches, so the compiler can vectorize it, and comparisons and and/or
+ * use AVX2 when the CPU has it. Values are only built for the final result, and a predicate needs none at all.
+ *
+ * The program covers fixed-width expressions over the inlined columns of the batch: TINYINT, SMALLINT, INTEGER,
+ * BIGINT, DECIMAL and BOOLEAN column values and constants, + and - of integers, comparisons of numbers, and and/or.
+ * Any other expression keeps the expression tree and its EvaluateBatch().
+ * 编译后的表达式：查询开始时把表达式树展开成按批执行的指令序列，直接读元组字节，不为中间结果构造 Value。
+ */
+class CompiledExpression {
+ public:
+  /** An empty expression, which Filter() treats as always true */
+  CompiledExpression() = default;
+
+  /** Compile an expression, or keep the tree if the program cannot express it. `nullptr` gives an empty one. */
+  explicit CompiledExpression(AbstractExpressionRef expr);
+
+  /** @return true if the expression was compiled into a program */
+  auto IsCompiled() const -> bool { return !program_.empty(); }
+
+  /** Evaluate over every row of a batch, see AbstractExpression::EvaluateBatch() */
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const;
+
+  /** Evaluate over every row of a batch, see AbstractExpression::EvaluateBatchRef() */
+  auto EvaluateBatchRef(const TupleBatch &batch, std::vector<Value> *scratch) const -> const std::vector<Value> &;
+
+  /** Keep only the rows of a batch the expression is true on, NULL counts as false */
+  void Filter(TupleBatch *batch) const;
+
+ private:
+  enum class OpCode : uint8_t { LOAD_COLUMN, LOAD_CONSTANT, ARITHMETIC, COMPARE, AND, OR };
+
+  /**
+   * The lane a register keeps its values in. TINYINT, SMALLINT, INTEGER and BOOLEAN share the int32 lane, and the
+   * operands of a comparison are widened to the lane of the wider one, like the comparisons of Value.
+   */
+  enum class Lane : uint8_t { INT32, INT64, DECIMAL };
+
+  /** An instruction writes the register of the same index as the instruction */
+  struct Instruction {
+    OpCode op_;
+    /** The lane of the result, or of the operands of a comparison */
+    Lane lane_{Lane::INT32};
+    /** The registers of the operands */
+    uint32_t lhs_{0};
+    uint32_t rhs_{0};
+    /** The type of a loaded column or constant */
+    TypeId type_{TypeId::INVALID};
+    uint32_t col_idx_{0};
+    int64_t constant_{0};
+    double decimal_constant_{0};
+    bool constant_null_{false};
+    /** A constant only read by a comparison against it, which keeps a single lane instead of one per row */
+    bool scalar_{false};
+    ArithmeticType arithmetic_type_{ArithmeticType::Plus};
+    ComparisonType comparison_type_{ComparisonType::Equal};
+  };
+
+  /** One value and one NULL flag per row of the batch, only the vector of the lane of the register is used */
+  struct Register {
+    std::vector<int32_t> values_;
+    std::vector<int64_t> bigints_;
+    std::vector<double> decimals_;
+    std::vector<uint8_t> nulls_;
+  };
+
+  /**
+   * Append the instructions of an expression whose result is kept in the given lane.
+   * @return its register or std::nullopt if it cannot be compiled
+   */
+  auto Emit(const AbstractExpression &expr, Lane lane) -> std::optional<uint32_t>;
+
+  /** @return the lane a number of the given type is kept in, std::nullopt if it is not a fixed-width number */
+  static auto LaneOf(TypeId type) -> std::optional<Lane>;
+
+  /** Run the program over a batch, the result is in the last register */
+  void Run(const TupleBatch &batch, std::vector<Register> *registers) const;
+
+  AbstractExpressionRef expr_;
+  std::vector<Instruction> program_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -21,6 +22,7 @@
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -44,7 +46,7 @@ class ExecutionEngine {
   /**
    * Execute a query plan.
    * @param plan The query plan to execute
-   * @param result_set The set of tuples produced by executing the plan
+   * @param result_set The set of tuples produced by executing the plan, kept in the arena of `exec_ctx`
    * @param txn The transaction context in which the query executes
    * @param exec_ctx The executor context in which the query executes
    * @return `true` if execution of the query plan succeeds, `false` otherwise
@@ -62,7 +64,7 @@ class ExecutionEngine {
 
     try {
       executor->Init();
-      PollExecutor(executor.get(), plan, result_set);
+      PollExecutor(executor.get(), plan, result_set, exec_ctx);
     } catch (const ExecutionException &ex) {
 #ifndef NDEBUG
       LOG_ERROR("Error Encountered in Executor Execution: %s", ex.what());
@@ -78,18 +80,20 @@ class ExecutionEngine {
 
  private:
   /**
-   * Poll the executor until exhausted, or exception escapes.
+   * Poll the executor batch by batch until exhausted, or exception escapes.
    * @param executor The root executor
    * @param plan The plan to execute
    * @param result_set The tuple result set
+   * @param exec_ctx The executor context, whose arena keeps the result tuples until the query is done
    */
   static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
-                           std::vector<Tuple> *result_set) {
-    RID rid{};
-    Tuple tuple{};
-    while (executor->Next(&tuple, &rid)) {
+                           std::vector<Tuple> *result_set, ExecutorContext *exec_ctx) {
+    TupleBatch batch{};
+    while (executor->NextBatch(&batch)) {
       if (result_set != nullptr) {
-        result_set->push_back(tuple);
+        for (size_t i = 0; i < batch.Size(); i++) {
+          result_set->push_back(exec_ctx->GetArena().Store(batch.GetTuple(i)));
+        }
       }
     }
   }
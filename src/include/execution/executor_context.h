@@ -18,7 +18,9 @@
 
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
+#include "execution/task_scheduler.h"
 #include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple_arena.h"
 
 namespace bustub {
 /**
@@ -35,10 +37,16 @@ class ExecutorContext {
    * @param bpm The buffer pool manager that the executor uses
    * @param txn_mgr The transaction manager that the executor uses
    * @param lock_mgr The lock manager that the executor uses
+   * @param scheduler The scheduler that runs parallel pipelines, `nullptr` runs every executor on the calling thread
    */
   ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
-                  LockManager *lock_mgr)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, txn_mgr_(txn_mgr), lock_mgr_(lock_mgr) {}
+                  LockManager *lock_mgr, TaskScheduler *scheduler = nullptr)
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        txn_mgr_(txn_mgr),
+        lock_mgr_(lock_mgr),
+        scheduler_(scheduler) {}
 
   ~ExecutorContext() = default;
 
@@ -62,6 +70,15 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /** @return the task scheduler, may be `nullptr` */
+  auto GetTaskScheduler() -> TaskScheduler * { return scheduler_; }
+
+  /**
+   * @return the arena of the query, for tuples kept until the query is done such as its result; it is freed as a
+   * whole with the context and is only used by the thread running the plan
+   */
+  auto GetArena() -> TupleArena & { return arena_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -73,6 +90,10 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The task scheduler associated with this executor context */
+  TaskScheduler *scheduler_;
+  /** The memory of the tuples kept for the whole query */
+  TupleArena arena_;
 };
 
 }  // namespace bustub
@@ -12,7 +12,11 @@
 
 #pragma once
 
+#include <memory>
+#include <utility>
+
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -20,6 +24,11 @@ namespace bustub {
  * The AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
  * This is the base class from which all executors in the BustTub execution
  * engine inherit, and defines the minimal interface that all executors support.
+ *
+ * Executors may also produce a batch of tuples per call with NextBatch(). Executors
+ * that do not override it get an adapter on top of Next(), and executors that do can
+ * implement Next() with NextFromBatch(). A consumer should stick to one of the two
+ * interfaces for the whole lifetime of an executor.
  */
 class AbstractExecutor {
  public:
@@ -46,6 +55,23 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of tuples from this executor.
+   * The default adapter fills the batch by calling Next() until the batch is full.
+   * 默认实现通过反复调用 Next() 填满一个批次，未改造为批量执行的算子都使用它
+   * @param[out] batch The batch to fill, it is reset by the executor
+   * @return `true` if at least one tuple was produced, `false` if there are no more tuples
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    Tuple tuple{};
+    RID rid{};
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->Append(std::move(tuple), rid);
+    }
+    return !batch->IsEmpty();
+  }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() const -> const Schema & = 0;
 
@@ -53,7 +79,42 @@ class AbstractExecutor {
   auto GetExecutorContext() -> ExecutorContext * { return exec_ctx_; }
 
  protected:
+  /**
+   * The counterpart of the default NextBatch() adapter: yield the tuples of NextBatch() one at a time. Executors that
+   * override NextBatch() implement Next() with it and call ResetNextFromBatch() in Init().
+   * 批量执行的算子用它实现 Next()：逐个取出 NextBatch() 产生的元组
+   */
+  auto NextFromBatch(Tuple *tuple, RID *rid) -> bool {
+    if (next_batch_ == nullptr) {
+      next_batch_ = std::make_unique<TupleBatch>();
+    }
+    if (next_batch_idx_ == next_batch_->Size()) {
+      // Reset first, Next() may be called again once the executor is exhausted
+      next_batch_idx_ = 0;
+      if (!NextBatch(next_batch_.get())) {
+        return false;
+      }
+    }
+    *rid = next_batch_->GetRID(next_batch_idx_);
+    *tuple = next_batch_->TakeTuple(next_batch_idx_);
+    next_batch_idx_++;
+    return true;
+  }
+
+  /** Drop the tuples NextFromBatch() has buffered but not yielded yet */
+  void ResetNextFromBatch() {
+    if (next_batch_ != nullptr) {
+      next_batch_->Reset(&GetOutputSchema());
+    }
+    next_batch_idx_ = 0;
+  }
+
   /** The executor context in which the executor runs */
   ExecutorContext *exec_ctx_;
+
+ private:
+  /** The batch NextFromBatch() yields from, only allocated once it is used */
+  std::unique_ptr<TupleBatch> next_batch_;
+  size_t next_batch_idx_{0};
 };
 }  // namespace bustub
@@ -13,182 +13,291 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
+#include "execution/aggregate_kernel.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/parallel_pipeline.h"
 #include "execution/plans/aggregation_plan.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 /**
- * A simplified hash table that has all the necessary functionality for aggregations.
+ * AggregationHashTable maps the group-by values of a group to its running aggregates.
+ *
+ * Groups are rows of fixed width, their group-by values followed by their aggregates, stored in blocks of a flat row
+ * arena: adding a group allocates nothing but the data of its strings, and rows never move once stored. An
+ * open-addressing table of fixed-width slots holds the hash and row of every group. NULL group-by values form a
+ * group of their own, like in SQL.
+ * 聚合哈希表：每个分组是一行定长的行（group by 值加聚合值），存放在按块分配的行区域中，开放寻址表只存哈希值和行号。
+ *
+ * Aggregates a typed AggregateKernel covers, i.e. count and integer sum/min/max, keep their state as an
+ * AggregateState next to the row instead of a Value, and CombineBatch() folds a whole input column into them with one
+ * loop per aggregate. Their Values in the row are only written by GetRow().
  */
-class SimpleAggregationHashTable {
+class AggregationHashTable {
  public:
   /**
-   * Construct a new SimpleAggregationHashTable instance.
+   * Construct a new AggregationHashTable instance.
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
+   * @param num_group_bys the number of group-by values of a group
    */
-  SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return The initial aggregrate value for this aggregation executor */
-  auto GenerateInitialAggregateValue() -> AggregateValue {
-    std::vector<Value> values{};
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountStarAggregate:
-        //当对空表执行聚合时，CountStarAggregate应返回零，
-          // Count start starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::CountAggregate:
-        case AggregationType::SumAggregate:
-        case AggregationType::MinAggregate:
-        case AggregationType::MaxAggregate:
-
-          // Others starts at null.所有其他聚合类型应返回integer_ull
-          values.emplace_back(ValueFactory::GetNullValueByType(TypeId::INTEGER));
-          break;
+  AggregationHashTable(const std::vector<AbstractExpressionRef> &agg_exprs,
+                       const std::vector<AggregationType> &agg_types, size_t num_group_bys)
+      : agg_exprs_{agg_exprs}, agg_types_{agg_types}, num_group_bys_{num_group_bys} {
+    for (size_t i = 0; i < agg_types_.size(); i++) {
+      kernels_.push_back(PickAggregateKernel(agg_types_[i], agg_exprs_[i]->GetReturnType()));
+    }
+  }
+
+  /** @return the hash of the group-by values of a row */
+  auto HashGroupBys(const Value *group_bys) const -> hash_t {
+    hash_t curr_hash = 0;
+    for (size_t i = 0; i < num_group_bys_; i++) {
+      if (!group_bys[i].IsNull()) {
+        curr_hash = HashUtil::CombineHashes(curr_hash, HashUtil::HashValue(&group_bys[i]));
       }
     }
-    return {values};
+    return curr_hash;
+  }
+
+  /** @return The initial value of an aggregate */
+  auto GenerateInitialAggregateValue(size_t agg_idx) const -> Value {
+    switch (agg_types_[agg_idx]) {
+      case AggregationType::CountStarAggregate:
+      //当对空表执行聚合时，CountStarAggregate应返回零，
+        // Count start starts at zero.
+        return ValueFactory::GetIntegerValue(0);
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+      case AggregationType::MinAggregate:
+      case AggregationType::MaxAggregate:
+        break;
+    }
+    // Others starts at null.所有其他聚合类型应返回integer_ull
+    return ValueFactory::GetNullValueByType(TypeId::INTEGER);
   }
 
   /**
-   * TODO(Student)
    * 将输入进行聚合操作，加入到聚合结果中
-   * Combines the input into the aggregation result.
+   * Combines the input into the result of one aggregate.
+   * @param agg_idx The aggregate
    * @param[out] result The output aggregate value
    * @param input The input value
    */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
+  void CombineAggregateValue(size_t agg_idx, Value *result, const Value &input) const {
     //注意处理null值
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountStarAggregate:
-        //CountStarAggregate统计记录的个数，包含null值，其余聚合算子均不计算null值
-          result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          break;
-        case AggregationType::CountAggregate:
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = ValueFactory::GetIntegerValue(0);
-          }
-          if (!input.aggregates_[i].IsNull()) {
-            result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          }
-          break;
-        case AggregationType::SumAggregate:
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else if (!input.aggregates_[i].IsNull()) {
-            result->aggregates_[i] = result->aggregates_[i].Add(input.aggregates_[i]);
-          }
-          break;
-        case AggregationType::MinAggregate:
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else if (!input.aggregates_[i].IsNull()) {
-            result->aggregates_[i] = result->aggregates_[i].Min(input.aggregates_[i]);
-          }
-          break;
-        case AggregationType::MaxAggregate:
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else if (!input.aggregates_[i].IsNull()) {
-            result->aggregates_[i] = result->aggregates_[i].Max(input.aggregates_[i]);
-          }
-          break;
-      }
+    switch (agg_types_[agg_idx]) {
+      case AggregationType::CountStarAggregate:
+      //CountStarAggregate统计记录的个数，包含null值，其余聚合算子均不计算null值
+        *result = result->Add(ValueFactory::GetIntegerValue(1));
+        break;
+      case AggregationType::CountAggregate:
+        if (result->IsNull()) {
+          *result = ValueFactory::GetIntegerValue(0);
+        }
+        if (!input.IsNull()) {
+          *result = result->Add(ValueFactory::GetIntegerValue(1));
+        }
+        break;
+      case AggregationType::SumAggregate:
+        if (result->IsNull()) {
+          *result = input;
+        } else if (!input.IsNull()) {
+          *result = result->Add(input);
+        }
+        break;
+      case AggregationType::MinAggregate:
+        if (result->IsNull()) {
+          *result = input;
+        } else if (!input.IsNull()) {
+          *result = result->Min(input);
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (result->IsNull()) {
+          *result = input;
+        } else if (!input.IsNull()) {
+          *result = result->Max(input);
+        }
+        break;
     }
   }
 
   /**
-   * Inserts a value into the hash table and then combines it with the current aggregation.
-   * @param agg_key the key to be inserted
-   * @param agg_val the value to be inserted
+   * Merges a partial result of one aggregate into the aggregation result.
+   * 合并两个部分聚合结果，用于并行聚合时合并各个线程的局部哈希表，以及合并溢出到磁盘的部分结果
+   * @param agg_idx The aggregate
+   * @param[out] result The output aggregate value
+   * @param partial The partial aggregate value computed over other input
    */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    //若当前 hashmap 中没有 group by 的记录，则创建初值；
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
+  void MergeAggregateValue(size_t agg_idx, Value *result, const Value &partial) const {
+    if (agg_types_[agg_idx] == AggregationType::CountStarAggregate) {
+      //count(*) 的初值为 0，直接相加
+      *result = result->Add(partial);
+      return;
+    }
+    if (partial.IsNull()) {
+      return;
+    }
+    if (result->IsNull()) {
+      *result = partial;
+      return;
+    }
+    switch (agg_types_[agg_idx]) {
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+        *result = result->Add(partial);
+        break;
+      case AggregationType::MinAggregate:
+        *result = result->Min(partial);
+        break;
+      case AggregationType::MaxAggregate:
+        *result = result->Max(partial);
+        break;
+      case AggregationType::CountStarAggregate:
+        break;
     }
-    //若已有记录，则按 aggregate 规则逐一更新所有的 aggregate 字段，例如取 max/min，求 sum 等等
-    CombineAggregateValues(&ht_[agg_key], agg_val);
   }
 
-  void InsertIntialCombine() { ht_.insert({{std::vector<Value>()}, GenerateInitialAggregateValue()}); }
+  /**
+   * Merges all the groups of another hash table of the same aggregation into this one, the other table is left empty.
+   * @param other The hash table holding partial aggregation results
+   */
+  void Merge(AggregationHashTable *other);
 
   /**
-   * Clear the hash table
+   * Merges the given groups of another hash table of the same aggregation into this one.
+   * @param other The hash table holding partial aggregation results
+   * @param groups The groups of the other table to merge
    */
-  void Clear() { ht_.clear(); }
+  void Merge(const AggregationHashTable &other, const std::vector<uint32_t> &groups) {
+    for (auto group : groups) {
+      MergeGroup(other, group);
+    }
+  }
 
-  /** An iterator over the aggregation hash table */
-  class Iterator {
-   public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_{iter} {}
+  /**
+   * Finds the group of a row, creating it with initial aggregates if needed.
+   * @param group_bys the group-by values of the row
+   * @param hash the hash of the group-by values, see HashGroupBys()
+   * @return the group
+   */
+  auto FindOrInsert(const Value *group_bys, hash_t hash) -> uint32_t;
 
-    /** @return The key of the iterator */
-    auto Key() -> const AggregateKey & { return iter_->first; }
+  /**
+   * Combines the aggregate inputs of a batch of rows into their groups, one aggregate at a time.
+   * @param groups the group of every row, see FindOrInsert()
+   * @param inputs the input column of every aggregate
+   */
+  void CombineBatch(const std::vector<uint32_t> &groups, const std::vector<const std::vector<Value> *> &inputs);
 
-    /** @return The value of the iterator */
-    auto Val() -> const AggregateValue & { return iter_->second; }
+  /**
+   * Finds a group, creating it if needed, and merges partial aggregates of the group into it.
+   * @param group_bys the group-by values of the group
+   * @param hash the hash of the group-by values, see HashGroupBys()
+   * @param partial the partial aggregate values of the group
+   */
+  void InsertMerge(const Value *group_bys, hash_t hash, const Value *partial);
 
-    /** @return The iterator before it is incremented */
-    auto operator++() -> Iterator & {
-      ++iter_;
-      return *this;
-    }
+  /** Adds the group of an aggregation without GROUP BY over an empty input. */
+  void InsertIntialCombine() { FindOrInsert(nullptr, 0); }
 
-    /** @return `true` if both iterators are identical */
-    auto operator==(const Iterator &other) -> bool { return this->iter_ == other.iter_; }
+  /** Removes all groups and gives back their memory. */
+  void Clear();
 
-    /** @return `true` if both iterators are different */
-    auto operator!=(const Iterator &other) -> bool { return this->iter_ != other.iter_; }
+  /** @return The number of groups, groups are numbered 0..Size()-1 in insertion order */
+  auto Size() const -> size_t { return hashes_.size(); }
 
-   private:
-    /** 
-     * Aggregates map 
-     * 
-     * */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
-  };
+  /** @return The group-by values of a group */
+  auto GetGroupBys(size_t group) const -> const Value * { return Row(group); }
+
+  /** @return The row of a group, its RowWidth() values are the group-by values followed by the aggregates */
+  auto GetRow(size_t group) -> const Value *;
 
-  /** @return Iterator to the start of the hash table */
-  auto Begin() -> Iterator { return Iterator{ht_.cbegin()}; }
+  /** @return The hash of the group-by values of a group */
+  auto GetHash(size_t group) const -> hash_t { return hashes_[group]; }
 
-  /** @return Iterator to the end of the hash table */
-  auto End() -> Iterator { return Iterator{ht_.cend()}; }
+  /** @return the number of values of a group row */
+  auto RowWidth() const -> size_t { return num_group_bys_ + agg_types_.size(); }
 
-  auto Size() -> size_t { return ht_.size(); }
+  /** @return the bytes held by the table and its groups */
+  auto MemoryUsage() const -> size_t {
+    return blocks_.size() * ROWS_PER_BLOCK * RowWidth() * sizeof(Value) + slots_.capacity() * sizeof(Slot) +
+           hashes_.capacity() * sizeof(hash_t) + states_.capacity() * sizeof(AggregateState) + varlen_bytes_;
+  }
 
  private:
- //SimpleAggregationHashTable 维护一张 hashmap，键为 AggregateKey，值为 AggregateValue
-  //* key 代表 group by 的字段的数组，value 则是需要 aggregate 的字段的数组。
-  /** The hash table is just a map from aggregate keys to aggregate values */
-  std::unordered_map<AggregateKey, AggregateValue> ht_{};
+  /** A slot of the open-addressing table, one per group */
+  struct Slot {
+    hash_t hash_;
+    uint32_t group_{NO_GROUP};
+  };
+  static constexpr uint32_t NO_GROUP = UINT32_MAX;
+  static constexpr size_t ROWS_PER_BLOCK = 256;
+
+  auto Row(size_t group) const -> Value * {
+    return &blocks_[group / ROWS_PER_BLOCK][(group % ROWS_PER_BLOCK) * RowWidth()];
+  }
+
+  /** @return the typed state of an aggregate of a group */
+  auto State(size_t group, size_t agg_idx) -> AggregateState * { return &states_[group * agg_types_.size() + agg_idx]; }
+  auto State(size_t group, size_t agg_idx) const -> const AggregateState * {
+    return &states_[group * agg_types_.size() + agg_idx];
+  }
+
+  /** Merge a group of another table of the same aggregation into this one. */
+  void MergeGroup(const AggregationHashTable &other, size_t group);
+
+  /** @return whether the group-by values of a group equal the given ones, NULL equals NULL */
+  auto GroupEquals(size_t group, const Value *group_bys) const -> bool;
+
+  /** Double the number of slots and place the groups again. */
+  void Grow();
+
   /** The aggregate expressions that we have */
   const std::vector<AbstractExpressionRef> &agg_exprs_;
   /** The types of aggregations that we have */
   const std::vector<AggregationType> &agg_types_;
+  /** How every aggregate keeps its state */
+  std::vector<AggregateKernel> kernels_;
+  size_t num_group_bys_;
+
+  /** The group rows, ROWS_PER_BLOCK rows of RowWidth() values per block, and the hash of every group */
+  std::vector<std::unique_ptr<Value[]>> blocks_;
+  std::vector<hash_t> hashes_;
+  /** The typed states, one per aggregate and group, only used for aggregates with a typed kernel */
+  std::vector<AggregateState> states_;
+  /** Bytes of the strings among the group-by values */
+  size_t varlen_bytes_{0};
+  std::vector<Slot> slots_;
 };
 
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
  * AggregationExecutor对子执行器生成的元组执行聚合操作（例如COUNT、SUM、MIN、MAX）。
+ *
+ * Once the hash table outgrows `execution_memory_limit`, its groups are split into 2^SPILL_RADIX_BITS partitions by
+ * their hash and written to TmpTupleFiles as partial aggregates, and the table starts over empty. After the input,
+ * every partition is read back and merged on its own, and its groups are output before the next one is loaded. A
+ * partition that is still too large is split again by the next bits of the hash.
+ *
+ * Over a ParallelPipeline the aggregation runs in two phases. Every worker first pre-aggregates its morsels into a
+ * hash table of its own, without any locking. The groups of all workers are then radix-partitioned by their hash and
+ * every partition is merged into a table of its own by one worker, so that no two workers touch the same group. The
+ * partitions are output one after another. A worker spills its own table once it outgrows its share of the budget.
+ * 并行两阶段聚合：各工作线程先在局部哈希表中预聚合，再按哈希值分区，每个分区由一个工作线程合并。
+ * 哈希表超出内存预算时，按哈希值将分组的部分聚合结果分区溢出到磁盘，输入结束后逐个分区合并并输出。
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -212,6 +321,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of aggregated tuples.
+   * @param[out] batch The next batch produced by the aggregation
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -219,22 +335,36 @@ class AggregationExecutor : public AbstractExecutor {
   auto GetChildExecutor() const -> const AbstractExecutor *;
 
  private:
-  /** @return The tuple as an AggregateKey */
-  auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
-    std::vector<Value> keys;
-    for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {keys};
-  }
+  /** Evaluates the group-bys and aggregates over a batch and combines every row into the given hash table. */
+  void AggregateBatch(AggregationHashTable *aht, const TupleBatch &batch);
 
-  /** @return The tuple as an AggregateValue */
-  auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
-    std::vector<Value> vals;
-    for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {vals};
+  /** Runs the child pipeline in parallel into per-worker hash tables and merges them into aht_ or merged_tables_. */
+  void AggregateParallel(ParallelPipeline *pipeline);
+
+  /**
+   * Merges the per-worker hash tables into merged_tables_, one table per radix partition, on the workers. The
+   * per-worker tables are merged one after another and each is cleared as soon as it has been merged.
+   */
+  void MergePartitioned(std::vector<AggregationHashTable> *local_tables);
+
+  /**
+   * Writes all groups of a hash table to the spill files of their partitions and empties the table.
+   * @param aht the hash table
+   * @param spiller the set of spill files to write to, one per worker of a parallel aggregation
+   */
+  void SpillGroups(AggregationHashTable *aht, size_t spiller);
+
+  /** Queues the partitions spilled so far, to be merged after the input. */
+  void FinishSpill();
+
+  /** Loads the next merged or spilled partition into aht_, @return `false` once all partitions were output */
+  auto LoadNextPartition() -> bool;
+
+  /** @return The output tuple of a group, its group-bys followed by its aggregates */
+  auto MakeOutputTuple(AggregationHashTable *aht, size_t group) const -> Tuple {
+    //Aggregation 输出的 schema 形式为 group-bys + aggregates。
+    const Value *row = aht->GetRow(group);
+    return Tuple{std::vector<Value>(row, row + aht->RowWidth()), &GetOutputSchema()};
   }
 
  private:
@@ -242,9 +372,30 @@ class AggregationExecutor : public AbstractExecutor {
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  SimpleAggregationHashTable aht_;
-  /** Simple aggregation hash table iterator */
-  SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** Aggregation hash table */
+  AggregationHashTable aht_;
+  /** The next group of aht_ to output */
+  size_t group_idx_{0};
+
+  /** Spilled groups are split by this many bits of their hash per level, and split again at most this often */
+  static constexpr size_t SPILL_RADIX_BITS = 4;
+  static constexpr size_t MAX_SPILL_DEPTH = 3;
+  /** A spilled partition, written by one or more spillers, and how many times its groups have been split */
+  struct SpilledPartition {
+    std::vector<std::unique_ptr<TmpTupleFile>> files_;
+    size_t depth_;
+  };
+  /** The partitions being spilled to at spill_depth_ per spiller, empty for a spiller that has not spilled */
+  std::vector<std::vector<std::unique_ptr<TmpTupleFile>>> spill_files_;
+  size_t spill_depth_{0};
+  /** The partitions still to merge and output */
+  std::vector<SpilledPartition> pending_partitions_;
+
+  /** Parallel merge: the groups of all workers split by this many bits of their hash, one table per partition */
+  static constexpr size_t MERGE_RADIX_BITS = 6;
+  /** Fewer groups than this are merged by the calling thread */
+  static constexpr size_t PARALLEL_MERGE_MIN_GROUPS = 4 * BUSTUB_BATCH_SIZE;
+  std::vector<AggregationHashTable> merged_tables_;
+  size_t merged_table_idx_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_heap_scan_executor.h
+//
+// Identification: src/include/execution/executors/bitmap_heap_scan_executor.h
+//
+// Copyright (c) 2015-20, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/compiled_expression.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/locked_row_reader.h"
+#include "execution/plans/bitmap_heap_scan_plan.h"
+#include "execution/rid_bitmap.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * BitmapHeapScanExecutor executes a bitmap heap scan over a table.
+ *
+ * Init() runs every index lookup of the plan and combines their RIDs in a RidBitmap. The rows are then read a batch
+ * of RIDs at a time in page order, so that each heap page is fetched once, locked before they are read, and filtered
+ * by the residual predicate.
+ * 初始化时把各索引查找的 RID 合并成位图，之后按页顺序分批读取元组。
+ */
+class BitmapHeapScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new bitmap heap scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the bitmap heap scan plan to be executed
+   */
+  BitmapHeapScanExecutor(ExecutorContext *exec_ctx, const BitmapHeapScanPlanNode *plan);
+
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+ private:
+  /** @return the bitmap of the RIDs of all lookups of a clause */
+  auto LookupClause(const std::vector<BitmapIndexLookup> &clause) -> RidBitmap;
+
+  /** The bitmap heap scan plan node to be executed. */
+  const BitmapHeapScanPlanNode *plan_;
+  const TableInfo *table_info_;
+  /** The RIDs left in the bitmap in page order, and the next one to read */
+  std::vector<RID> rids_;
+  size_t rid_idx_{0};
+
+  /** Locks the rows of a batch of RIDs, then reads them */
+  LockedRowReader row_reader_;
+
+  /** The residual predicate, compiled once for the whole scan */
+  CompiledExpression residual_;
+};
+}  // namespace bustub
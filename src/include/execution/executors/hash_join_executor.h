@@ -12,21 +12,122 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "common/util/hash_util.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/parallel_pipeline.h"
 #include "execution/plans/hash_join_plan.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tmp_tuple_file.h"
+#include "storage/table/tuple_arena.h"
 
 namespace bustub {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * JoinHashTable is the build side of a hash join: an open-addressing table keyed on the join key itself, whose slots
+ * point into a chain of the build tuples with that key. The tuples are stored in a TupleArena.
+ * 哈希连接的构建侧：以连接键本身为键的开放寻址哈希表，相同键的元组串成链表，元组数据存放在 TupleArena 中。
+ */
+class JoinHashTable {
+ public:
+  /** Marks the end of a chain */
+  static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+  /**
+   * Insert a build tuple. A NULL key never joins, so the tuple is dropped.
+   * @param key the join key of the tuple
+   * @param tuple the tuple, copied into the arena
+   */
+  void Insert(Value key, const Tuple &tuple) {
+    auto hash = HashUtil::HashValue(&key);
+    Insert(std::move(key), hash, tuple);
+  }
+
+  /** Insert a build tuple whose key hash, i.e. HashUtil::HashValue(&key), is known already. */
+  void Insert(Value key, hash_t hash, const Tuple &tuple);
+
+  /**
+   * @param key the probe key
+   * @return the first entry of the chain of the key, or NO_ENTRY if no build tuple has the key
+   */
+  auto Find(const Value &key) const -> uint32_t {
+    return key.IsNull() ? NO_ENTRY : Find(key, HashUtil::HashValue(&key));
+  }
+
+  /** Look up a probe key whose hash is known already. */
+  auto Find(const Value &key, hash_t hash) const -> uint32_t;
+
+  /** @return the entry after the given one in its chain, or NO_ENTRY */
+  auto Next(uint32_t entry) const -> uint32_t { return entries_[entry].next_; }
+
+  /** @return the build tuple of an entry */
+  auto GetTuple(uint32_t entry) const -> const Tuple & { return entries_[entry].tuple_; }
+
+  /** @return the join key of an entry, entries are numbered 0..Size()-1 in insertion order */
+  auto GetKey(uint32_t entry) const -> const Value & { return entries_[entry].key_; }
+
+  /** @return the hash of the join key of an entry */
+  auto GetHash(uint32_t entry) const -> hash_t { return entries_[entry].hash_; }
+
+  /** @return the number of build tuples */
+  auto Size() const -> size_t { return entries_.size(); }
+
+  /** @return the bytes held by the table and its tuples */
+  auto MemoryUsage() const -> size_t {
+    return arena_.MemoryUsage() + entries_.capacity() * sizeof(Entry) + slots_.capacity() * sizeof(Slot);
+  }
+
+  /** Remove all tuples. */
+  void Clear();
+
+ private:
+  struct Entry {
+    hash_t hash_;
+    Value key_;
+    Tuple tuple_;
+    uint32_t next_;
+  };
+
+  /** A slot of the open-addressing table, one per distinct key; the chain runs in insertion order */
+  struct Slot {
+    uint32_t head_{NO_ENTRY};
+    uint32_t tail_{NO_ENTRY};
+  };
+
+  /** @return the slot holding the key, or the empty slot where it belongs */
+  auto FindSlot(hash_t hash, const Value &key) const -> size_t;
+
+  /** Double the number of slots and place the chains again. */
+  void Grow();
+
+  std::vector<Entry> entries_;
+  std::vector<Slot> slots_;
+  size_t num_keys_{0};
+  TupleArena arena_;
+};
+
+/**
+ * HashJoinExecutor executes a hash JOIN on two tables.
+ *
+ * Init() builds a JoinHashTable from the right child. The left child is probed batch by batch from Next() and
+ * NextBatch(), so only one batch of the output is held at a time and a LIMIT above the join stops the probe early.
+ *
+ * If the build side outgrows `execution_memory_limit`, the join turns into a hybrid hash join: both sides are split
+ * into 2^SPILL_RADIX_BITS partitions by their key hash. Partition 0 stays in memory as long as it fits, the others
+ * are spilled to TmpTupleFiles. Left rows of partition 0 are joined while the left child is read, the spilled
+ * partitions are joined one by one afterwards by loading their build rows into the table.
+ * 构建侧超出内存预算时，按哈希值将两侧切分为若干分区溢出到磁盘，之后逐个分区完成连接。
+ *
+ * A side that runs as a ParallelPipeline is joined on the TaskScheduler. The build side is radix-partitioned by the
+ * workers scanning it, then every partition gets a JoinHashTable of its own, built by one worker, small enough to
+ * stay in cache. The probe side runs in rounds of a few morsels per worker, so that only the output of one round is
+ * held at a time.
+ * 并行连接：构建侧按基数分区后每个分区由一个工作线程建表；探测侧按轮次并行执行。
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -51,20 +152,95 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of joined tuples.
+   * @param[out] batch The next batch produced by the join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** Build radix-partitioned hash tables from the right side running as a parallel pipeline */
+  void BuildParallel(ParallelPipeline *pipeline);
+
+  /** Run the next round of morsels of the parallel probe into round_output_, @return `false` once all have run */
+  auto NextProbeRound() -> bool;
+
+  /**
+   * Look up a probe key in the build side.
+   * @param key the probe key
+   * @param[out] table the table the chain of the key lives in
+   * @return the first build entry with the key, or NO_ENTRY
+   */
+  auto FindMatch(const Value &key, const JoinHashTable **table) const -> uint32_t;
+
+  /** @return the join of a left row with a build tuple, or with NULLs if `right` is `nullptr` */
+  auto MakeJoinRow(const Tuple &left, const Tuple *right, std::vector<Value> *values) const -> Tuple;
+
+  /** Insert a build row, spilling the table once it outgrows the memory limit */
+  void AddBuildRow(Value key, const Tuple &tuple);
+
+  /** Move the build rows of every spilled partition from the table to their files. */
+  void SpillBuildSide();
+
+  /** Load the next batch of probe rows into probe_batch_, from the left child or from a spilled partition */
+  auto PullProbeBatch() -> bool;
+
+  /** Move the rows of spilled partitions out of probe_batch_ and probe_keys_ to their files. */
+  void SpillProbeRows();
+
+  /** Load the build rows of a spilled partition into the table. */
+  void LoadPartition(size_t partition);
+
+  /** Pull the next batch of probe rows and look up its first row, @return `false` once all rows were probed */
+  auto NextProbeBatch() -> bool;
+
+  /**
+   * Append a reference to the join of the current left row with a build tuple, or with NULLs if `right` is `nullptr`;
+   * the row is only built into a tuple if the executors above ask for it.
+   */
+  void EmitRow(TupleBatch *batch, const Tuple *right);
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
 
   std::unique_ptr<AbstractExecutor> left_executor_;
   std::unique_ptr<AbstractExecutor> right_executor_;
 
-  std::unordered_map<hash_t, std::vector<Tuple>> hash_join_table_;
+  JoinHashTable hash_table_;
+
+  /** Build side of a parallel build, one table per radix partition; empty if hash_table_ holds the build side */
+  static constexpr size_t PARALLEL_RADIX_BITS = 6;
+  std::vector<JoinHashTable> partitioned_tables_;
+
+  /** Spilled partitions are split by this many bits of the key hash */
+  static constexpr size_t SPILL_RADIX_BITS = 4;
+  static constexpr size_t NO_PARTITION = SIZE_MAX;
+  /** Build and probe rows of every partition, empty until the build side spills; partition 0 has no files while it
+   * stays in memory */
+  std::vector<std::unique_ptr<TmpTupleFile>> build_files_;
+  std::vector<std::unique_ptr<TmpTupleFile>> probe_files_;
+  /** The spilled partition being joined, NO_PARTITION while the left child is probed */
+  size_t partition_idx_{NO_PARTITION};
+
+  /** Probe state: the current left batch, its join keys, the current row and its next match */
+  TupleBatch probe_batch_;
+  std::vector<Value> probe_keys_;
+  size_t probe_idx_{0};
+  uint32_t match_{JoinHashTable::NO_ENTRY};
+  const JoinHashTable *match_table_{nullptr};
+  bool probe_matched_{false};
+  bool probe_done_{false};
 
-  std::vector<Tuple> output_tuples_;
-  std::vector<Tuple>::const_iterator output_tuples_iter_;
+  /** Parallel probe: the left pipeline, the next morsel to run, and the output of the current round per morsel */
+  std::unique_ptr<ParallelPipeline> probe_pipeline_;
+  size_t next_morsel_{0};
+  std::vector<std::vector<Tuple>> round_output_;
+  size_t round_morsel_idx_{0};
+  size_t round_row_idx_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.h
+//
+// Identification: src/include/execution/executors/index_only_scan_executor.h
+//
+// Copyright (c) 2015-20, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/compiled_expression.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/locked_row_reader.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexOnlyScanExecutor executes an index-only scan, producing the rows straight from the index keys.
+ *
+ * Like IndexScanExecutor, Init() collects the keys and RIDs of every key range so that no latch is held while the
+ * rows flow up the plan. The RIDs are only used to lock the rows, no table page is ever fetched. Each row is locked
+ * before its key is emitted, and its index entry is looked up once more after the lock is granted, so that a row
+ * deleted or moved to another key in the meantime is skipped.
+ * 初始化时按键范围收集键值和 RID，之后直接用键值构造元组，不读表堆。
+ */
+class IndexOnlyScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new index-only scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the index-only scan plan to be executed
+   */
+  IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan);
+
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+ private:
+  /** Look up the keys [begin, end) in the index once more and set entry_found_ where they still map to their RID. */
+  void FindEntries(size_t begin, size_t end);
+
+  /** The index-only scan plan node to be executed. */
+  const IndexOnlyScanPlanNode *plan_;
+  const IndexInfo *index_info_;
+  const TableInfo *table_info_;
+  /** The keys in the ranges with their RIDs, and the next one to emit */
+  std::vector<Value> keys_;
+  std::vector<RID> rids_;
+  size_t key_idx_{0};
+
+  /** Locks the rows of the emitted keys */
+  LockedRowReader row_reader_;
+  /** Whether the entries of the current batch are still in the index, and scratch space of FindEntries() */
+  std::vector<bool> entry_found_;
+  std::vector<Tuple> entry_keys_;
+  std::vector<std::pair<size_t, RID>> entry_matches_;
+
+  /** The residual predicate, compiled once for the whole scan */
+  CompiledExpression residual_;
+};
+}  // namespace bustub
@@ -15,15 +15,23 @@
 #include <vector>
 
 #include "common/rid.h"
+#include "execution/compiled_expression.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/locked_row_reader.h"
 #include "execution/plans/index_scan_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * IndexScanExecutor executes an index scan over a table.
+ *
+ * Init() walks the B+ tree over every key range of the plan and collects the RIDs, so that the index is not latched
+ * while the rows flow up the plan, e.g. to a delete or update of the same table. The rows are then locked and read a
+ * batch of RIDs at a time, and filtered by the residual predicate.
+ * 初始化时按键范围收集 RID，之后按批读取元组并用残余谓词过滤。
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -41,14 +49,28 @@ class IndexScanExecutor : public AbstractExecutor {
 
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /**
+   * Append the RIDs of all keys in a range to rids in key order, and the keys themselves to keys unless it is nullptr.
+   * A hash index can only look up point ranges.
+   */
+  static void ScanRange(const IndexInfo *index_info, const IndexKeyRange &range, Transaction *txn,
+                        std::vector<RID> *rids, std::vector<Value> *keys = nullptr);
+
  private:
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   const IndexInfo *index_info_;
   const TableInfo *table_info_;
-  BPlusTreeIndexForOneIntegerColumn *tree_;
-  BPlusTreeIndexIteratorForOneIntegerColumn iter_;
+  /** The RIDs of all keys in the ranges, and the next one to read */
   std::vector<RID> rids_;
-  std::vector<RID>::const_iterator rid_iter_{};
+  size_t rid_idx_{0};
+
+  /** Locks the rows of a batch of RIDs, then reads them */
+  LockedRowReader row_reader_;
+
+  /** The residual predicate, compiled once for the whole scan */
+  CompiledExpression residual_;
 };
 }  // namespace bustub
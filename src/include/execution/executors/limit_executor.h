@@ -45,6 +45,13 @@ class LimitExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch from the limit, the last child batch is cut at the limit.
+   * @param[out] batch The next batch produced by the limit
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the limit */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
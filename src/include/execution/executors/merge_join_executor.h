@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/merge_join_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinExecutor executes an equi-JOIN on two children sorted ascending on the join key.
+ * 归并连接：左右两侧均按连接键升序输出，两个游标同步前进，不需要建哈希表。
+ *
+ * Both children are read once, in step. The executor only holds the run of right tuples whose key equals the key of
+ * the current left tuple, so its memory does not depend on the size of either input. Tuples with a NULL key never
+ * match; the left join pads them with NULLs.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new MergeJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The merge join plan to be executed
+   * @param left_child The child executor that produces tuples for the left side of join
+   * @param right_child The child executor that produces tuples for the right side of join
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
+
+  /** Initialize the join */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the join.
+   * @param[out] tuple The next tuple produced by the join
+   * @param[out] rid The next tuple RID produced by the join, not used by merge join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the join */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
+
+ private:
+  /** Read the next right tuple into right_tuple_, checking that the keys do not go down. */
+  void AdvanceRight();
+
+  /**
+   * Skip the right tuples with a smaller key and collect the ones with an equal key into right_run_.
+   * @param key the key of the current left tuple, not NULL
+   */
+  void LoadRightRun(const Value &key);
+
+  /**
+   * Build an output row.
+   * @param right_tuple the right tuple, or `nullptr` to pad the right side with NULLs
+   */
+  auto MakeJoinRow(const Tuple *right_tuple) const -> Tuple;
+
+  /** The merge join plan node to be executed. */
+  const MergeJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+
+  /** The current left tuple, and the last non-NULL left key */
+  Tuple left_tuple_;
+  Value left_key_;
+  bool has_left_key_{false};
+  /** The next right tuple not in right_run_ yet, valid if right_valid_, and its key unless it is NULL */
+  Tuple right_tuple_;
+  bool right_valid_{false};
+  Value right_key_;
+  bool has_right_key_{false};
+
+  /** The right tuples whose key equals run_key_ */
+  std::vector<Tuple> right_run_;
+  Value run_key_;
+  bool run_loaded_{false};
+  /** The next tuple of right_run_ to join with the current left tuple, right_run_.size() when done */
+  size_t run_idx_{0};
+};
+
+}  // namespace bustub
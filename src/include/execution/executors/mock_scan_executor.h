@@ -26,6 +26,15 @@ namespace bustub {
 extern const char *mock_table_list[];
 auto GetMockTableSchemaOf(const std::string &table) -> Schema;
 
+/** @return the number of rows of a mock table */
+auto GetSizeOf(const MockScanPlanNode *plan) -> size_t;
+
+/** @return whether the rows of a mock table are produced in random order */
+auto GetShuffled(const MockScanPlanNode *plan) -> bool;
+
+/** @return the function producing the row at a cursor of a mock table, safe to call from any thread */
+auto GetFunctionOf(const MockScanPlanNode *plan) -> std::function<Tuple(size_t)>;
+
 /**
  * The MockScanExecutor executor executes a sequential table scan for tests.
  */
@@ -22,6 +22,7 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/nested_index_join_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
@@ -29,6 +30,12 @@ namespace bustub {
 
 /**
  * IndexJoinExecutor executes index join operations.
+ *
+ * The outer side is probed a batch at a time. The join keys of a batch are looked up together
+ * (Index::ScanKeys), which the B+ tree does in one sweep over its leaves in key order. The matching inner tuples are
+ * then read in RID order (TableHeap::GetTuples), so every heap page is fetched once per batch. Every match of an
+ * outer row is emitted, in the order of the outer rows.
+ * 批量索引连接：一批外表键排序后一次扫过 B+ 树叶子，再按 RID 顺序读取内表元组。
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -48,13 +55,29 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
  private:
+  /** Join the next non-empty batch of the outer side into output_rows_, @return `false` once the child is exhausted */
+  auto ProbeBatch() -> bool;
+
+  /** @return the join of an outer row with an inner tuple, or with NULLs if `inner` is `nullptr` */
+  auto MakeJoinRow(size_t outer_idx, const Tuple *inner) -> Tuple;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
 
   std::unique_ptr<AbstractExecutor> child_;
   const IndexInfo *index_info_;
   const TableInfo *table_info_;
-  BPlusTreeIndexForOneIntegerColumn *tree_;
+
+  /** The current batch of the outer side, and its joined rows still to be emitted */
+  TupleBatch outer_batch_;
+  std::vector<Tuple> output_rows_;
+  size_t output_idx_{0};
+  bool outer_done_{false};
+
+  /** Scratch values of an output row */
+  std::vector<Value> values_;
 };
 }  // namespace bustub
@@ -19,6 +19,7 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/nested_loop_join_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -26,6 +27,13 @@ namespace bustub {
 /**
  * NestedLoopJoinExecutor executes a nested-loop JOIN on two tables.
  * NestedLoopJoinExecutor在两个表上执行嵌套循环JOIN。
+ *
+ * It is a block nested loop join. Init() reads the right side into chunks of one batch each, with all columns
+ * decoded once. The left side is read a batch (block) at a time, and every chunk is joined with the whole block
+ * before moving on to the next chunk, so a chunk stays in cache while the block runs over it. The predicate of a
+ * left row is evaluated over a whole chunk at once (AbstractExpression::EvaluateJoinBatch). If the right side fits
+ * into a single chunk, the output comes in the order of a tuple-at-a-time nested loop join.
+ * 块嵌套循环连接：右侧按批缓存并预先解码各列，左侧每次取一批，与右侧逐块连接。
  */
 class NestedLoopJoinExecutor : public AbstractExecutor {
  public:
@@ -51,19 +59,53 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of joined tuples.
+   * @param[out] batch The next batch produced by the join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the insert */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
-  auto Matched(Tuple *left_tuple, Tuple *right_tuple) const -> bool;
-
  private:
+  /** @return the number of chunks a left block is joined with, one for an empty right side so LEFT joins still emit */
+  auto NumChunks() const -> size_t { return right_chunks_.empty() ? 1 : right_chunks_.size(); }
+
+  /** Read the next non-empty batch of the left child into left_block_, @return `false` once the child is exhausted */
+  auto LoadLeftBlock() -> bool;
+
+  /** Move on to the next pair of chunk and left row and find the matches of the row, @return `false` at the end */
+  auto NextPair() -> bool;
+
+  /**
+   * Append a reference to the join of the current left row with a row of the current chunk, or with NULLs if `chunk`
+   * is `nullptr`; the row is only built into a tuple if the executors above ask for it.
+   */
+  void EmitRow(TupleBatch *batch, const TupleBatch *chunk, size_t right_idx);
+
   /** The NestedLoopJoin plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_executor_;
   std::unique_ptr<AbstractExecutor> right_executor_;
-  std::vector<Tuple> right_tuples_;
-  Tuple left_tuple_;
-  int32_t right_tuple_idx_ = -1;
+
+  /** The right side, BUSTUB_BATCH_SIZE rows per chunk */
+  std::vector<TupleBatch> right_chunks_;
+
+  /** The current left block, its current row, whether each of its rows matched, and the current chunk */
+  TupleBatch left_block_;
+  size_t left_idx_{0};
+  std::vector<bool> left_matched_;
+  size_t chunk_idx_{0};
+  bool left_done_{false};
+
+  /** The predicate over the current chunk, the rows of the chunk matching the current left row, and the next one */
+  std::vector<Value> predicate_;
+  std::vector<uint32_t> matches_;
+  size_t match_idx_{0};
+  /** Whether the current left row is still to be emitted with NULLs (LEFT join without any match) */
+  bool emit_null_row_{false};
 };
 
 }  // namespace bustub
@@ -15,6 +15,7 @@
 #include <memory>
 #include <vector>
 
+#include "execution/compiled_expression.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/projection_plan.h"
@@ -47,6 +48,14 @@ class ProjectionExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch from the projection, every expression is evaluated over a whole child batch. A projection
+   * that only picks columns yields references to the child rows instead of copying the columns.
+   * @param[out] batch The next batch produced by the projection
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the projection plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -56,5 +65,16 @@ class ProjectionExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** The expressions, compiled once for the whole query */
+  std::vector<CompiledExpression> exprs_;
+
+  /** The batch pulled from the child */
+  TupleBatch child_batch_;
+  /** Scratch space for the column vector of each expression that computes its values */
+  std::vector<std::vector<Value>> columns_;
+  /** Whether every expression is a column of the child, and the column of each */
+  bool columns_only_{true};
+  std::vector<uint32_t> col_idxs_;
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "execution/compiled_expression.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -44,6 +45,14 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan. The predicate is evaluated over the tuples in place in
+   * the table pages, and only the tuples that satisfy it are copied out.
+   * @param[out] batch The next batch produced by the scan
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -53,5 +62,21 @@ class SeqScanExecutor : public AbstractExecutor {
   const SeqScanPlanNode *plan_;
   TableIterator table_iter_ = {nullptr, RID(), nullptr};
   const TableInfo *table_info_;
+  /** The filter predicate compiled once for the whole scan, empty if there is none */
+  CompiledExpression filter_;
+  /** The page the batch scan reads next and the first slot on it not read yet, INVALID_PAGE_ID once exhausted */
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint32_t next_slot_{0};
+  /** The tuples of one page viewed in place, before the predicate is applied */
+  TupleBatch page_batch_;
+  /** Whether Init() took the table lock, a table already S locked by a parallel pipeline is not locked again */
+  bool table_locked_{false};
+
+  /** Filter the tuples of the current page that fit into the batch, and append copies of those that pass */
+  void ScanPage(TupleBatch *batch);
+  /** Take an S lock on an emitted row unless in READ_UNCOMMITTED */
+  void LockRow(const RID &rid);
+  /** Release the locks early in READ_COMMITTED once the table is exhausted */
+  void UnlockOnExhausted();
 };
 }  // namespace bustub
@@ -17,14 +17,28 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/loser_tree.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
+#include "execution/sort_key.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_arena.h"
 
 namespace bustub {
 
 /**
  * The SortExecutor executor executes a sort.
+ *
+ * The sort is external: the child is cut into runs of at most `execution_memory_limit` bytes, every run is sorted in
+ * memory and spilled to a TmpTupleFile, and the runs are merged with a loser tree while Next() is called. A run being
+ * merged keeps one page in memory, so at most `execution_memory_limit / BUSTUB_PAGE_SIZE` runs (at least two) are
+ * merged at a time, and more runs are first merged into fewer, longer ones in as many passes as it takes. Input that
+ * fits into the budget is sorted in memory and never touches the buffer pool.
+ *
+ * Rows are sorted by their normalized SortKey, compared with memcmp, on the workers of the task scheduler. The rows
+ * themselves stay where they were read and are only looked up when their prefixes tie on a key that did not fit.
+ * 外部排序：输入按内存预算切分为有序的 run 并溢出到临时文件，Next() 时用败者树做 k 路归并。
  */
 class SortExecutor : public AbstractExecutor {
  public:
@@ -50,11 +64,49 @@ class SortExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** @return whether the head of run a sorts before the head of run b, an exhausted run sorts last */
+  auto HeadLess(size_t run_a, size_t run_b) const -> bool;
+
+  /** Sort the keys of the rows read so far. */
+  void SortRows();
+
+  /** Sort the rows in memory and write them out as a new run. */
+  void SpillRun();
+
+  /** Merge the runs into new runs until no more of them are left than can be merged at once. */
+  void MergePasses();
+
+  /** Read the first row of every run and play the initial matches of the merge. */
+  void StartMerge();
+
+  /**
+   * Take the smallest head of the runs and advance its run.
+   * @return `false` once all runs are exhausted
+   */
+  auto NextMerged(Tuple *tuple) -> bool;
+
+  /** Read the next row of a run into its head, or mark the run as exhausted. */
+  void AdvanceRun(size_t run_idx);
+
   /** The sort plan node to be executed */
   const SortPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_;
-  std::vector<Tuple> child_tuples_;
 
-  std::vector<Tuple>::const_iterator child_iter_;
+  SortKeyNormalizer normalizer_;
+
+  /** The run being built while reading the child, the whole sorted input if nothing was spilled; the tuples are kept
+   * in the arena, which is rewound once the run is spilled */
+  std::vector<Tuple> tuples_;
+  TupleArena arena_;
+  std::vector<SortKey> keys_;
+  size_t run_bytes_{0};
+  size_t next_idx_{0};
+
+  /** The spilled runs, the current head of every run with its key, and whether the run is exhausted */
+  std::vector<std::unique_ptr<TmpTupleFile>> runs_;
+  std::vector<Tuple> head_tuples_;
+  std::vector<SortKey> head_keys_;
+  std::vector<bool> run_done_;
+  LoserTree merge_tree_;
 };
 }  // namespace bustub
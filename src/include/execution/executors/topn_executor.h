@@ -20,6 +20,7 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/topn_plan.h"
+#include "execution/sort_key.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -56,6 +57,9 @@ class TopNExecutor : public AbstractExecutor {
   const TopNPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_;
 
+  /** Orders the rows like the SortExecutor does, NULL first for ASC and last for DESC */
+  SortKeyNormalizer normalizer_;
+
   std::stack<Tuple> child_tuples_;
 };
 }  // namespace bustub
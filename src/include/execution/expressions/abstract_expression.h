@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 
@@ -68,6 +69,63 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Evaluate the expression over every row of a batch. The default evaluates row by row, expressions override it
+   * to work on whole column vectors.
+   * 对整个批次求值，结果中每行对应一个值
+   * @param batch the rows, with the schema of the batch
+   * @param[out] result one value per row of the batch
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const {
+    result->clear();
+    result->reserve(batch.Size());
+    for (size_t i = 0; i < batch.Size(); i++) {
+      result->push_back(Evaluate(&batch.GetTuple(i), *batch.GetSchema()));
+    }
+  }
+
+  /**
+   * Evaluate the expression over every row of a batch like EvaluateBatch(), but hand out the values by reference, so
+   * that a column reference reads the decoded column of the batch instead of copying it.
+   * @param batch the rows, with the schema of the batch
+   * @param scratch space for the values of an expression that has to compute them
+   * @return one value per row of the batch, valid until the batch or scratch changes
+   */
+  virtual auto EvaluateBatchRef(const TupleBatch &batch, std::vector<Value> *scratch) const
+      -> const std::vector<Value> & {
+    EvaluateBatch(batch, scratch);
+    return *scratch;
+  }
+
+  /**
+   * Evaluate a JOIN of one left row with every row of a batch of right rows. The default evaluates pair by pair,
+   * expressions override it to take their left values once and their right values as whole column vectors.
+   * 对一个左侧行与整批右侧行求值连接谓词
+   * @param left the left rows
+   * @param left_idx the left row to join
+   * @param right the right rows
+   * @param[out] result one value per row of the right batch
+   */
+  virtual void EvaluateJoinBatch(const TupleBatch &left, size_t left_idx, const TupleBatch &right,
+                                 std::vector<Value> *result) const {
+    result->clear();
+    result->reserve(right.Size());
+    for (size_t i = 0; i < right.Size(); i++) {
+      result->push_back(
+          EvaluateJoin(&left.GetTuple(left_idx), *left.GetSchema(), &right.GetTuple(i), *right.GetSchema()));
+    }
+  }
+
+  /**
+   * Evaluate a JOIN like EvaluateJoinBatch(), but hand out the values by reference, see EvaluateBatchRef().
+   * @return one value per row of the right batch, valid until the right batch or scratch changes
+   */
+  virtual auto EvaluateJoinBatchRef(const TupleBatch &left, size_t left_idx, const TupleBatch &right,
+                                    std::vector<Value> *scratch) const -> const std::vector<Value> & {
+    EvaluateJoinBatch(left, left_idx, right, scratch);
+    return *scratch;
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
@@ -69,6 +69,35 @@ class ArithmeticExpression : public AbstractExpression {
     return ValueFactory::GetIntegerValue(*res);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    std::vector<Value> lhs_scratch;
+    std::vector<Value> rhs_scratch;
+    const auto &lhs = GetChildAt(0)->EvaluateBatchRef(batch, &lhs_scratch);
+    const auto &rhs = GetChildAt(1)->EvaluateBatchRef(batch, &rhs_scratch);
+    result->clear();
+    result->reserve(batch.Size());
+    for (size_t i = 0; i < batch.Size(); i++) {
+      auto res = PerformComputation(lhs[i], rhs[i]);
+      result->push_back(res == std::nullopt ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                            : ValueFactory::GetIntegerValue(*res));
+    }
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, size_t left_idx, const TupleBatch &right,
+                         std::vector<Value> *result) const override {
+    std::vector<Value> lhs_scratch;
+    std::vector<Value> rhs_scratch;
+    const auto &lhs = GetChildAt(0)->EvaluateJoinBatchRef(left, left_idx, right, &lhs_scratch);
+    const auto &rhs = GetChildAt(1)->EvaluateJoinBatchRef(left, left_idx, right, &rhs_scratch);
+    result->clear();
+    result->reserve(right.Size());
+    for (size_t i = 0; i < right.Size(); i++) {
+      auto res = PerformComputation(lhs[i], rhs[i]);
+      result->push_back(res == std::nullopt ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                            : ValueFactory::GetIntegerValue(*res));
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), compute_type_, *GetChildAt(1));
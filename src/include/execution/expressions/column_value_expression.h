@@ -47,6 +47,33 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(&right_schema, col_idx_);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    *result = batch.GetColumn(col_idx_);
+  }
+
+  auto EvaluateBatchRef(const TupleBatch &batch, std::vector<Value> *scratch) const
+      -> const std::vector<Value> & override {
+    return batch.GetColumn(col_idx_);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, size_t left_idx, const TupleBatch &right,
+                         std::vector<Value> *result) const override {
+    if (tuple_idx_ == 0) {
+      result->assign(right.Size(), left.GetColumn(col_idx_)[left_idx]);
+    } else {
+      *result = right.GetColumn(col_idx_);
+    }
+  }
+
+  auto EvaluateJoinBatchRef(const TupleBatch &left, size_t left_idx, const TupleBatch &right,
+                            std::vector<Value> *scratch) const -> const std::vector<Value> & override {
+    if (tuple_idx_ == 0) {
+      scratch->assign(right.Size(), left.GetColumn(col_idx_)[left_idx]);
+      return *scratch;
+    }
+    return right.GetColumn(col_idx_);
+  }
+
   auto GetTupleIdx() const -> uint32_t { return tuple_idx_; }
   auto GetColIdx() const -> uint32_t { return col_idx_; }
 
@@ -34,6 +34,15 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    result->assign(batch.Size(), val_);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, size_t left_idx, const TupleBatch &right,
+                         std::vector<Value> *result) const override {
+    result->assign(right.Size(), val_);
+  }
+
   /** @return the string representation of the plan node and its children */
   auto ToString() const -> std::string override { return val_.ToString(); }
 
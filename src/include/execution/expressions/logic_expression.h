@@ -61,6 +61,31 @@ class LogicExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComputation(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    std::vector<Value> lhs_scratch;
+    std::vector<Value> rhs_scratch;
+    const auto &lhs = GetChildAt(0)->EvaluateBatchRef(batch, &lhs_scratch);
+    const auto &rhs = GetChildAt(1)->EvaluateBatchRef(batch, &rhs_scratch);
+    result->clear();
+    result->reserve(batch.Size());
+    for (size_t i = 0; i < batch.Size(); i++) {
+      result->push_back(ValueFactory::GetBooleanValue(PerformComputation(lhs[i], rhs[i])));
+    }
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, size_t left_idx, const TupleBatch &right,
+                         std::vector<Value> *result) const override {
+    std::vector<Value> lhs_scratch;
+    std::vector<Value> rhs_scratch;
+    const auto &lhs = GetChildAt(0)->EvaluateJoinBatchRef(left, left_idx, right, &lhs_scratch);
+    const auto &rhs = GetChildAt(1)->EvaluateJoinBatchRef(left, left_idx, right, &rhs_scratch);
+    result->clear();
+    result->reserve(right.Size());
+    for (size_t i = 0; i < right.Size(); i++) {
+      result->push_back(ValueFactory::GetBooleanValue(PerformComputation(lhs[i], rhs[i])));
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), logic_type_, *GetChildAt(1));
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// locked_row_reader.h
+//
+// Identification: src/include/execution/locked_row_reader.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * LockedRowReader locks and reads rows by RID for the scans that find their RIDs in an index: the index scan, the
+ * index-only scan and the bitmap heap scan.
+ *
+ * The table is IS-locked like a sequential scan locks it. Every row is S-locked before it is read, unless in
+ * READ_UNCOMMITTED, so that a residual predicate and the parent only ever see the version of the row that the lock
+ * protects. A row deleted while waiting for its lock is skipped.
+ * 先对 RID 加 S 锁再读取元组，等锁期间被删除的行直接跳过。
+ */
+class LockedRowReader {
+ public:
+  /**
+   * @param exec_ctx the executor context
+   * @param table_info the table the RIDs point into
+   * @param executor_name the name of the scan in the messages of failed locks
+   */
+  LockedRowReader(ExecutorContext *exec_ctx, const TableInfo *table_info, std::string executor_name)
+      : exec_ctx_(exec_ctx), table_info_(table_info), executor_name_(std::move(executor_name)) {}
+
+  /** @return whether rows are locked, i.e. the transaction is not in READ_UNCOMMITTED */
+  auto LocksRows() const -> bool;
+
+  /** Take an IS lock on the table unless in READ_UNCOMMITTED or the transaction already holds a stronger one. */
+  void LockTable() const;
+
+  /** Take an S lock on a row unless in READ_UNCOMMITTED. */
+  void LockRow(const RID &rid) const;
+
+  /**
+   * Lock the rows of rids[begin, end) in order, then append the rows that still exist to a batch.
+   * @param rids the RIDs, rows on the same page next to each other so that each page is fetched once
+   * @param begin the first RID to read
+   * @param end one past the last RID to read
+   * @param[out] batch the batch the rows are appended to, it must have room for all of them
+   */
+  void ReadRows(const std::vector<RID> &rids, size_t begin, size_t end, TupleBatch *batch);
+
+ private:
+  ExecutorContext *exec_ctx_;
+  const TableInfo *table_info_;
+  std::string executor_name_;
+
+  /** Scratch space of a batch: its RIDs and their tuples */
+  std::vector<RID> batch_rids_;
+  std::vector<Tuple> batch_tuples_;
+  std::vector<bool> batch_found_;
+};
+
+}  // namespace bustub
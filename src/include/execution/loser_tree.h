@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// loser_tree.h
+//
+// Identification: src/include/execution/loser_tree.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * LoserTree picks the smallest of k sorted sources for a k-way merge with about log2(k) comparisons per output row.
+ *
+ * The tree only stores source indexes: every inner node keeps the loser of the match played there, node 0 keeps the
+ * overall winner. The caller owns the sources and passes the comparison `less(a, b)` of the current heads of sources
+ * a and b, where an exhausted source must compare greater than any other.
+ * 败者树：内部节点记录比赛的败者，根节点之上记录胜者；胜者前进后只需沿着它到根的路径重赛一次。
+ */
+class LoserTree {
+ public:
+  /**
+   * Play the initial matches between the heads of all sources.
+   * @param num_sources the number of sources, at least one
+   * @param less the comparison of the heads of two sources
+   */
+  template <class Less>
+  void Build(size_t num_sources, Less less) {
+    num_sources_ = num_sources;
+    tree_.assign(num_sources, 0);
+    tree_[0] = Play(1, less);
+  }
+
+  /** @return the source whose head is the smallest */
+  auto Winner() const -> size_t { return tree_[0]; }
+
+  /**
+   * Replay the matches of the winner after its head moved on, from its leaf up to the root.
+   * @param less the comparison of the heads of two sources
+   */
+  template <class Less>
+  void Replay(Less less) {
+    size_t winner = tree_[0];
+    for (size_t node = (winner + num_sources_) / 2; node > 0; node /= 2) {
+      if (less(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+ private:
+  /** Play the matches of the subtree below a node, the leaves num_sources_..2*num_sources_-1 are the sources */
+  template <class Less>
+  auto Play(size_t node, Less &less) -> size_t {
+    if (node >= num_sources_) {
+      return node - num_sources_;
+    }
+    size_t left = Play(2 * node, less);
+    size_t right = Play(2 * node + 1, less);
+    if (less(right, left)) {
+      tree_[node] = left;
+      return right;
+    }
+    tree_[node] = right;
+    return left;
+  }
+
+  size_t num_sources_{0};
+  std::vector<size_t> tree_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_pipeline.h
+//
+// Identification: src/include/execution/parallel_pipeline.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/compiled_expression.h"
+#include "execution/executor_context.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/mock_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * ParallelPipeline runs a pipeline of a sequential scan followed by any number of filters and projections on the
+ * TaskScheduler of the executor context, morsel-driven: the pages of the table are split into morsels of
+ * PARALLEL_MORSEL_PAGES pages, and every morsel is scanned, filtered and projected batch by batch on one worker.
+ * A mock scan works the same way, its rows are split into morsels of MOCK_MORSEL_ROWS rows.
+ *
+ * The pipeline ends in a sink, i.e. the executor that consumes it (hash join build, aggregation). Every output batch
+ * is handed to the sink together with the worker and the morsel it comes from, so the sink keeps per-worker or
+ * per-morsel state and merges it after Run() returns.
+ * 并行流水线：表被切分为若干 morsel，每个 morsel 在一个工作线程上完成扫描、过滤和投影，结果交给 sink。
+ *
+ * Instead of an IS lock on the table and an S lock per row, the pipeline takes an S lock on the whole table up front,
+ * since the rows are read from many threads on behalf of one transaction.
+ */
+class ParallelPipeline {
+ public:
+  /** Consumes one output batch, the sink may take the tuples out of the batch */
+  using Sink = std::function<void(size_t worker_id, size_t morsel_idx, TupleBatch *batch)>;
+
+  /**
+   * Check whether the plan can run as a parallel pipeline. That is the case if the executor context has a task
+   * scheduler, the plan is a chain of filters and projections over a sequential scan or an unshuffled mock scan, the
+   * table spans more than one morsel, and the transaction does not hold an intention lock on the table already.
+   * @param exec_ctx the executor context
+   * @param plan the plan that feeds the sink
+   * @return the pipeline, or `nullptr` if the plan has to run on the executor tree
+   */
+  static auto Make(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan) -> std::unique_ptr<ParallelPipeline>;
+
+  /**
+   * Lock the table and split it into morsels. Must be called once, before NumMorsels() and Run().
+   */
+  void Open();
+
+  /** @return the number of workers, worker ids passed to the sink are smaller */
+  auto NumWorkers() const -> size_t { return exec_ctx_->GetTaskScheduler()->NumWorkers(); }
+
+  /** @return the number of morsels, morsel indexes passed to the sink are smaller */
+  auto NumMorsels() const -> size_t;
+
+  /**
+   * Run the pipeline over every morsel, wait for it to finish and Close() the pipeline.
+   * @param sink the consumer of the output batches, called concurrently from the workers
+   */
+  void Run(const Sink &sink);
+
+  /**
+   * Run the pipeline over a range of morsels and wait for it to finish. A consumer that must not hold the output of
+   * the whole table at once runs the morsels range by range.
+   * @param begin the first morsel to run
+   * @param end one past the last morsel to run
+   * @param sink the consumer of the output batches, called concurrently from the workers
+   */
+  void RunMorsels(size_t begin, size_t end, const Sink &sink);
+
+  /** Give back the table lock early in READ_COMMITTED, once all morsels have run. */
+  void Close();
+
+ private:
+  ParallelPipeline(ExecutorContext *exec_ctx, const AbstractPlanNode *scan, std::vector<const AbstractPlanNode *> ops,
+                   const TableInfo *table_info);
+
+  /** Rows in a morsel of a mock scan */
+  static constexpr size_t MOCK_MORSEL_ROWS = 4 * BUSTUB_BATCH_SIZE;
+
+  /** @return the page ids of the table, in table order */
+  auto CollectPageIds() const -> std::vector<page_id_t>;
+
+  /** Scan the pages of one morsel and push them through the pipeline. */
+  void RunMorsel(size_t worker_id, size_t morsel_idx, const Sink &sink);
+
+  /** Produce the rows of one morsel of a mock scan and push them through the pipeline. */
+  void RunMockMorsel(size_t worker_id, size_t morsel_idx, const Sink &sink);
+
+  /**
+   * Apply the operators of the pipeline to a batch of the scan, whose predicate was applied in the table pages.
+   * @param[in,out] batch the scanned batch on input, the output of the pipeline on output
+   * @param scratch a batch the projections may use
+   */
+  void ApplyOperators(TupleBatch **batch, TupleBatch **scratch) const;
+
+  ExecutorContext *exec_ctx_;
+  /** The sequential scan or mock scan at the bottom of the pipeline */
+  const AbstractPlanNode *scan_;
+  /** The filters and projections on top of the scan, bottom-up */
+  std::vector<const AbstractPlanNode *> ops_;
+  /** The predicate of the scan, and the predicate or the expressions of each operator, compiled once */
+  CompiledExpression scan_predicate_;
+  std::vector<std::vector<CompiledExpression>> op_exprs_;
+  /** The table of a sequential scan, `nullptr` for a mock scan */
+  const TableInfo *table_info_;
+  /** The row function and size of a mock scan */
+  std::function<Tuple(size_t)> mock_func_;
+  size_t mock_size_{0};
+  std::vector<page_id_t> page_ids_;
+  bool table_locked_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_sort.h
+//
+// Identification: src/include/execution/parallel_sort.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "execution/task_scheduler.h"
+
+namespace bustub {
+
+/** Inputs smaller than this are sorted by the calling thread */
+static constexpr size_t PARALLEL_SORT_MIN_ITEMS = 4 * BUSTUB_BATCH_SIZE;
+
+/**
+ * Sort a vector on the workers of a task scheduler with a sample sort.
+ *
+ * A sample of the items picks one splitter per bucket, with a few buckets per worker. The items are then counted and
+ * scattered into their buckets chunk by chunk, and every bucket is sorted on its own, all on the workers. The buckets
+ * come out in order, so no merge pass is needed. Many duplicates of a splitter make its bucket larger, the result is
+ * sorted either way.
+ * 样本排序：按样本选出的分隔值把元素分到各个桶，各桶在工作线程上并行排序后依次相连即为有序结果。
+ *
+ * @param scheduler the task scheduler, or `nullptr` to sort on the calling thread
+ * @param items the items to sort
+ * @param less the strict weak order of the items, called concurrently
+ */
+template <class T, class Less>
+void ParallelSort(TaskScheduler *scheduler, std::vector<T> *items, Less less) {
+  size_t num_items = items->size();
+  if (scheduler == nullptr || scheduler->NumWorkers() == 1 || num_items < PARALLEL_SORT_MIN_ITEMS) {
+    std::sort(items->begin(), items->end(), less);
+    return;
+  }
+
+  constexpr size_t BUCKETS_PER_WORKER = 4;
+  constexpr size_t SAMPLES_PER_BUCKET = 16;
+  size_t num_buckets = scheduler->NumWorkers() * BUCKETS_PER_WORKER;
+  size_t num_chunks = num_buckets;
+  size_t chunk_size = (num_items + num_chunks - 1) / num_chunks;
+
+  // Splitters from an evenly spaced sample, bucket b takes the items in [splitters[b-1], splitters[b])
+  std::vector<T> sample;
+  size_t sample_size = num_buckets * SAMPLES_PER_BUCKET;
+  sample.reserve(sample_size);
+  for (size_t i = 0; i < sample_size; i++) {
+    sample.push_back((*items)[i * num_items / sample_size]);
+  }
+  std::sort(sample.begin(), sample.end(), less);
+  std::vector<T> splitters;
+  splitters.reserve(num_buckets - 1);
+  for (size_t b = 1; b < num_buckets; b++) {
+    splitters.push_back(sample[b * SAMPLES_PER_BUCKET]);
+  }
+
+  // Count the items of every chunk per bucket
+  std::vector<uint32_t> bucket_of(num_items);
+  std::vector<std::vector<size_t>> counts(num_chunks, std::vector<size_t>(num_buckets, 0));
+  scheduler->ParallelFor(num_chunks, [&](size_t worker_id, size_t chunk) {
+    size_t end = std::min(num_items, (chunk + 1) * chunk_size);
+    for (size_t i = chunk * chunk_size; i < end; i++) {
+      auto bucket = std::upper_bound(splitters.begin(), splitters.end(), (*items)[i], less) - splitters.begin();
+      bucket_of[i] = static_cast<uint32_t>(bucket);
+      counts[chunk][bucket]++;
+    }
+  });
+
+  // Every chunk writes its items of a bucket to its own slice of the bucket
+  std::vector<size_t> bucket_begin(num_buckets + 1, 0);
+  std::vector<std::vector<size_t>> offsets(num_chunks, std::vector<size_t>(num_buckets));
+  size_t offset = 0;
+  for (size_t b = 0; b < num_buckets; b++) {
+    bucket_begin[b] = offset;
+    for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+      offsets[chunk][b] = offset;
+      offset += counts[chunk][b];
+    }
+  }
+  bucket_begin[num_buckets] = offset;
+
+  std::vector<T> output(num_items);
+  scheduler->ParallelFor(num_chunks, [&](size_t worker_id, size_t chunk) {
+    size_t end = std::min(num_items, (chunk + 1) * chunk_size);
+    for (size_t i = chunk * chunk_size; i < end; i++) {
+      output[offsets[chunk][bucket_of[i]]++] = std::move((*items)[i]);
+    }
+  });
+  scheduler->ParallelFor(num_buckets, [&](size_t worker_id, size_t b) {
+    std::sort(output.begin() + bucket_begin[b], output.begin() + bucket_begin[b + 1], less);
+  });
+  *items = std::move(output);
+}
+
+}  // namespace bustub
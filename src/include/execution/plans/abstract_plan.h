@@ -34,6 +34,8 @@ namespace bustub {
 enum class PlanType {
   SeqScan,
   IndexScan,
+  IndexOnlyScan,
+  BitmapHeapScan,
   Insert,
   Update,
   Delete,
@@ -42,6 +44,7 @@ enum class PlanType {
   NestedLoopJoin,
   NestedIndexJoin,
   HashJoin,
+  MergeJoin,
   Filter,
   Values,
   Projection,
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_heap_scan_plan.h
+//
+// Identification: src/include/execution/plans/bitmap_heap_scan_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "fmt/ranges.h"
+
+namespace bustub {
+
+/** BitmapIndexLookup is a lookup of key ranges in one index, whose RIDs feed a bitmap heap scan. */
+struct BitmapIndexLookup {
+  index_oid_t index_oid_;
+  std::vector<IndexKeyRange> key_ranges_;
+
+  /** @return the lookup as e.g. 1:[[1, 5), [7, 7]] */
+  auto ToString() const -> std::string {
+    std::vector<std::string> ranges;
+    for (const auto &range : key_ranges_) {
+      ranges.push_back(range.ToString());
+    }
+    return fmt::format("{}:[{}]", index_oid_, fmt::join(ranges, ", "));
+  }
+};
+
+/**
+ * BitmapHeapScanPlanNode reads the rows of a table whose RIDs come from index lookups, in page order.
+ *
+ * The lookups form a conjunction of disjunctions: the RIDs of the lookups of a clause are OR-ed into one bitmap,
+ * and the bitmaps of the clauses are AND-ed. Every heap page with a RID left is then read once, in page order, and
+ * its rows are filtered by the residual predicate. Unlike an index scan, the rows do not come in key order.
+ * 位图堆扫描：多个索引查找得到的 RID 按页组成位图，按子句做与/或运算后按页顺序读取表堆。
+ */
+class BitmapHeapScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new bitmap heap scan plan node.
+   * @param output the output format of this scan plan node
+   * @param table_oid the identifier of the table to be scanned
+   * @param table_name the name of the table to be scanned
+   * @param clauses the index lookups, OR-ed within a clause and AND-ed across clauses
+   * @param residual_predicate the predicate the rows must satisfy as well, or `nullptr`
+   */
+  BitmapHeapScanPlanNode(SchemaRef output, table_oid_t table_oid, std::string table_name,
+                         std::vector<std::vector<BitmapIndexLookup>> clauses, AbstractExpressionRef residual_predicate)
+      : AbstractPlanNode(std::move(output), {}),
+        table_oid_(table_oid),
+        table_name_(std::move(table_name)),
+        clauses_(std::move(clauses)),
+        residual_predicate_(std::move(residual_predicate)) {}
+
+  auto GetType() const -> PlanType override { return PlanType::BitmapHeapScan; }
+
+  /** @return the identifier of the table that should be scanned */
+  auto GetTableOid() const -> table_oid_t { return table_oid_; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(BitmapHeapScanPlanNode);
+
+  /** The table whose tuples should be scanned. */
+  table_oid_t table_oid_;
+
+  /** The name of the table */
+  std::string table_name_;
+
+  /** The index lookups, OR-ed within a clause and AND-ed across clauses */
+  std::vector<std::vector<BitmapIndexLookup>> clauses_;
+
+  /** The part of the predicate not covered by the lookups, may be `nullptr` */
+  AbstractExpressionRef residual_predicate_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    std::vector<std::string> clauses;
+    for (const auto &clause : clauses_) {
+      std::vector<std::string> lookups;
+      for (const auto &lookup : clause) {
+        lookups.push_back(lookup.ToString());
+      }
+      clauses.push_back(fmt::format("({})", fmt::join(lookups, " or ")));
+    }
+    if (residual_predicate_) {
+      return fmt::format("BitmapHeapScan {{ table={}, bitmap={}, filter={} }}", table_name_,
+                         fmt::join(clauses, " and "), residual_predicate_);
+    }
+    return fmt::format("BitmapHeapScan {{ table={}, bitmap={} }}", table_name_, fmt::join(clauses, " and "));
+  }
+};
+
+}  // namespace bustub
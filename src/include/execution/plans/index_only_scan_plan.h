@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_plan.h
+//
+// Identification: src/include/execution/plans/index_only_scan_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "fmt/ranges.h"
+
+namespace bustub {
+
+/**
+ * IndexOnlyScanPlanNode scans an index that covers every column the query needs, so the rows are built from the
+ * index keys and the table heap is never read.
+ *
+ * The output schema is the key schema of the index, and the residual predicate refers to the key columns only.
+ * Like IndexScanPlanNode, the rows come in key order unless the index is a hash index.
+ * 覆盖索引扫描：查询只用到索引键列时，直接用键值构造元组，不读表堆。
+ */
+class IndexOnlyScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new index-only scan plan node.
+   * @param output the output format of this scan plan node, i.e. the key columns
+   * @param index_oid the identifier of the index to be scanned
+   * @param key_ranges the ranges of keys to scan
+   * @param residual_predicate the predicate on the keys the rows must satisfy as well, or `nullptr`
+   */
+  IndexOnlyScanPlanNode(SchemaRef output, index_oid_t index_oid, std::vector<IndexKeyRange> key_ranges,
+                        AbstractExpressionRef residual_predicate)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        key_ranges_(std::move(key_ranges)),
+        residual_predicate_(std::move(residual_predicate)) {}
+
+  auto GetType() const -> PlanType override { return PlanType::IndexOnlyScan; }
+
+  /** @return the identifier of the index that should be scanned */
+  auto GetIndexOid() const -> index_oid_t { return index_oid_; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexOnlyScanPlanNode);
+
+  /** The index whose keys should be scanned. */
+  index_oid_t index_oid_;
+
+  /** The ranges of keys to scan */
+  std::vector<IndexKeyRange> key_ranges_;
+
+  /** The part of the predicate not covered by the key ranges, may be `nullptr` */
+  AbstractExpressionRef residual_predicate_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    std::vector<std::string> ranges;
+    for (const auto &range : key_ranges_) {
+      ranges.push_back(range.ToString());
+    }
+    if (residual_predicate_) {
+      return fmt::format("IndexOnlyScan {{ index_oid={}, ranges=[{}], filter={} }}", index_oid_,
+                         fmt::join(ranges, ", "), residual_predicate_);
+    }
+    return fmt::format("IndexOnlyScan {{ index_oid={}, ranges=[{}] }}", index_oid_, fmt::join(ranges, ", "));
+  }
+};
+
+}  // namespace bustub
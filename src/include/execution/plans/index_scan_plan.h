@@ -12,28 +12,66 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "fmt/ranges.h"
+#include "type/value.h"
 
 namespace bustub {
+
+/**
+ * IndexKeyRange is a range of keys of a single-column index. A bound that is not set leaves the range open on that
+ * side, so the default range holds every key.
+ */
+struct IndexKeyRange {
+  std::optional<Value> lower_;
+  bool lower_inclusive_{true};
+  std::optional<Value> upper_;
+  bool upper_inclusive_{true};
+
+  /** @return true if the range holds exactly one key */
+  auto IsPoint() const -> bool {
+    return lower_.has_value() && upper_.has_value() && lower_inclusive_ && upper_inclusive_ &&
+           lower_->CompareEquals(*upper_) == CmpBool::CmpTrue;
+  }
+
+  /** @return the range in interval notation, e.g. [1, 5) or (-inf, 3] */
+  auto ToString() const -> std::string {
+    return fmt::format("{}{}, {}{}", lower_inclusive_ && lower_.has_value() ? "[" : "(",
+                       lower_.has_value() ? lower_->ToString() : "-inf",
+                       upper_.has_value() ? upper_->ToString() : "+inf",
+                       upper_inclusive_ && upper_.has_value() ? "]" : ")");
+  }
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ *
+ * The scan returns the rows whose index key lies in one of the key ranges, in key order, that also satisfy the
+ * residual predicate. The ranges are sorted and do not overlap. An empty list of ranges returns no rows.
+ * 索引扫描：按键范围扫描索引，其余条件作为残余谓词在取回元组后过滤。
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
   /**
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to be scanned
+   * @param key_ranges the ranges of keys to scan, the whole index by default
+   * @param residual_predicate the predicate the rows must satisfy as well, or `nullptr`
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef filter_predicate = nullptr)
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::vector<IndexKeyRange> key_ranges = {IndexKeyRange{}},
+                    AbstractExpressionRef residual_predicate = nullptr)
       : AbstractPlanNode(std::move(output), {}),
         index_oid_(index_oid),
-        filter_predicate_(std::move(filter_predicate)) {}
+        key_ranges_(std::move(key_ranges)),
+        residual_predicate_(std::move(residual_predicate)) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -45,16 +83,23 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The ranges of keys to scan */
+  std::vector<IndexKeyRange> key_ranges_;
 
-  AbstractExpressionRef filter_predicate_;
+  /** The part of the predicate not covered by the key ranges, may be `nullptr` */
+  AbstractExpressionRef residual_predicate_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    if (filter_predicate_) {
-      return fmt::format("IndexScan {{ index_oid={}, filter={} }}", index_oid_, filter_predicate_);
+    std::vector<std::string> ranges;
+    for (const auto &range : key_ranges_) {
+      ranges.push_back(range.ToString());
+    }
+    if (residual_predicate_) {
+      return fmt::format("IndexScan {{ index_oid={}, ranges=[{}], filter={} }}", index_oid_, fmt::join(ranges, ", "),
+                         residual_predicate_);
     }
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    return fmt::format("IndexScan {{ index_oid={}, ranges=[{}] }}", index_oid_, fmt::join(ranges, ", "));
   }
 };
 
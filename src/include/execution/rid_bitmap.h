@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rid_bitmap.h
+//
+// Identification: src/include/execution/rid_bitmap.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <bitset>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+/**
+ * RidBitmap is a set of RIDs kept as one bitmap of slots per table page, ordered by page id.
+ *
+ * The RIDs come out sorted by page and slot whatever order they were added in, so reading them back visits every
+ * heap page once and in order. Bitmaps of different index lookups combine with a bitwise AND or OR per page.
+ * RID 位图：每个表页一个槽位位图，按页号有序，取出的 RID 按页顺序排列。
+ */
+class RidBitmap {
+ public:
+  /** A table page has a slot of 8 bytes per tuple, so it never holds more tuples than this */
+  static constexpr size_t SLOTS_PER_PAGE = BUSTUB_PAGE_SIZE / 8;
+
+  /** Add a RID to the set */
+  void Set(const RID &rid) {
+    BUSTUB_ASSERT(rid.GetSlotNum() < SLOTS_PER_PAGE, "slot out of range");
+    pages_[rid.GetPageId()].set(rid.GetSlotNum());
+  }
+
+  /** Keep only the RIDs that are in the other set as well */
+  void IntersectWith(const RidBitmap &other) {
+    for (auto iter = pages_.begin(); iter != pages_.end();) {
+      auto other_iter = other.pages_.find(iter->first);
+      if (other_iter == other.pages_.end()) {
+        iter = pages_.erase(iter);
+        continue;
+      }
+      iter->second &= other_iter->second;
+      iter = iter->second.none() ? pages_.erase(iter) : std::next(iter);
+    }
+  }
+
+  /** Add every RID of the other set */
+  void UnionWith(const RidBitmap &other) {
+    for (const auto &[page_id, slots] : other.pages_) {
+      pages_[page_id] |= slots;
+    }
+  }
+
+  /** @return the number of pages with at least one RID */
+  auto NumPages() const -> size_t { return pages_.size(); }
+
+  /** @return the RIDs of the set, sorted by page and slot */
+  auto ToRids() const -> std::vector<RID> {
+    std::vector<RID> rids;
+    for (const auto &[page_id, slots] : pages_) {
+      for (uint32_t slot = 0; slot < SLOTS_PER_PAGE; slot++) {
+        if (slots.test(slot)) {
+          rids.emplace_back(page_id, slot);
+        }
+      }
+    }
+    return rids;
+  }
+
+ private:
+  std::map<page_id_t, std::bitset<SLOTS_PER_PAGE>> pages_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.h
+//
+// Identification: src/include/execution/sort_key.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_order_by.h"
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/** Bytes of the normalized prefix of a sort key */
+static constexpr size_t SORT_KEY_PREFIX_SIZE = 28;
+
+/**
+ * SortKey is what a sort moves around: the normalized prefix of the ORDER BY keys of a row, and the index of the row.
+ */
+struct SortKey {
+  char prefix_[SORT_KEY_PREFIX_SIZE];
+  uint32_t row_idx_;
+};
+
+/**
+ * SortKeyNormalizer encodes the ORDER BY keys of a row into the prefix of a SortKey, such that memcmp on the prefixes
+ * orders the rows like the ORDER BY clause. Every key takes one byte for NULL followed by its value: integers
+ * big-endian with the sign bit flipped, decimals with the usual IEEE 754 flip, strings as their leading bytes. DESC
+ * keys have all their bytes inverted. NULL sorts before any value, i.e. first for ASC and last for DESC.
+ * 排序键规范化：把多个 ORDER BY 键编码成定长字节串，直接用 memcmp 比较。
+ *
+ * Keys that do not fit into the prefix, and strings, are cut off. The prefix is then not exact, and rows whose
+ * prefixes are equal are compared once more on their full keys.
+ */
+class SortKeyNormalizer {
+ public:
+  using OrderBy = std::pair<OrderByType, AbstractExpressionRef>;
+
+  /**
+   * @param order_bys the ORDER BY keys
+   * @param schema the schema of the sorted rows
+   */
+  SortKeyNormalizer(const std::vector<OrderBy> &order_bys, const Schema *schema);
+
+  /**
+   * Append the sort keys of all rows of a batch, numbered from keys->size() on.
+   * @param batch the rows
+   * @param[out] keys the sort keys
+   */
+  void EncodeBatch(const TupleBatch &batch, std::vector<SortKey> *keys) const;
+
+  /**
+   * Encode the sort key of a single row.
+   * @param tuple the row
+   * @param row_idx the index stored in the key
+   * @param[out] key the sort key
+   */
+  void Encode(const Tuple &tuple, uint32_t row_idx, SortKey *key) const;
+
+  /**
+   * @return whether row a sorts before row b, by their prefixes and, where those are equal, by their full keys
+   */
+  auto Less(const SortKey &key_a, const Tuple &tuple_a, const SortKey &key_b, const Tuple &tuple_b) const -> bool {
+    int cmp = memcmp(key_a.prefix_, key_b.prefix_, prefix_size_);
+    if (cmp != 0) {
+      return cmp < 0;
+    }
+    return !exact_ && FullLess(tuple_a, tuple_b);
+  }
+
+  /** @return whether equal prefixes mean equal keys */
+  auto IsExact() const -> bool { return exact_; }
+
+ private:
+  /** Where one ORDER BY key goes in the prefix */
+  struct KeyLayout {
+    TypeId type_;
+    bool desc_;
+    /** Offset of the NULL byte, the value follows */
+    size_t offset_;
+    /** Bytes of the value stored in the prefix */
+    size_t width_;
+  };
+
+  /** Encode one key value at its place in the prefix. */
+  void EncodeValue(const KeyLayout &layout, const Value &value, char *prefix) const;
+
+  /** @return whether row a sorts before row b, by their full keys */
+  auto FullLess(const Tuple &tuple_a, const Tuple &tuple_b) const -> bool;
+
+  const std::vector<OrderBy> &order_bys_;
+  const Schema *schema_;
+  /** The keys that got at least their NULL byte into the prefix */
+  std::vector<KeyLayout> layouts_;
+  size_t prefix_size_{0};
+  bool exact_{true};
+};
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler.h
+//
+// Identification: src/include/execution/task_scheduler.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TaskScheduler is the thread pool that runs the morsels of parallel pipelines.
+ *
+ * Every worker owns a task queue. Tasks are spread over the queues round-robin, a worker pops from the front of its
+ * own queue and, once it runs dry, steals from the back of the other queues, so a worker that got cheap morsels helps
+ * the others instead of idling. Workers are numbered 0..NumWorkers()-1 and a task is told which worker runs it, so
+ * callers can keep per-worker state without any latching.
+ * 每个工作线程有自己的任务队列，本地队列为空时从其他队列尾部窃取任务。
+ */
+class TaskScheduler {
+ public:
+  /**
+   * Start the workers.
+   * @param num_workers the number of worker threads, at least one
+   */
+  explicit TaskScheduler(size_t num_workers);
+
+  /** Stop and join the workers, pending tasks are still run. */
+  ~TaskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(TaskScheduler);
+
+  /** @return the number of worker threads */
+  auto NumWorkers() const -> size_t { return workers_.size(); }
+
+  /**
+   * Run task(worker_id, task_idx) for every task_idx in [0, num_tasks) on the workers and wait for all of them.
+   * If a task throws, the remaining tasks still run and the first exception is rethrown here.
+   * Must not be called from a worker thread.
+   * @param num_tasks the number of tasks
+   * @param task the work of one task
+   */
+  void ParallelFor(size_t num_tasks, const std::function<void(size_t worker_id, size_t task_idx)> &task);
+
+ private:
+  using Task = std::function<void(size_t worker_id)>;
+
+  /** The task queue of one worker */
+  struct WorkerQueue {
+    std::mutex latch_;
+    std::deque<Task> tasks_;
+  };
+
+  /** Queue a task on the queue of the given worker and wake a worker up. */
+  void Submit(size_t worker_id, Task &&task);
+
+  /** Pop a task from the front of the worker's own queue, or steal one from the back of another queue. */
+  auto TakeTask(size_t worker_id, Task *task) -> bool;
+
+  void WorkerLoop(size_t worker_id);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  /** Protects sleeping and waking up workers */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  /** Number of tasks queued and not taken by a worker yet */
+  std::atomic<size_t> pending_{0};
+  bool stop_{false};
+};
+
+}  // namespace bustub
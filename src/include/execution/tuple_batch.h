@@ -0,0 +1,190 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_arena.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleBatch is the unit of work of the batch-at-a-time executor interface, see AbstractExecutor::NextBatch().
+ *
+ * A batch holds up to Capacity() rows of a single schema. The rows are kept as tuples so that they can be passed on
+ * unchanged, and a column is decoded into a column vector of values the first time it is asked for. Expressions are
+ * evaluated over these column vectors (AbstractExpression::EvaluateBatch) with one virtual call per expression node
+ * per batch, instead of one per node per row.
+ *
+ * The rows of a join, or of a projection that only picks columns, may instead be kept as references (late
+ * materialization): a row points at the tuples it is made of, e.g. a left and a right tuple, and each column is read
+ * from one of them. Only the columns asked for are ever decoded, and a row is built into a tuple of its own only when
+ * GetTuple() is called for it. The referenced tuples belong to the batches and tables of the executors below, so a
+ * batch of references is only valid until the executor that produced it is asked for its next batch.
+ *
+ * The rows a batch builds or copies are kept in an arena of the batch, which is rewound by Reset() and keeps its
+ * blocks, so that filling a batch again does not allocate. Such rows are not owned by their tuples: a caller keeping a
+ * row beyond the next Reset() copies it or takes it out with TakeTuple().
+ * TupleBatch 是批量执行接口的处理单位，列在第一次被访问时才从元组中解码成列向量。
+ */
+class TupleBatch {
+ public:
+  /**
+   * Create an empty batch.
+   * @param capacity the max number of rows of the batch
+   */
+  explicit TupleBatch(size_t capacity = BUSTUB_BATCH_SIZE);
+
+  /**
+   * Drop all the rows of the batch, the memory of the batch is kept for reuse.
+   * @param schema the schema of the rows that will be appended
+   */
+  void Reset(const Schema *schema);
+
+  /** Append a row to the batch, the batch must not be full. */
+  void Append(Tuple &&tuple, RID rid);
+
+  /** Append a copy of a row to the batch, kept in the memory of the batch; the batch must not be full. */
+  void Append(const Tuple &tuple, RID rid);
+
+  /** Append a row built from values, kept in the memory of the batch; the batch must not be full. */
+  void Append(const std::vector<Value> &values, RID rid);
+
+  /**
+   * Drop all the rows of the batch and make it a batch of references to joined rows: the columns of a row of `left`
+   * followed by the columns of a right tuple.
+   * @param schema the schema of the joined rows
+   * @param left the batch the left side of the rows will be taken from
+   * @param right_schema the schema of the right tuples
+   */
+  void ResetJoin(const Schema *schema, const TupleBatch &left, const Schema *right_schema);
+
+  /**
+   * Drop all the rows of the batch and make it a batch of references to rows of `child` narrowed to some columns.
+   * @param schema the schema of the narrowed rows
+   * @param child the batch the rows will be taken from
+   * @param col_idxs the column of `child` for each column of the batch
+   */
+  void ResetProjection(const Schema *schema, const TupleBatch &child, const std::vector<uint32_t> &col_idxs);
+
+  /**
+   * Append a reference to a row, the batch must not be full.
+   * @param base the batch given to ResetJoin() or ResetProjection()
+   * @param row_idx the row of `base`
+   * @param right for a join, the right tuple, or `nullptr` for a right side of NULLs
+   */
+  void AppendReference(const TupleBatch &base, size_t row_idx, const Tuple *right = nullptr);
+
+  /** @return true if the rows of the batch are references, see ResetJoin() and ResetProjection() */
+  auto IsReference() const -> bool { return num_sources_ > 0; }
+
+  /**
+   * Keep only the rows whose predicate value is true, NULL counts as false.
+   * @param predicate one boolean value per row
+   */
+  void Select(const std::vector<Value> &predicate);
+
+  /**
+   * Keep only the rows whose flag is set.
+   * @param keep one flag per row
+   */
+  void Select(const std::vector<uint8_t> &keep);
+
+  /** Keep only the first `size` rows. */
+  void Truncate(size_t size);
+
+  /** @return the number of rows in the batch */
+  auto Size() const -> size_t { return tuples_.size(); }
+
+  /** @return the max number of rows of the batch */
+  auto Capacity() const -> size_t { return capacity_; }
+
+  auto IsEmpty() const -> bool { return tuples_.empty(); }
+
+  auto IsFull() const -> bool { return tuples_.size() >= capacity_; }
+
+  /** @return the schema of the rows */
+  auto GetSchema() const -> const Schema * { return schema_; }
+
+  /** @return the row, a row that is a reference is built into a tuple on first access */
+  auto GetTuple(size_t row_idx) const -> const Tuple & {
+    if (IsReference() && tuples_[row_idx].GetData() == nullptr) {
+      Materialize(row_idx);
+    }
+    return tuples_[row_idx];
+  }
+
+  /**
+   * Take a row out of the batch once the caller is done with the batch.
+   * @return the row as a tuple that owns its data, copied out of the memory of the batch if it lives there
+   */
+  auto TakeTuple(size_t row_idx) -> Tuple;
+
+  auto GetRID(size_t row_idx) const -> RID { return rids_[row_idx]; }
+
+  /**
+   * @param col_idx the index of the column in the schema of the batch
+   * @return the values of the column, one per row, decoded on first access
+   */
+  auto GetColumn(uint32_t col_idx) const -> const std::vector<Value> &;
+
+  /**
+   * @param row_idx the row
+   * @param col_idx the index of an inlined column in the schema of the batch
+   * @return the bytes of the column in the tuple holding them, `nullptr` if the row refers to a side of NULLs
+   */
+  auto GetColumnData(size_t row_idx, uint32_t col_idx) const -> const char * {
+    if (!IsReference()) {
+      return tuples_[row_idx].GetData() + schema_->GetColumn(col_idx).GetOffset();
+    }
+    const auto &source = layout_[col_idx];
+    const Tuple *tuple = refs_[row_idx * num_sources_ + source.source_];
+    return tuple == nullptr ? nullptr : tuple->GetData() + source.schema_->GetColumn(source.col_idx_).GetOffset();
+  }
+
+ private:
+  /** Where a column of a batch of references is read from: a column of one of the tuples a row refers to */
+  struct ColumnSource {
+    uint32_t source_;
+    uint32_t col_idx_;
+    const Schema *schema_;
+  };
+
+  /** @return the value of a column of a row that is a reference */
+  auto ReadReference(size_t row_idx, uint32_t col_idx) const -> Value;
+
+  /** Build a row that is a reference into a tuple of its own */
+  void Materialize(size_t row_idx) const;
+
+  size_t capacity_;
+  const Schema *schema_{nullptr};
+  /** The rows; for a batch of references an empty tuple until the row is materialized */
+  mutable std::vector<Tuple> tuples_;
+  /** The memory of the rows built or copied by the batch */
+  mutable TupleArena arena_;
+  std::vector<RID> rids_;
+  /** For a batch of references: the source of each column, and the tuples each row refers to, num_sources_ per row */
+  std::vector<ColumnSource> layout_;
+  size_t num_sources_{0};
+  std::vector<const Tuple *> refs_;
+  /** Column vectors decoded so far, a column is valid only if its flag in column_decoded_ is set */
+  mutable std::vector<std::vector<Value>> columns_;
+  mutable std::vector<bool> column_decoded_;
+};
+
+}  // namespace bustub
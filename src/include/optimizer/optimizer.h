@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -11,6 +12,7 @@
 #include "concurrency/transaction.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_scan_plan.h"
 
 #define BUSTUB_OPTIMIZER_HACK_REMOVE_AFTER_2022_FALL
 
@@ -50,6 +52,18 @@ class Optimizer {
    */
   auto OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize nested loop join into merge join.
+   * An equi-join whose children already produce their tuples in order of the join keys, i.e. a sort or a B+ tree
+   * index scan on the key column, is merged instead of building a hash table.
+   */
+  auto OptimizeNLJAsMergeJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief check if a plan produces its tuples in ascending order of a column of its output
+   */
+  auto IsSortedOn(const AbstractPlanNode &plan, uint32_t col_idx) -> bool;
+
   /**
    * @brief optimize nested loop join into index join.
    */
@@ -106,8 +120,35 @@ class Optimizer {
 
   auto OptimizeRemoveColumn(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief turn a filter over a seq scan into an index scan over the key ranges its predicate allows on an indexed
+   * column: comparisons with constants (including BETWEEN) and IN lists. The rest of the predicate stays as the
+   * residual predicate of the index scan. When the predicate restricts several indexed columns, or is a disjunction
+   * whose every branch one index can look up, the lookups are combined in a bitmap heap scan instead.
+   */
   auto OptimizeMergeFilterIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief extract the key ranges of a column from the terms of a conjunction
+   * @param terms the terms, the ones turned into key ranges are removed
+   * @param col_idx the column
+   * @return the sorted, non-overlapping key ranges, or std::nullopt if no term restricts the column
+   */
+  auto ExtractIndexKeyRanges(std::vector<AbstractExpressionRef> *terms, uint32_t col_idx)
+      -> std::optional<std::vector<IndexKeyRange>>;
+
+  /**
+   * @brief scan only the index when its key covers every column a projection or an aggregation reads, so the table
+   * heap is never touched. An aggregation without group by may also swap a seq scan for a full B+ tree scan.
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief read the rows of an index range scan in page order with a bitmap heap scan when the order does not
+   * matter, i.e. under an aggregation without group by
+   */
+  auto OptimizeIndexScanAsBitmapScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /**
    * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. BusTub
    * doesn't support statistics for now, so it's the only way for you to get the table size :(
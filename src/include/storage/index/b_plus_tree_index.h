@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -35,6 +36,13 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Sort the keys and look them all up in one sweep over the leaves, see BPlusTree::GetValues() */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::pair<size_t, RID>> *result,
+                Transaction *transaction) override;
+
+  /** The tree keeps one entry per key, so it stops holding every row once it refuses a duplicate key */
+  auto HoldsEveryRow() const -> bool override { return holds_every_row_.load(); }
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -46,6 +54,8 @@ class BPlusTreeIndex : public Index {
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // whether every entry ever inserted went into the tree
+  std::atomic<bool> holds_every_row_{true};
 };
 
 /** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
@@ -42,17 +42,12 @@ class GenericKey {
   }
 
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
-    }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return Value::DeserializeFrom(GetDataPtr(schema, column_idx), schema->GetColumn(column_idx).GetType());
+  }
+
+  // Like ToValue(), but a long VARCHAR is left in the key, so the value must not outlive the key
+  inline auto ToValueView(Schema *schema, uint32_t column_idx) const -> Value {
+    return Value::DeserializeViewFrom(GetDataPtr(schema, column_idx), schema->GetColumn(column_idx).GetType());
   }
 
   // NOTE: for test purpose only
@@ -68,6 +63,16 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  inline auto GetDataPtr(Schema *schema, uint32_t column_idx) const -> const char * {
+    const auto &col = schema->GetColumn(column_idx);
+    if (col.IsInlined()) {
+      return data_ + col.GetOffset();
+    }
+    int32_t offset = *reinterpret_cast<const int32_t *>(data_ + col.GetOffset());
+    return data_ + offset;
+  }
 };
 
 /**
@@ -80,8 +85,8 @@ class GenericComparator {
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
+      Value lhs_value = (lhs.ToValueView(key_schema_, i));
+      Value rhs_value = (rhs.ToValueView(key_schema_, i));
 
       if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
         return -1;
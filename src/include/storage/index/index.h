@@ -139,6 +139,12 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /**
+   * @return false once the index has turned an entry away, e.g. a B+ tree given a second row with a key it already
+   * holds. Scanning such an index may miss rows of the table, so it must not stand in for a table scan.
+   */
+  virtual auto HoldsEveryRow() const -> bool { return true; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -175,6 +181,25 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for many keys at once. The default searches key by key, indexes override it where looking up
+   * the keys together is cheaper.
+   * @param keys The index keys, in any order
+   * @param result The (index into `keys`, RID) pair of every match, in no particular order
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::pair<size_t, RID>> *result,
+                        Transaction *transaction) {
+    std::vector<RID> rids;
+    for (size_t i = 0; i < keys.size(); i++) {
+      rids.clear();
+      ScanKey(keys[i], &rids, transaction);
+      for (const auto &rid : rids) {
+        result->emplace_back(i, rid);
+      }
+    }
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -57,16 +57,16 @@ class HashTableBlockPage {
 
   /**
    * Attempts to insert a key and value into an index in the block.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
+   * Writes the key and value into the index, and then marks the index as
+   * occupied and readable. Callers serialize writers of a block with the
+   * page write latch.
    *
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
    * @return If the value is inserted successfully, it returns true. If the
-   * index is marked as occupied before the key and value can be inserted,
-   * Insert returns false.
+   * index already holds a readable key and value, Insert returns false.
+   * Tombstones are reused.
    */
   auto Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) -> bool;
 
@@ -33,6 +33,16 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  Besides the bitmaps, every slot owns one tag byte in tags_, stored apart
+ *  from the key/value pairs:
+ *  ----------------------------------------------
+ * | TAG(1) | TAG(2) | ... | TAG(n) | array_ ...
+ *  ----------------------------------------------
+ *
+ *  A readable slot holds 0x80 | (7 bits of the key's hash), any other slot
+ *  holds 0. Probes compare BUCKET_TAG_GROUP_SIZE tags with one SIMD
+ *  instruction and only call the comparator on slots whose tag matches.
+ *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -138,10 +148,33 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /** Tag of a slot that does not hold a readable key/value pair. */
+  static constexpr uint8_t EMPTY_TAG = 0;
+
+  /**
+   * @return the tag stored for key, which always has its high bit set
+   */
+  static auto KeyTag(const KeyType &key) -> uint8_t;
+
+  /**
+   * @param group_idx index of the first slot of the tag group
+   * @param tag tag to look for
+   * @return bitmask of the slots in the group whose tag equals tag
+   */
+  auto MatchTag(uint32_t group_idx, uint8_t tag) const -> uint32_t;
+
+  /**
+   * @param group_idx index of the first slot of the tag group
+   * @return bitmask of the slots in the group that are not readable
+   */
+  auto MatchEmpty(uint32_t group_idx) const -> uint32_t;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // Hash tag of each slot, EMPTY_TAG if the slot is not readable. Padded to whole tag groups.
+  uint8_t tags_[BUCKET_TAG_ARRAY_SIZE];
   // Flexible array member for page data.
   MappingType array_[1];
 };
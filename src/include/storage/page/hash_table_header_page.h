@@ -26,10 +26,11 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 32 bytes in total with padding), followed by
+ * the page_ids of the block pages:
+ * ---------------------------------------------------------------------------
+ * | LSN (4) | Size (8) | PageId(4) | NextBlockIndex(8) | BlockPageIds ...
+ * ---------------------------------------------------------------------------
  */
 class HashTableHeaderPage {
  public:
@@ -89,13 +90,18 @@ class HashTableHeaderPage {
    */
   auto NumBlocks() -> size_t;
 
+  /**
+   * @return the number of block page_ids that fit in a header page
+   */
+  static auto MaxNumBlocks() -> size_t;
+
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
   // Flexible array member for page data.
-  __attribute__((unused)) page_id_t block_page_ids_[1];
+  page_id_t block_page_ids_[1];
 };
 
 }  // namespace bustub
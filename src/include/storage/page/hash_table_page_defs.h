@@ -35,10 +35,28 @@
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hash index bucket page.
- * The computation is the same as the above BLOCK_ARRAY_SIZE, but blocks and buckets have different implementations
- * of search, insertion, removal, and helper methods.
+ * The computation is similar to the above BLOCK_ARRAY_SIZE, except that every slot of a bucket also owns one tag
+ * byte (see HashTableBucketPage), so each key/value pair costs sizeof(MappingType) + 1.25 bytes:
+ * 4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 5) = BUSTUB_PAGE_SIZE / (sizeof(MappingType) + 1.25).
+ * One tag group is held back from the page for the padding of the tag array, see BUCKET_TAG_ARRAY_SIZE.
  */
-#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * (BUSTUB_PAGE_SIZE - BUCKET_TAG_GROUP_SIZE) / (4 * sizeof(MappingType) + 5))
+
+/**
+ * BUCKET_TAG_GROUP_SIZE is the number of bucket tags compared by a single SIMD instruction when probing a bucket page.
+ */
+#if defined(__AVX2__)
+#define BUCKET_TAG_GROUP_SIZE 32
+#else
+#define BUCKET_TAG_GROUP_SIZE 16
+#endif
+
+/**
+ * BUCKET_TAG_ARRAY_SIZE is BUCKET_ARRAY_SIZE rounded up to whole tag groups, so that a SIMD load of the last group
+ * stays inside the tag array.
+ */
+#define BUCKET_TAG_ARRAY_SIZE \
+  ((BUCKET_ARRAY_SIZE + BUCKET_TAG_GROUP_SIZE - 1) / BUCKET_TAG_GROUP_SIZE * BUCKET_TAG_GROUP_SIZE)
 
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
@@ -123,6 +123,14 @@ class TablePage : public Page {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool;
 
+  /**
+   * Read a tuple in place, without copying it out of the page.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple a tuple that does not own its data, only valid while the page stays latched and pinned
+   * @return true if the tuple exists
+   */
+  auto GetTupleView(const RID &rid, Tuple *tuple) -> bool;
+
   /** @return the rid of the first tuple in this page */
 
   /**
@@ -22,15 +22,50 @@ class TmpTuplePage : public Page {
  public:
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    SetFreeSpacePointer(page_size);
   }
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  auto GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /**
+   * Insert a tuple at the end of the free space.
+   * @param tuple the tuple to insert
+   * @param[out] out the location of the tuple
+   * @return `false` if the page is too full for the tuple
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    if (GetFreeSpacePointer() < OFFSET_TUPLES + size) {
+      return false;
+    }
+    SetFreeSpacePointer(GetFreeSpacePointer() - size);
+    tuple.SerializeTo(GetData() + GetFreeSpacePointer());
+    *out = TmpTuple(GetTablePageId(), GetFreeSpacePointer());
+    return true;
+  }
+
+  /**
+   * Read back a tuple of this page.
+   * @param offset the offset of the tuple, as returned by Insert()
+   * @param[out] tuple the tuple, a deep copy
+   * @return the offset of the tuple inserted right before it, the page size if it is the first one
+   */
+  auto Get(uint32_t offset, Tuple *tuple) -> uint32_t {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
+
+  /** @return the offset of the tuple inserted last, equal to the page size if the page is empty */
+  auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
  private:
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
+
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr uint32_t OFFSET_FREE_SPACE = sizeof(page_id_t) + sizeof(lsn_t);
+  static constexpr uint32_t OFFSET_TUPLES = OFFSET_FREE_SPACE + sizeof(uint32_t);
 };
 
 }  // namespace bustub
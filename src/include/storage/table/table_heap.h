@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -101,6 +103,17 @@ class TableHeap {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
 
+  /**
+   * Read many tuples from the table. Consecutive rids on the same page share one fetch of the page, so rids sorted
+   * by page fetch every page once.
+   * @param rids rids of the tuples to read
+   * @param[out] tuples one tuple per rid
+   * @param[out] found whether the read of each rid was successful
+   * @param txn transaction performing the read
+   */
+  void GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, std::vector<bool> *found,
+                 Transaction *txn);
+
   /** @return the begin iterator of this table */
   auto Begin(Transaction *txn) -> TableIterator;
 
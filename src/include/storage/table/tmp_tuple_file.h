@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.h
+//
+// Identification: src/include/storage/table/tmp_tuple_file.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleFile is an append-only run of tuples that an executor spills when its state outgrows the memory budget.
+ *
+ * The tuples are kept on TmpTuplePages of the buffer pool, which writes them to disk once they are evicted. No page
+ * stays pinned between calls, so any number of files can be open at the same time. The pages are deleted together
+ * with the file.
+ * 临时元组文件：执行器内存不足时将元组溢出到 TmpTuplePage 中，页面经由缓冲池写入磁盘。
+ */
+class TmpTupleFile {
+ public:
+  explicit TmpTupleFile(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  /** Delete the pages of the file. */
+  ~TmpTupleFile();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleFile);
+
+  /**
+   * Append a tuple to the end of the file.
+   * @param tuple the tuple, it must fit on an empty page
+   */
+  void Append(const Tuple &tuple);
+
+  /**
+   * Read the next tuple, in the order they were appended.
+   * @param[out] tuple the tuple
+   * @return `false` once all tuples have been read
+   */
+  auto Next(Tuple *tuple) -> bool;
+
+  /** Start reading from the first tuple again. */
+  void Rewind();
+
+  /** @return the number of tuples in the file */
+  auto NumTuples() const -> size_t { return num_tuples_; }
+
+  /** @return the number of pages of the file */
+  auto NumPages() const -> size_t { return page_ids_.size(); }
+
+  /** @return the number of pages all files of the process have allocated so far, for tests to tell a spill */
+  static auto NumPagesAllocated() -> size_t { return num_pages_allocated_.load(std::memory_order_relaxed); }
+
+ private:
+  /** Copy the tuples of a page into the read buffer, in insertion order. */
+  void ReadPage(page_id_t page_id);
+
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  size_t num_tuples_{0};
+
+  /** The next page to read, and the tuples of the previous one not returned yet, in reverse order */
+  size_t read_page_idx_{0};
+  std::vector<Tuple> read_buffer_;
+
+  static std::atomic<size_t> num_pages_allocated_;
+};
+
+}  // namespace bustub
@@ -32,6 +32,7 @@ class Tuple {
   friend class TablePage;
   friend class TableHeap;
   friend class TableIterator;
+  friend class TupleArena;
 
  public:
   // Default constructor (to create a dummy tuple)
@@ -49,6 +50,15 @@ class Tuple {
   // assign operator, deep copy
   auto operator=(const Tuple &other) -> Tuple &;
 
+  // move constructor, takes over the data of other
+  Tuple(Tuple &&other) noexcept;
+
+  // move assign operator, takes over the data of other
+  auto operator=(Tuple &&other) noexcept -> Tuple &;
+
+  // deep copy, also of a tuple that does not own its data
+  auto DeepCopy() const -> Tuple;
+
   ~Tuple() {
     if (allocated_) {
       delete[] data_;
@@ -75,15 +85,19 @@ class Tuple {
   // checks the schema to see how to return the Value.
   auto GetValue(const Schema *schema, uint32_t column_idx) const -> Value;
 
+  // Get the value of a specified column without copying a long VARCHAR out of the tuple,
+  // the value must not outlive the tuple data unless it is copied first
+  auto GetValueView(const Schema *schema, uint32_t column_idx) const -> Value;
+
   // Generates a key tuple given schemas and attributes
   auto KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) -> Tuple;
 
   // Is the column value null ?
   inline auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
-    Value value = GetValue(schema, column_idx);
+    Value value = GetValueView(schema, column_idx);
     return value.IsNull();
   }
-  inline auto IsAllocated() -> bool { return allocated_; }
+  inline auto IsAllocated() const -> bool { return allocated_; }
 
   auto ToString(const Schema *schema) const -> std::string;
 
@@ -91,6 +105,12 @@ class Tuple {
   // Get the starting storage address of specific column
   auto GetDataPtr(const Schema *schema, uint32_t column_idx) const -> const char *;
 
+  // Get the length of a tuple made of the values
+  static auto SerializedLength(const std::vector<Value> &values, const Schema *schema) -> uint32_t;
+
+  // Serialize the values into SerializedLength() bytes of zeroed storage
+  static void SerializeValues(const std::vector<Value> &values, const Schema *schema, char *storage);
+
   bool allocated_{false};  // is allocated?
   RID rid_{};              // if pointing to the table heap, the rid is valid
   uint32_t size_{0};
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_arena.h
+//
+// Identification: src/include/storage/table/tuple_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TupleArena keeps copies of tuples in large blocks of memory instead of one heap allocation per tuple.
+ *
+ * A stored tuple is handed out as a tuple that does not own its data, it stays valid as long as the arena is not
+ * cleared or destroyed. Blocks are never moved, so storing more tuples does not invalidate the earlier ones. Blocks
+ * start at one page and double up to the maximum block size, so that a small arena stays small. An arena that is
+ * refilled over and over, like the one of a batch, is rewound with Reset() and reuses its blocks.
+ * 元组区域：将元组数据连续地存放在大块内存中，返回的元组不持有数据。
+ */
+class TupleArena {
+ public:
+  /** @param max_block_size the maximum size of a block, a larger tuple gets a block of its own */
+  explicit TupleArena(size_t max_block_size = MAX_BLOCK_SIZE) : max_block_size_(max_block_size) {}
+
+  DISALLOW_COPY(TupleArena);
+  TupleArena(TupleArena &&other) noexcept = default;
+  auto operator=(TupleArena &&other) noexcept -> TupleArena & = default;
+
+  /**
+   * Copy a tuple into the arena.
+   * @param tuple the tuple to copy
+   * @return a tuple viewing the copy, with the RID of the original
+   */
+  auto Store(const Tuple &tuple) -> Tuple;
+
+  /**
+   * Build a tuple from values in the arena.
+   * @param values the values of the tuple
+   * @param schema the schema of the tuple
+   * @return a tuple viewing the arena copy
+   */
+  auto Store(const std::vector<Value> &values, const Schema *schema) -> Tuple;
+
+  /** Release all blocks, every tuple handed out becomes invalid. */
+  void Clear();
+
+  /** Rewind to the first block and keep the blocks for the next tuples, every tuple handed out becomes invalid. */
+  void Reset();
+
+  /** @return the number of bytes allocated for blocks */
+  auto MemoryUsage() const -> size_t { return memory_usage_; }
+
+  static constexpr size_t MIN_BLOCK_SIZE = BUSTUB_PAGE_SIZE;
+  static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+ private:
+  auto Allocate(size_t size) -> char *;
+
+  size_t max_block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  /** Capacity of every block */
+  std::vector<size_t> block_capacities_;
+  /** The block being filled, blocks after it are free since the last Reset() */
+  size_t block_idx_{0};
+  /** Bytes used in the current block */
+  size_t block_used_{0};
+  /** Capacity of the current block */
+  size_t block_capacity_{0};
+  size_t memory_usage_{0};
+};
+
+}  // namespace bustub
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace bustub {
 // Every possible SQL type ID
-enum TypeId { INVALID = 0, BOOLEAN, TINYINT, SMALLINT, INTEGER, BIGINT, DECIMAL, VARCHAR, TIMESTAMP };
+enum TypeId : uint8_t { INVALID = 0, BOOLEAN, TINYINT, SMALLINT, INTEGER, BIGINT, DECIMAL, VARCHAR, TIMESTAMP };
 }  // namespace bustub
@@ -44,7 +44,10 @@ class Value {
   friend class VarlenType;
 
  public:
-  explicit Value(const TypeId type) : manage_data_(false), type_id_(type) { size_.len_ = BUSTUB_VALUE_NULL; }
+  /** VARCHARs of at most this many bytes, terminator included, are stored inside the value itself */
+  static constexpr uint32_t INLINE_LENGTH = sizeof(int64_t);
+
+  explicit Value(const TypeId type) : storage_(Storage::INLINE), type_id_(type) { size_.len_ = BUSTUB_VALUE_NULL; }
   // BOOLEAN and TINYINT
   Value(TypeId type, int8_t i);
   // DECIMAL
@@ -63,14 +66,27 @@ class Value {
   Value(TypeId type, const std::string &data);
 
   Value() : Value(TypeId::INVALID) {}
+  // Copying a view copies the string, so only moves carry a view further.
   Value(const Value &other);
-  auto operator=(Value other) -> Value &;
-  ~Value();
+  Value(Value &&other) noexcept
+      : value_(other.value_), size_(other.size_), storage_(other.storage_), type_id_(other.type_id_) {
+    if (other.storage_ != Storage::INLINE) {
+      other.storage_ = Storage::INLINE;
+      other.size_.len_ = BUSTUB_VALUE_NULL;
+    }
+  }
+  auto operator=(const Value &other) -> Value &;
+  auto operator=(Value &&other) noexcept -> Value &;
+  ~Value() {
+    if (storage_ == Storage::OWNED) {
+      delete[] value_.varlen_;
+    }
+  }
   // NOLINTNEXTLINE
   friend void Swap(Value &first, Value &second) {
     std::swap(first.value_, second.value_);
     std::swap(first.size_, second.size_);
-    std::swap(first.manage_data_, second.manage_data_);
+    std::swap(first.storage_, second.storage_);
     std::swap(first.type_id_, second.type_id_);
   }
   // check whether value is integer
@@ -139,6 +155,10 @@ class Value {
     return Type::GetInstance(type_id)->DeserializeFrom(storage);
   }
 
+  // Deserialize a value like DeserializeFrom(), but leave a long VARCHAR in the storage space instead of copying it.
+  // The value must not outlive the storage space unless it is copied first.
+  static auto DeserializeViewFrom(const char *storage, TypeId type_id) -> Value;
+
   // Return a string version of this value
   inline auto ToString() const -> std::string { return Type::GetInstance(type_id_)->ToString(*this); }
   // Create a copy of this value
@@ -156,6 +176,7 @@ class Value {
     uint64_t timestamp_;
     char *varlen_;
     const char *const_varlen_;
+    char inline_[INLINE_LENGTH];
   } value_;
 
   union {
@@ -163,10 +184,18 @@ class Value {
     TypeId elem_type_id_;
   } size_;
 
-  bool manage_data_;
+  // Where the bytes of a VARCHAR live: inside value_, in a buffer this value owns, or in storage it does not own
+  enum class Storage : uint8_t { INLINE, OWNED, VIEW };
+
+  // Point this VARCHAR at the given bytes, copying them unless it should become a view
+  void SetVarlen(const char *data, uint32_t len, bool view);
+
+  Storage storage_;
   // The data type
   TypeId type_id_;
 };
+
+static_assert(sizeof(Value) == 16, "a Value should fit in two words");
 }  // namespace bustub
 
 template <typename T>
@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/bitmap_heap_scan_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+auto Optimizer::OptimizeIndexScanAsBitmapScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexScanAsBitmapScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Aggregation) {
+    return optimized_plan;
+  }
+  const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+  // A single group comes out the same whatever order the rows are read in
+  if (!agg_plan.GetGroupBys().empty() || agg_plan.GetChildPlan()->GetType() != PlanType::IndexScan) {
+    return optimized_plan;
+  }
+  const auto &index_scan_plan = dynamic_cast<const IndexScanPlanNode &>(*agg_plan.GetChildPlan());
+  const auto &ranges = index_scan_plan.key_ranges_;
+  //点查命中的行很少，只有范围扫描才值得按页顺序读
+  if (std::all_of(ranges.begin(), ranges.end(), [](const IndexKeyRange &range) { return range.IsPoint(); })) {
+    return optimized_plan;
+  }
+  const auto *index_info = catalog_.GetIndex(index_scan_plan.GetIndexOid());
+  // The bitmap is built from the index entries, so it misses whatever rows the index has lost
+  if (!index_info->index_->HoldsEveryRow()) {
+    return optimized_plan;
+  }
+  const auto *table_info = catalog_.GetTable(index_info->table_name_);
+  auto scan = std::make_shared<BitmapHeapScanPlanNode>(
+      index_scan_plan.output_schema_, table_info->oid_, table_info->name_,
+      std::vector<std::vector<BitmapIndexLookup>>{{BitmapIndexLookup{index_info->index_oid_, ranges}}},
+      index_scan_plan.residual_predicate_);
+  return std::make_shared<AggregationPlanNode>(agg_plan.output_schema_, scan, agg_plan.GetGroupBys(),
+                                               agg_plan.GetAggregates(), agg_plan.GetAggregateTypes());
+}
+
+}  // namespace bustub
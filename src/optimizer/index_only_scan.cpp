@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/column.h"
+#include "catalog/schema.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return true if the expression reads no column but col_idx */
+auto ReadsOnlyColumn(const AbstractExpression &expr, uint32_t col_idx) -> bool {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(&expr); column != nullptr) {
+    return column->GetColIdx() == col_idx;
+  }
+  return std::all_of(expr.children_.begin(), expr.children_.end(),
+                     [col_idx](const AbstractExpressionRef &child) { return ReadsOnlyColumn(*child, col_idx); });
+}
+
+/** Rewrite an expression that reads only one column to read it from the single key column */
+auto RewriteForKeyColumn(const AbstractExpressionRef &expr) -> AbstractExpressionRef {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr.get()); column != nullptr) {
+    return std::make_shared<ColumnValueExpression>(0, 0, column->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->children_) {
+    children.emplace_back(RewriteForKeyColumn(child));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // Collect every column the projection or aggregation reads from its scan
+  std::vector<AbstractExpressionRef> exprs;
+  bool any_order = false;
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    const auto &projection_plan = dynamic_cast<const ProjectionPlanNode &>(*optimized_plan);
+    exprs = projection_plan.GetExpressions();
+  } else if (optimized_plan->GetType() == PlanType::Aggregation) {
+    const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+    exprs = agg_plan.GetGroupBys();
+    exprs.insert(exprs.end(), agg_plan.GetAggregates().begin(), agg_plan.GetAggregates().end());
+    // A single group comes out the same whatever order the rows are read in
+    any_order = agg_plan.GetGroupBys().empty();
+  } else {
+    return optimized_plan;
+  }
+
+  const auto &scan_plan = *optimized_plan->children_[0];
+  auto covers = [&](const IndexInfo &index, const AbstractExpressionRef &residual) -> std::optional<uint32_t> {
+    const auto &columns = index.key_schema_.GetColumns();
+    if (columns.size() != 1) {
+      return std::nullopt;
+    }
+    const auto *table_info = catalog_.GetTable(index.table_name_);
+    for (uint32_t col_idx = 0; col_idx < table_info->schema_.GetColumnCount(); col_idx++) {
+      if (table_info->schema_.GetColumn(col_idx).GetName() != columns[0].GetName()) {
+        continue;
+      }
+      if ((residual != nullptr && !ReadsOnlyColumn(*residual, col_idx)) ||
+          !std::all_of(exprs.begin(), exprs.end(),
+                       [col_idx](const AbstractExpressionRef &expr) { return ReadsOnlyColumn(*expr, col_idx); })) {
+        return std::nullopt;
+      }
+      return col_idx;
+    }
+    return std::nullopt;
+  };
+
+  //找到覆盖所有用到的列的索引：已有的索引扫描，或者顺序无关时整个扫描一个 B+ 树索引代替顺序扫描
+  const IndexInfo *index = nullptr;
+  std::optional<uint32_t> col_idx;
+  std::vector<IndexKeyRange> ranges;
+  AbstractExpressionRef residual;
+  if (scan_plan.GetType() == PlanType::IndexScan) {
+    const auto &index_scan_plan = dynamic_cast<const IndexScanPlanNode &>(scan_plan);
+    index = catalog_.GetIndex(index_scan_plan.GetIndexOid());
+    ranges = index_scan_plan.key_ranges_;
+    residual = index_scan_plan.residual_predicate_;
+    col_idx = covers(*index, residual);
+  } else if (scan_plan.GetType() == PlanType::SeqScan && any_order) {
+    const auto &seq_scan_plan = dynamic_cast<const SeqScanPlanNode &>(scan_plan);
+    ranges = {IndexKeyRange{}};
+    residual = seq_scan_plan.filter_predicate_;
+    for (const auto *table_index : catalog_.GetTableIndexes(seq_scan_plan.table_name_)) {
+      // Only a B+ tree can be scanned from end to end, and only one that holds every row can replace the scan
+      if (table_index->index_type_ != IndexType::BPlusTreeIndex || !table_index->index_->HoldsEveryRow() ||
+          table_index->key_schema_.GetColumn(0).GetType() != TypeId::INTEGER) {
+        continue;
+      }
+      col_idx = covers(*table_index, residual);
+      if (col_idx.has_value()) {
+        index = table_index;
+        break;
+      }
+    }
+  }
+  if (!col_idx.has_value()) {
+    return optimized_plan;
+  }
+
+  auto key_schema = std::make_shared<Schema>(std::vector<Column>{scan_plan.OutputSchema().GetColumn(*col_idx)});
+  auto scan = std::make_shared<IndexOnlyScanPlanNode>(key_schema, index->index_oid_, std::move(ranges),
+                                                      residual == nullptr ? nullptr : RewriteForKeyColumn(residual));
+  std::vector<AbstractExpressionRef> key_exprs;
+  for (const auto &expr : exprs) {
+    key_exprs.emplace_back(RewriteForKeyColumn(expr));
+  }
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    return std::make_shared<ProjectionPlanNode>(optimized_plan->output_schema_, std::move(key_exprs), scan);
+  }
+  const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+  size_t num_group_bys = agg_plan.GetGroupBys().size();
+  std::vector<AbstractExpressionRef> group_bys(key_exprs.begin(), key_exprs.begin() + num_group_bys);
+  std::vector<AbstractExpressionRef> aggregates(key_exprs.begin() + num_group_bys, key_exprs.end());
+  return std::make_shared<AggregationPlanNode>(optimized_plan->output_schema_, scan, std::move(group_bys),
+                                               std::move(aggregates), agg_plan.GetAggregateTypes());
+}
+
+}  // namespace bustub
@@ -0,0 +1,101 @@
+#include <memory>
+
+#include "binder/bound_order_by.h"
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+auto Optimizer::IsSortedOn(const AbstractPlanNode &plan, uint32_t col_idx) -> bool {
+  switch (plan.GetType()) {
+    case PlanType::Sort: {
+      // The first sort key decides the order
+      const auto &order_bys = dynamic_cast<const SortPlanNode &>(plan).GetOrderBy();
+      if (order_bys.empty()) {
+        return false;
+      }
+      const auto &[order_type, expr] = order_bys[0];
+      const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      return (order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT) && column_value_expr != nullptr &&
+             column_value_expr->GetColIdx() == col_idx;
+    }
+    case PlanType::IndexScan: {
+      // Only B+ tree indexes return keys in order, and only on the first key column
+      const auto *index_info = catalog_.GetIndex(dynamic_cast<const IndexScanPlanNode &>(plan).GetIndexOid());
+      return index_info != Catalog::NULL_INDEX_INFO && index_info->index_type_ == IndexType::BPlusTreeIndex &&
+             index_info->index_->GetKeyAttrs()[0] == col_idx;
+    }
+    case PlanType::Filter:
+    case PlanType::Limit:
+      return IsSortedOn(*plan.GetChildAt(0), col_idx);
+    case PlanType::Projection: {
+      const auto &expr = dynamic_cast<const ProjectionPlanNode &>(plan).GetExpressions()[col_idx];
+      const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      return column_value_expr != nullptr && IsSortedOn(*plan.GetChildAt(0), column_value_expr->GetColIdx());
+    }
+    case PlanType::MergeJoin: {
+      // The output follows the left child, so chains of merge joins on the same key stay merge joins
+      const auto &merge_join_plan = dynamic_cast<const MergeJoinPlanNode &>(plan);
+      const auto *left_key = dynamic_cast<const ColumnValueExpression *>(merge_join_plan.left_key_expression_.get());
+      return left_key != nullptr && left_key->GetColIdx() == col_idx;
+    }
+    default:
+      return false;
+  }
+}
+
+auto Optimizer::OptimizeNLJAsMergeJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeNLJAsMergeJoin(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() == PlanType::NestedLoopJoin) {
+    const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*optimized_plan);
+    BUSTUB_ENSURE(nlj_plan.children_.size() == 2, "NLJ should have exactly 2 children.");
+    if (nlj_plan.GetJoinType() != JoinType::INNER && nlj_plan.GetJoinType() != JoinType::LEFT) {
+      return optimized_plan;
+    }
+
+    // Same shape as the hash join rule: <column_expr> = <column_expr>, one column from each side
+    const auto *expr = dynamic_cast<const ComparisonExpression *>(&nlj_plan.Predicate());
+    if (expr == nullptr || expr->comp_type_ != ComparisonType::Equal) {
+      return optimized_plan;
+    }
+    const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
+    const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
+    if (left_expr == nullptr || right_expr == nullptr || left_expr->GetTupleIdx() == right_expr->GetTupleIdx()) {
+      return optimized_plan;
+    }
+    if (left_expr->GetTupleIdx() == 1) {
+      std::swap(left_expr, right_expr);
+    }
+
+    // Both sides must already be sorted on their key, otherwise the hash join is cheaper than sorting
+    if (!IsSortedOn(*nlj_plan.GetLeftPlan(), left_expr->GetColIdx()) ||
+        !IsSortedOn(*nlj_plan.GetRightPlan(), right_expr->GetColIdx())) {
+      return optimized_plan;
+    }
+    return std::make_shared<MergeJoinPlanNode>(
+        nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), nlj_plan.GetRightPlan(),
+        std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType()),
+        std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType()),
+        nlj_plan.GetJoinType());
+  }
+
+  return optimized_plan;
+}
+
+}  // namespace bustub
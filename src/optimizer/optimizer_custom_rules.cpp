@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
 #include "execution/expressions/arithmetic_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
@@ -5,6 +9,7 @@
 #include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/aggregation_plan.h"
+#include "execution/plans/bitmap_heap_scan_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
 #include "execution/plans/mock_scan_plan.h"
@@ -130,7 +135,7 @@ auto Optimizer::OptimizePredicatePushDown(const AbstractPlanNodeRef &plan) -> Ab
     std::vector<AbstractExpressionRef> join_preds;
     std::vector<AbstractExpressionRef> filter_preds;
     if (const auto *expr = dynamic_cast<const LogicExpression *>(&nlj_plan.Predicate()); expr != nullptr) {
-      while (const auto *inner_expr = dynamic_cast<const LogicExpression *>(expr->children_[0].get())) {
+      while (dynamic_cast<const LogicExpression *>(expr->children_[0].get()) != nullptr) {
         if (const auto *pred = dynamic_cast<const ColumnValueExpression *>(expr->children_[1]->children_[1].get());
             pred != nullptr) {
           join_preds.push_back(expr->children_[1]);
@@ -314,6 +319,194 @@ auto Optimizer::OptimizeRemoveColumn(const AbstractPlanNodeRef &plan) -> Abstrac
   return optimized_plan;
 }
 
+namespace {
+
+/** Split a conjunction into its terms. */
+void SplitConjunction(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *terms) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr.get());
+      logic != nullptr && logic->logic_type_ == LogicType::And) {
+    SplitConjunction(logic->children_[0], terms);
+    SplitConjunction(logic->children_[1], terms);
+    return;
+  }
+  terms->push_back(expr);
+}
+
+/** A comparison of a column with an integer constant, normalized to have the column on the left */
+struct ColumnBound {
+  uint32_t col_idx_;
+  ComparisonType comp_type_;
+  Value value_;
+};
+
+/** @return `col op constant` or `constant op col` as a ColumnBound, std::nullopt for any other expression */
+auto MatchColumnBound(const AbstractExpression &expr) -> std::optional<ColumnBound> {
+  const auto *cmp = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (cmp == nullptr || cmp->comp_type_ == ComparisonType::NotEqual) {
+    return std::nullopt;
+  }
+  auto comp_type = cmp->comp_type_;
+  const auto *col = dynamic_cast<const ColumnValueExpression *>(cmp->children_[0].get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(cmp->children_[1].get());
+  if (col == nullptr || constant == nullptr) {
+    // 5 < x is x > 5
+    col = dynamic_cast<const ColumnValueExpression *>(cmp->children_[1].get());
+    constant = dynamic_cast<const ConstantValueExpression *>(cmp->children_[0].get());
+    if (col == nullptr || constant == nullptr) {
+      return std::nullopt;
+    }
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (col->GetTupleIdx() != 0 || constant->val_.IsNull() || constant->val_.GetTypeId() != TypeId::INTEGER) {
+    return std::nullopt;
+  }
+  return ColumnBound{col->GetColIdx(), comp_type, constant->val_};
+}
+
+/** Match an IN list, i.e. a disjunction of equalities of a single column with constants. */
+auto MatchInList(const AbstractExpression &expr, std::optional<uint32_t> *col_idx, std::vector<Value> *points)
+    -> bool {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(&expr);
+      logic != nullptr && logic->logic_type_ == LogicType::Or) {
+    return MatchInList(*logic->children_[0], col_idx, points) && MatchInList(*logic->children_[1], col_idx, points);
+  }
+  auto bound = MatchColumnBound(expr);
+  if (!bound.has_value() || bound->comp_type_ != ComparisonType::Equal ||
+      (col_idx->has_value() && **col_idx != bound->col_idx_)) {
+    return false;
+  }
+  *col_idx = bound->col_idx_;
+  points->push_back(bound->value_);
+  return true;
+}
+
+/** Split a disjunction into its branches. */
+void SplitDisjunction(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *branches) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr.get());
+      logic != nullptr && logic->logic_type_ == LogicType::Or) {
+    SplitDisjunction(logic->children_[0], branches);
+    SplitDisjunction(logic->children_[1], branches);
+    return;
+  }
+  branches->push_back(expr);
+}
+
+auto ValueLess(const Value &a, const Value &b) -> bool { return a.CompareLessThan(b) == CmpBool::CmpTrue; }
+
+}  // namespace
+
+auto Optimizer::ExtractIndexKeyRanges(std::vector<AbstractExpressionRef> *terms, uint32_t col_idx)
+    -> std::optional<std::vector<IndexKeyRange>> {
+  // All bounds on the column narrow one range, every IN list narrows a set of points
+  IndexKeyRange bounds;
+  std::optional<std::vector<Value>> points;
+  auto narrow_lower = [&](const Value &value, bool inclusive) {
+    if (!bounds.lower_.has_value() || ValueLess(*bounds.lower_, value) ||
+        (!ValueLess(value, *bounds.lower_) && !inclusive)) {
+      bounds.lower_ = value;
+      bounds.lower_inclusive_ = inclusive;
+    }
+  };
+  auto narrow_upper = [&](const Value &value, bool inclusive) {
+    if (!bounds.upper_.has_value() || ValueLess(value, *bounds.upper_) ||
+        (!ValueLess(*bounds.upper_, value) && !inclusive)) {
+      bounds.upper_ = value;
+      bounds.upper_inclusive_ = inclusive;
+    }
+  };
+
+  std::vector<AbstractExpressionRef> rest;
+  bool restricted = false;
+  for (const auto &term : *terms) {
+    if (auto bound = MatchColumnBound(*term); bound.has_value() && bound->col_idx_ == col_idx) {
+      switch (bound->comp_type_) {
+        case ComparisonType::Equal:
+          narrow_lower(bound->value_, true);
+          narrow_upper(bound->value_, true);
+          break;
+        case ComparisonType::LessThan:
+          narrow_upper(bound->value_, false);
+          break;
+        case ComparisonType::LessThanOrEqual:
+          narrow_upper(bound->value_, true);
+          break;
+        case ComparisonType::GreaterThan:
+          narrow_lower(bound->value_, false);
+          break;
+        case ComparisonType::GreaterThanOrEqual:
+          narrow_lower(bound->value_, true);
+          break;
+        default:
+          break;
+      }
+      restricted = true;
+      continue;
+    }
+    std::optional<uint32_t> in_col_idx;
+    std::vector<Value> in_list;
+    if (MatchInList(*term, &in_col_idx, &in_list) && in_col_idx == col_idx) {
+      std::sort(in_list.begin(), in_list.end(), ValueLess);
+      in_list.erase(std::unique(in_list.begin(), in_list.end(),
+                                [](const Value &a, const Value &b) { return !ValueLess(a, b) && !ValueLess(b, a); }),
+                    in_list.end());
+      if (points.has_value()) {
+        std::vector<Value> both;
+        std::set_intersection(points->begin(), points->end(), in_list.begin(), in_list.end(), std::back_inserter(both),
+                              ValueLess);
+        in_list = std::move(both);
+      }
+      points = std::move(in_list);
+      restricted = true;
+      continue;
+    }
+    rest.push_back(term);
+  }
+  if (!restricted) {
+    return std::nullopt;
+  }
+  *terms = std::move(rest);
+
+  auto in_bounds = [&](const Value &value) {
+    if (bounds.lower_.has_value() &&
+        (ValueLess(value, *bounds.lower_) || (!bounds.lower_inclusive_ && !ValueLess(*bounds.lower_, value)))) {
+      return false;
+    }
+    return !(bounds.upper_.has_value() &&
+             (ValueLess(*bounds.upper_, value) || (!bounds.upper_inclusive_ && !ValueLess(value, *bounds.upper_))));
+  };
+  std::vector<IndexKeyRange> ranges;
+  if (points.has_value()) {
+    for (const auto &point : *points) {
+      if (in_bounds(point)) {
+        ranges.push_back({point, true, point, true});
+      }
+    }
+    return ranges;
+  }
+  // An empty range, e.g. x > 5 AND x < 3, scans nothing
+  if (bounds.lower_.has_value() && bounds.upper_.has_value() && !in_bounds(*bounds.lower_) &&
+      !ValueLess(*bounds.lower_, *bounds.upper_)) {
+    return ranges;
+  }
+  ranges.push_back(bounds);
+  return ranges;
+}
+
 auto Optimizer::OptimizeMergeFilterIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -330,25 +523,86 @@ auto Optimizer::OptimizeMergeFilterIndexScan(const AbstractPlanNodeRef &plan) ->
       const auto &seq_scan_plan = dynamic_cast<const SeqScanPlanNode &>(child_plan);
       const auto *table_info = catalog_.GetTable(seq_scan_plan.GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
-      if (const auto *expr = dynamic_cast<const ComparisonExpression *>(filter_plan.GetPredicate().get());
-          expr != nullptr) {
-        if (expr->comp_type_ == ComparisonType::Equal) {
-          if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
-              left_expr != nullptr) {
-            if (const auto *right_expr = dynamic_cast<const ConstantValueExpression *>(expr->children_[1].get());
-                right_expr != nullptr) {
-              for (const auto *index : indices) {
-                const auto &columns = index->key_schema_.GetColumns();
-                if (columns.size() == 1 &&
-                    columns[0].GetName() == table_info->schema_.GetColumn(left_expr->GetColIdx()).GetName()) {
-                  return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_,
-                                                             filter_plan.GetPredicate());
-                }
-              }
+      std::vector<AbstractExpressionRef> terms;
+      SplitConjunction(filter_plan.GetPredicate(), &terms);
+      if (seq_scan_plan.filter_predicate_ != nullptr) {
+        SplitConjunction(seq_scan_plan.filter_predicate_, &terms);
+      }
+
+      // The single-column integer indexes that hold every row, with the column they are on
+      std::vector<std::pair<const IndexInfo *, uint32_t>> candidates;
+      for (const auto *index : indices) {
+        const auto &columns = index->key_schema_.GetColumns();
+        if (columns.size() != 1 || columns[0].GetType() != TypeId::INTEGER || !index->index_->HoldsEveryRow()) {
+          continue;
+        }
+        for (uint32_t col_idx = 0; col_idx < table_info->schema_.GetColumnCount(); col_idx++) {
+          if (table_info->schema_.GetColumn(col_idx).GetName() == columns[0].GetName()) {
+            candidates.emplace_back(index, col_idx);
+            break;
+          }
+        }
+      }
+      // Look the terms on a column up in its index, if they turn into key ranges the index can scan
+      auto lookup = [this](const IndexInfo *index, uint32_t col_idx,
+                       std::vector<AbstractExpressionRef> *terms) -> std::optional<BitmapIndexLookup> {
+        auto rest = *terms;
+        auto ranges = ExtractIndexKeyRanges(&rest, col_idx);
+        // A hash index can only answer point lookups
+        auto is_point = [](const IndexKeyRange &range) { return range.IsPoint(); };
+        if (!ranges.has_value() || (index->index_type_ == IndexType::HashTableIndex &&
+                                    !std::all_of(ranges->begin(), ranges->end(), is_point))) {
+          return std::nullopt;
+        }
+        *terms = std::move(rest);
+        return BitmapIndexLookup{index->index_oid_, std::move(*ranges)};
+      };
+
+      //每个能提取出键范围的索引是一个子句；析取式的每个分支都能完全由某个索引查找时，也作为一个子句
+      std::vector<std::vector<BitmapIndexLookup>> clauses;
+      for (const auto &[index, col_idx] : candidates) {
+        if (auto index_lookup = lookup(index, col_idx, &terms); index_lookup.has_value()) {
+          clauses.push_back({std::move(*index_lookup)});
+        }
+      }
+      std::vector<AbstractExpressionRef> rest;
+      for (const auto &term : terms) {
+        std::vector<AbstractExpressionRef> branches;
+        SplitDisjunction(term, &branches);
+        std::vector<BitmapIndexLookup> clause;
+        for (const auto &branch : branches) {
+          std::vector<AbstractExpressionRef> branch_terms;
+          SplitConjunction(branch, &branch_terms);
+          for (const auto &[index, col_idx] : candidates) {
+            auto branch_rest = branch_terms;
+            if (auto index_lookup = lookup(index, col_idx, &branch_rest);
+                index_lookup.has_value() && branch_rest.empty()) {
+              clause.push_back(std::move(*index_lookup));
+              break;
             }
           }
         }
+        if (branches.size() > 1 && clause.size() == branches.size()) {
+          clauses.push_back(std::move(clause));
+        } else {
+          rest.push_back(term);
+        }
+      }
+      if (clauses.empty()) {
+        return optimized_plan;
+      }
+
+      AbstractExpressionRef residual = nullptr;
+      for (auto &term : rest) {
+        residual = residual == nullptr ? term : std::make_shared<LogicExpression>(residual, term, LogicType::And);
+      }
+      // A single lookup keeps the key order of an index scan, combined lookups go through a bitmap
+      if (clauses.size() == 1 && clauses[0].size() == 1) {
+        return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, clauses[0][0].index_oid_,
+                                                   std::move(clauses[0][0].key_ranges_), residual);
       }
+      return std::make_shared<BitmapHeapScanPlanNode>(optimized_plan->output_schema_, seq_scan_plan.GetTableOid(),
+                                                      seq_scan_plan.table_name_, std::move(clauses), residual);
     }
   }
   return optimized_plan;
@@ -366,9 +620,12 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   p = OptimizeRemoveJoin(p);
   p = OptimizeRemoveColumn(p);
   p = OptimizeNLJAsIndexJoin(p);
+  p = OptimizeNLJAsMergeJoin(p);
   p = OptimizeNLJAsHashJoin(p);  // Enable this rule after you have implemented hash join.
   p = OptimizeOrderByAsIndexScan(p);
   p = OptimizeSortLimitAsTopN(p);
+  p = OptimizeIndexOnlyScan(p);
+  p = OptimizeIndexScanAsBitmapScan(p);
   return p;
 }
 
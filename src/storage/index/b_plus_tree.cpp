@@ -50,6 +50,55 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return true;
 }
 
+/* 批量查询
+ * Look up many keys in one left-to-right sweep over the leaves. The keys must be sorted. A key past the current leaf
+ * is first looked for in the next leaf, and only if it is past that one as well is the tree descended from the root
+ * again, so keys that are close together share their leaf pages.
+ * @param keys the keys, sorted by the comparator of the tree
+ * @param result the (index into keys, value) pair of every key that exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::pair<size_t, ValueType>> *result,
+                               Transaction *transaction) {
+  root_page_id_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID || keys.empty()) {
+    root_page_id_latch_.RUnlock();
+    return;
+  }
+  auto leaf_page = FindLeaf(keys[0], Operation::SEARCH, transaction);
+  auto *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  //当前叶子是否已不可能包含该键：键大于叶子的最大键且右侧还有叶子
+  auto past_leaf = [&](const KeyType &key) {
+    return node->GetNextPageId() != INVALID_PAGE_ID &&
+           (node->GetSize() == 0 || comparator_(key, node->KeyAt(node->GetSize() - 1)) > 0);
+  };
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (past_leaf(keys[i])) {
+      auto next_page = buffer_pool_manager_->FetchPage(node->GetNextPageId());
+      next_page->RLatch();
+      leaf_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+      leaf_page = next_page;
+      node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+      if (past_leaf(keys[i])) {
+        leaf_page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+        root_page_id_latch_.RLock();
+        leaf_page = FindLeaf(keys[i], Operation::SEARCH, transaction);
+        node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+      }
+    }
+    ValueType v;
+    if (node->Lookup(keys[i], &v, comparator_)) {
+      result->emplace_back(i, v);
+    }
+  }
+
+  leaf_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -464,6 +513,15 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   auto leaf_page = FindLeaf(key, Operation::SEARCH);
   auto *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
   auto idx = leaf_node->KeyIndex(key, comparator_);
+  //key 大于叶子中的所有键时，第一个不小于 key 的键在下一个叶子的开头
+  if (idx == leaf_node->GetSize() && leaf_node->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page = buffer_pool_manager_->FetchPage(leaf_node->GetNextPageId());
+    next_page->RLatch();
+    leaf_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    leaf_page = next_page;
+    idx = 0;
+  }
   return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page, idx);
 }
 
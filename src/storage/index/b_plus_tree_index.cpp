@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -27,7 +29,9 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Insert(index_key, rid, transaction);
+  if (!container_.Insert(index_key, rid, transaction)) {
+    holds_every_row_.store(false);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -48,6 +52,30 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::pair<size_t, RID>> *result,
+                                    Transaction *transaction) {
+  // construct the scan index keys and sort them, remembering where every one came from
+  std::vector<std::pair<KeyType, size_t>> sorted(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    sorted[i].first.SetFromKey(keys[i]);
+    sorted[i].second = i;
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [&](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; });
+  std::vector<KeyType> index_keys;
+  index_keys.reserve(sorted.size());
+  for (const auto &[index_key, key_idx] : sorted) {
+    index_keys.push_back(index_key);
+  }
+
+  size_t first = result->size();
+  container_.GetValues(index_keys, result, transaction);
+  for (size_t i = first; i < result->size(); i++) {
+    (*result)[i].first = sorted[(*result)[i].first].second;
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
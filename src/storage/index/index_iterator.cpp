@@ -32,7 +32,8 @@ INDEXITERATOR_TYPE::~IndexIterator() {
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-  return leaf_->GetNextPageId() == INVALID_PAGE_ID && index_ == leaf_->GetSize();
+  //空树的迭代器没有叶子
+  return leaf_ == nullptr || (leaf_->GetNextPageId() == INVALID_PAGE_ID && index_ == leaf_->GetSize());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -11,71 +11,193 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
+#include "container/hash/hash_function.h"
 #include "storage/index/generic_key.h"
 #include "storage/index/hash_comparator.h"
 #include "storage/table/tmp_tuple.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return mask of the slots of the tag group starting at group_idx that lie inside a bucket of size slots */
+inline auto GroupMask(uint32_t group_idx, size_t size) -> uint32_t {
+  size_t valid = std::min<size_t>(size - group_idx, BUCKET_TAG_GROUP_SIZE);
+  return valid == 32 ? ~0U : (1U << valid) - 1;
+}
+
+}  // namespace
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::KeyTag(const KeyType &key) -> uint8_t {
+  // The directory is indexed with the low bits of the hash, so tag with the high ones.
+  HashFunction<KeyType> hash_fn;
+  return static_cast<uint8_t>(0x80 | (hash_fn.GetHash(key) >> 57));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::MatchTag(uint32_t group_idx, uint8_t tag) const -> uint32_t {
+  // tags_ is padded to whole groups, the padding slots of the last group are cleared by GroupMask.
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tags_ + group_idx));
+  auto mask = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(tag)))));
+#elif defined(__SSE2__)
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags_ + group_idx));
+  auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < BUCKET_TAG_GROUP_SIZE && group_idx + i < BUCKET_ARRAY_SIZE; i++) {
+    mask |= static_cast<uint32_t>(tags_[group_idx + i] == tag) << i;
+  }
+#endif
+  return mask & GroupMask(group_idx, BUCKET_ARRAY_SIZE);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::MatchEmpty(uint32_t group_idx) const -> uint32_t {
+  // Readable slots are exactly the ones whose tag has the high bit set.
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tags_ + group_idx));
+  auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(group));
+#elif defined(__SSE2__)
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags_ + group_idx));
+  auto mask = ~static_cast<uint32_t>(_mm_movemask_epi8(group));
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < BUCKET_TAG_GROUP_SIZE && group_idx + i < BUCKET_ARRAY_SIZE; i++) {
+    mask |= static_cast<uint32_t>(tags_[group_idx + i] == EMPTY_TAG) << i;
+  }
+#endif
+  return mask & GroupMask(group_idx, BUCKET_ARRAY_SIZE);
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+  uint8_t tag = KeyTag(key);
+  bool found = false;
+  for (uint32_t group_idx = 0; group_idx < BUCKET_ARRAY_SIZE; group_idx += BUCKET_TAG_GROUP_SIZE) {
+    for (uint32_t mask = MatchTag(group_idx, tag); mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = group_idx + __builtin_ctz(mask);
+      if (cmp(key, array_[bucket_idx].first) == 0) {
+        result->push_back(array_[bucket_idx].second);
+        found = true;
+      }
+    }
+  }
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  uint8_t tag = KeyTag(key);
+  auto free_idx = static_cast<uint32_t>(BUCKET_ARRAY_SIZE);
+  for (uint32_t group_idx = 0; group_idx < BUCKET_ARRAY_SIZE; group_idx += BUCKET_TAG_GROUP_SIZE) {
+    for (uint32_t mask = MatchTag(group_idx, tag); mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = group_idx + __builtin_ctz(mask);
+      if (cmp(key, array_[bucket_idx].first) == 0 && array_[bucket_idx].second == value) {
+        return false;
+      }
+    }
+    if (free_idx == BUCKET_ARRAY_SIZE) {
+      if (uint32_t mask = MatchEmpty(group_idx); mask != 0) {
+        free_idx = group_idx + __builtin_ctz(mask);
+      }
+    }
+  }
+  if (free_idx == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_idx] = MappingType(key, value);
+  SetOccupied(free_idx);
+  readable_[free_idx / 8] |= static_cast<char>(1 << (free_idx % 8));
+  tags_[free_idx] = tag;
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  uint8_t tag = KeyTag(key);
+  for (uint32_t group_idx = 0; group_idx < BUCKET_ARRAY_SIZE; group_idx += BUCKET_TAG_GROUP_SIZE) {
+    for (uint32_t mask = MatchTag(group_idx, tag); mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = group_idx + __builtin_ctz(mask);
+      if (cmp(key, array_[bucket_idx].first) == 0 && array_[bucket_idx].second == value) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+  tags_[bucket_idx] = EMPTY_TAG;
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+  tags_[bucket_idx] = KeyTag(array_[bucket_idx].first);
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+  uint32_t num_readable = 0;
+  for (char byte : readable_) {
+    num_readable += __builtin_popcount(static_cast<uint8_t>(byte));
+  }
+  return num_readable;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+  for (char byte : readable_) {
+    if (byte != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -178,6 +178,27 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool ac
   return res;
 }
 
+void TableHeap::GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, std::vector<bool> *found,
+                          Transaction *txn) {
+  tuples->resize(rids.size());
+  found->assign(rids.size(), false);
+  size_t i = 0;
+  while (i < rids.size()) {
+    auto page_id = rids[i].GetPageId();
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return;
+    }
+    page->RLatch();
+    for (; i < rids.size() && rids[i].GetPageId() == page_id; i++) {
+      (*found)[i] = page->GetTuple(rids[i], &(*tuples)[i], txn, lock_manager_);
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+}
+
 auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.cpp
+//
+// Identification: src/storage/table/tmp_tuple_file.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_file.h"
+
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+std::atomic<size_t> TmpTupleFile::num_pages_allocated_{0};
+
+TmpTupleFile::~TmpTupleFile() {
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void TmpTupleFile::Append(const Tuple &tuple) {
+  TmpTuple out{INVALID_PAGE_ID, 0};
+  if (!page_ids_.empty()) {
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_ids_.back()));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "TmpTupleFile: cannot fetch page");
+    }
+    bool inserted = page->Insert(tuple, &out);
+    bpm_->UnpinPage(page_ids_.back(), inserted);
+    if (inserted) {
+      num_tuples_++;
+      return;
+    }
+  }
+
+  // The last page is full, start a new one
+  page_id_t page_id;
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "TmpTupleFile: cannot allocate page");
+  }
+  page->Init(page_id, BUSTUB_PAGE_SIZE);
+  page_ids_.push_back(page_id);
+  num_pages_allocated_.fetch_add(1, std::memory_order_relaxed);
+  bool inserted = page->Insert(tuple, &out);
+  bpm_->UnpinPage(page_id, true);
+  if (!inserted) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "TmpTupleFile: tuple larger than a page");
+  }
+  num_tuples_++;
+}
+
+auto TmpTupleFile::Next(Tuple *tuple) -> bool {
+  while (read_buffer_.empty()) {
+    if (read_page_idx_ == page_ids_.size()) {
+      return false;
+    }
+    ReadPage(page_ids_[read_page_idx_++]);
+  }
+  *tuple = std::move(read_buffer_.back());
+  read_buffer_.pop_back();
+  return true;
+}
+
+void TmpTupleFile::Rewind() {
+  read_page_idx_ = 0;
+  read_buffer_.clear();
+}
+
+void TmpTupleFile::ReadPage(page_id_t page_id) {
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "TmpTupleFile: cannot fetch page");
+  }
+  // Tuples grow downwards from the end of the page, so walking up from the free space pointer visits the tuple
+  // inserted last first, which is exactly the order the buffer is popped in
+  for (uint32_t offset = page->GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE;) {
+    Tuple tuple;
+    offset = page->Get(offset, &tuple);
+    read_buffer_.push_back(std::move(tuple));
+  }
+  bpm_->UnpinPage(page_id, false);
+}
+
+}  // namespace bustub
@@ -21,6 +21,7 @@ value 则是某个字段具体的值，value 本身还保存了类型信息。
 #include <cstdlib>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "storage/table/tuple.h"
@@ -32,6 +33,17 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   assert(values.size() == schema->GetColumnCount());
 
   // 1. Calculate the size of the tuple.
+  size_ = SerializedLength(values, schema);
+
+  // 2. Allocate memory.
+  data_ = new char[size_];
+  std::memset(data_, 0, size_);
+
+  // 3. Serialize each attribute based on the input value.
+  SerializeValues(values, schema, data_);
+}
+
+auto Tuple::SerializedLength(const std::vector<Value> &values, const Schema *schema) -> uint32_t {
   uint32_t tuple_size = schema->GetLength();
   for (auto &i : schema->GetUnlinedColumns()) {
     auto len = values[i].GetLength();
@@ -40,13 +52,10 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
     }
     tuple_size += (len + sizeof(uint32_t));
   }
+  return tuple_size;
+}
 
-  // 2. Allocate memory.
-  size_ = tuple_size;
-  data_ = new char[size_];
-  std::memset(data_, 0, size_);
-
-  // 3. Serialize each attribute based on the input value.
+void Tuple::SerializeValues(const std::vector<Value> &values, const Schema *schema, char *storage) {
   uint32_t column_count = schema->GetColumnCount();
   uint32_t offset = schema->GetLength();
 
@@ -54,16 +63,16 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
     const auto &col = schema->GetColumn(i);
     if (!col.IsInlined()) {
       // Serialize relative offset, where the actual varchar data is stored.
-      *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
+      *reinterpret_cast<uint32_t *>(storage + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
-      values[i].SerializeTo(data_ + offset);
+      values[i].SerializeTo(storage + offset);
       auto len = values[i].GetLength();
       if (len == BUSTUB_VALUE_NULL) {
         len = 0;
       }
       offset += (len + sizeof(uint32_t));
     } else {
-      values[i].SerializeTo(data_ + col.GetOffset());
+      values[i].SerializeTo(storage + col.GetOffset());
     }
   }
 }
@@ -102,6 +111,41 @@ auto Tuple::operator=(const Tuple &other) -> Tuple & {
   return *this;
 }
 
+auto Tuple::DeepCopy() const -> Tuple {
+  Tuple copy{rid_};
+  if (data_ != nullptr) {
+    copy.allocated_ = true;
+    copy.size_ = size_;
+    copy.data_ = new char[size_];
+    memcpy(copy.data_, data_, size_);
+  }
+  return copy;
+}
+
+Tuple::Tuple(Tuple &&other) noexcept
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_), data_(other.data_) {
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+}
+
+auto Tuple::operator=(Tuple &&other) noexcept -> Tuple & {
+  if (this == &other) {
+    return *this;
+  }
+  if (allocated_) {
+    delete[] data_;
+  }
+  allocated_ = other.allocated_;
+  rid_ = other.rid_;
+  size_ = other.size_;
+  data_ = other.data_;
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+  return *this;
+}
+
 auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
   assert(schema);
   assert(data_);
@@ -111,14 +155,20 @@ auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> V
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
+auto Tuple::GetValueView(const Schema *schema, const uint32_t column_idx) const -> Value {
+  assert(schema);
+  assert(data_);
+  return Value::DeserializeViewFrom(GetDataPtr(schema, column_idx), schema->GetColumn(column_idx).GetType());
+}
+
 auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
     -> Tuple {
   std::vector<Value> values;
   values.reserve(key_attrs.size());
   for (auto idx : key_attrs) {
-    values.emplace_back(this->GetValue(&schema, idx));
+    values.emplace_back(this->GetValueView(&schema, idx));
   }
-  return {values, &key_schema};
+  return {std::move(values), &key_schema};
 }
 
 auto Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) const -> const char * {
@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_arena.cpp
+//
+// Identification: src/storage/table/tuple_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tuple_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+auto TupleArena::Store(const Tuple &tuple) -> Tuple {
+  Tuple copy{tuple.rid_};
+  copy.size_ = tuple.size_;
+  copy.data_ = Allocate(tuple.size_);
+  memcpy(copy.data_, tuple.data_, tuple.size_);
+  return copy;
+}
+
+auto TupleArena::Store(const std::vector<Value> &values, const Schema *schema) -> Tuple {
+  Tuple copy{};
+  copy.size_ = Tuple::SerializedLength(values, schema);
+  copy.data_ = Allocate(copy.size_);
+  memset(copy.data_, 0, copy.size_);
+  Tuple::SerializeValues(values, schema, copy.data_);
+  return copy;
+}
+
+void TupleArena::Clear() {
+  blocks_.clear();
+  block_capacities_.clear();
+  block_idx_ = 0;
+  block_used_ = 0;
+  block_capacity_ = 0;
+  memory_usage_ = 0;
+}
+
+void TupleArena::Reset() {
+  block_idx_ = 0;
+  block_used_ = 0;
+  block_capacity_ = blocks_.empty() ? 0 : block_capacities_[0];
+}
+
+auto TupleArena::Allocate(size_t size) -> char * {
+  // Keep the tuples 8-byte aligned, so that fixed-size values are read from aligned addresses
+  size = (size + 7) & ~static_cast<size_t>(7);
+  if (block_used_ + size > block_capacity_) {
+    size_t next_idx = blocks_.empty() ? 0 : block_idx_ + 1;
+    // A block kept by Reset() is reused if the tuple fits in it, otherwise a new block takes its place
+    if (next_idx == blocks_.size() || block_capacities_[next_idx] < size) {
+      // Blocks double from one page up to the maximum, a tuple larger than that gets a block of its own
+      size_t next_block_size = std::min(std::max(2 * block_capacity_, MIN_BLOCK_SIZE), max_block_size_);
+      size_t capacity = std::max(next_block_size, size);
+      if (next_idx == blocks_.size()) {
+        blocks_.emplace_back();
+        block_capacities_.push_back(0);
+      }
+      memory_usage_ += capacity - block_capacities_[next_idx];
+      blocks_[next_idx].reset(new char[capacity]);
+      block_capacities_[next_idx] = capacity;
+    }
+    block_idx_ = next_idx;
+    block_used_ = 0;
+    block_capacity_ = block_capacities_[next_idx];
+  }
+  char *data = blocks_[block_idx_].get() + block_used_;
+  block_used_ += size;
+  return data;
+}
+
+}  // namespace bustub
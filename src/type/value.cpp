@@ -18,34 +18,72 @@
 #include "type/value.h"
 
 namespace bustub {
-Value::Value(const Value &other) {
-  type_id_ = other.type_id_;
-  size_ = other.size_;
-  manage_data_ = other.manage_data_;
-  value_ = other.value_;
-  switch (type_id_) {
-    case TypeId::VARCHAR:
-      if (size_.len_ == BUSTUB_VALUE_NULL) {
-        value_.varlen_ = nullptr;
-      } else {
-        if (manage_data_) {
-          value_.varlen_ = new char[size_.len_];
-          memcpy(value_.varlen_, other.value_.varlen_, size_.len_);
-        } else {
-          value_ = other.value_;
-        }
-      }
-      break;
-    default:
-      value_ = other.value_;
+Value::Value(const Value &other)
+    : value_(other.value_), size_(other.size_), storage_(Storage::INLINE), type_id_(other.type_id_) {
+  if (other.storage_ != Storage::INLINE) {
+    SetVarlen(other.value_.const_varlen_, size_.len_, false);
   }
 }
 
-auto Value::operator=(Value other) -> Value & {
-  Swap(*this, other);
+auto Value::operator=(const Value &other) -> Value & {
+  if (this != &other) {
+    if (storage_ == Storage::OWNED) {
+      delete[] value_.varlen_;
+    }
+    value_ = other.value_;
+    size_ = other.size_;
+    storage_ = Storage::INLINE;
+    type_id_ = other.type_id_;
+    if (other.storage_ != Storage::INLINE) {
+      SetVarlen(other.value_.const_varlen_, size_.len_, false);
+    }
+  }
   return *this;
 }
 
+auto Value::operator=(Value &&other) noexcept -> Value & {
+  if (this != &other) {
+    if (storage_ == Storage::OWNED) {
+      delete[] value_.varlen_;
+    }
+    value_ = other.value_;
+    size_ = other.size_;
+    storage_ = other.storage_;
+    type_id_ = other.type_id_;
+    if (other.storage_ != Storage::INLINE) {
+      other.storage_ = Storage::INLINE;
+      other.size_.len_ = BUSTUB_VALUE_NULL;
+    }
+  }
+  return *this;
+}
+
+void Value::SetVarlen(const char *data, uint32_t len, bool view) {
+  size_.len_ = len;
+  if (len <= INLINE_LENGTH) {
+    storage_ = Storage::INLINE;
+    memcpy(value_.inline_, data, len);
+  } else if (view) {
+    storage_ = Storage::VIEW;
+    value_.const_varlen_ = data;
+  } else {
+    storage_ = Storage::OWNED;
+    value_.varlen_ = new char[len];
+    memcpy(value_.varlen_, data, len);
+  }
+}
+
+auto Value::DeserializeViewFrom(const char *storage, TypeId type_id) -> Value {
+  if (type_id != TypeId::VARCHAR) {
+    return DeserializeFrom(storage, type_id);
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(storage);
+  if (len == BUSTUB_VALUE_NULL) {
+    return Value{type_id};
+  }
+  return {type_id, storage + sizeof(uint32_t), len, false};
+}
+
 // BOOLEAN and TINYINT
 Value::Value(TypeId type, int8_t i) : Value(type) {
   switch (type) {
@@ -215,21 +253,11 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data) : Va
   switch (type) {
     case TypeId::VARCHAR:
       if (data == nullptr) {
-        value_.varlen_ = nullptr;
         size_.len_ = BUSTUB_VALUE_NULL;
       } else {
-        manage_data_ = manage_data;
-        if (manage_data_) {
-          assert(len < BUSTUB_VARCHAR_MAX_LEN);
-          value_.varlen_ = new char[len];
-          assert(value_.varlen_ != nullptr);
-          size_.len_ = len;
-          memcpy(value_.varlen_, data, len);
-        } else {
-          // FUCK YOU GCC I do what I want.
-          value_.const_varlen_ = data;
-          size_.len_ = len;
-        }
+        assert(len < BUSTUB_VARCHAR_MAX_LEN);
+        // a short string is copied inline even if the caller keeps the data alive
+        SetVarlen(data, len, !manage_data);
       }
       break;
     default:
@@ -240,13 +268,8 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data) : Va
 Value::Value(TypeId type, const std::string &data) : Value(type) {
   switch (type) {
     case TypeId::VARCHAR: {
-      manage_data_ = true;
       // TODO(TAs): How to represent a null string here?
-      uint32_t len = static_cast<uint32_t>(data.length()) + 1;
-      value_.varlen_ = new char[len];
-      assert(value_.varlen_ != nullptr);
-      size_.len_ = len;
-      memcpy(value_.varlen_, data.c_str(), len);
+      SetVarlen(data.c_str(), static_cast<uint32_t>(data.length()) + 1, false);
       break;
     }
     default:
@@ -254,19 +277,6 @@ Value::Value(TypeId type, const std::string &data) : Value(type) {
   }
 }
 
-// delete allocated char array space
-Value::~Value() {
-  switch (type_id_) {
-    case TypeId::VARCHAR:
-      if (manage_data_) {
-        delete[] value_.varlen_;
-      }
-      break;
-    default:
-      break;
-  }
-}
-
 auto Value::CheckComparable(const Value &o) const -> bool {
   switch (GetTypeId()) {
     case TypeId::BOOLEAN:
@@ -41,7 +41,9 @@ VarlenType::VarlenType(TypeId type) : Type(type) {}
 VarlenType::~VarlenType() = default;
 
 // Access the raw variable length data
-auto VarlenType::GetData(const Value &val) const -> const char * { return val.value_.varlen_; }
+auto VarlenType::GetData(const Value &val) const -> const char * {
+  return val.storage_ == Value::Storage::INLINE ? val.value_.inline_ : val.value_.const_varlen_;
+}
 
 // Get the length of the variable length data (including the length field)
 auto VarlenType::GetLength(const Value &val) const -> uint32_t { return val.size_.len_; }
@@ -162,7 +164,7 @@ void VarlenType::SerializeTo(const Value &val, char *storage) const {
     return;
   }
   memcpy(storage, &len, sizeof(uint32_t));
-  memcpy(storage + sizeof(uint32_t), val.value_.varlen_, len);
+  memcpy(storage + sizeof(uint32_t), GetData(val), len);
 }
 
 // Deserialize a value of the given type from the given storage space.
@@ -171,7 +173,7 @@ auto VarlenType::DeserializeFrom(const char *storage) const -> Value {
   if (len == BUSTUB_VALUE_NULL) {
     return {type_id_, nullptr, len, false};
   }
-  // set manage_data as true
+  // set manage_data as true, a short string is copied inline
   return {type_id_, storage + sizeof(uint32_t), len, true};
 }
 
@@ -17,6 +17,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -119,4 +120,40 @@ TEST_F(TransactionTest, DirtyReadsTest) {
   delete txn1;
 }
 
+// NOLINTNEXTLINE
+TEST_F(TransactionTest, IndexScanLocksBeforeReadTest) {
+  // txn1: UPDATE t1 SET v3 = 99 WHERE v1 = 2
+  // txn2: an index scan or bitmap heap scan reaching the row of v1 = 2, with a residual predicate on v3
+  // txn1: abort
+  // txn2 waits for its lock on the row before reading it, so it sees v3 = 20 again rather than txn1's 99
+
+  auto noop_writer = NoopWriter();
+  bustub_->ExecuteSql("CREATE TABLE t1 (v1 int, v2 int, v3 int);", noop_writer);
+  bustub_->ExecuteSql("INSERT INTO t1 VALUES (1, 10, 10), (2, 20, 20), (3, 30, 30);", noop_writer);
+  bustub_->ExecuteSql("CREATE INDEX t1v1 ON t1(v1);", noop_writer);
+  bustub_->ExecuteSql("CREATE INDEX t1v2 ON t1(v2);", noop_writer);
+
+  // the first query runs as an index scan, the second one as a bitmap heap scan over both indexes
+  for (const char *query : {"SELECT v1, v3 FROM t1 WHERE v1 >= 2 AND v3 < 50",
+                            "SELECT v1, v3 FROM t1 WHERE v1 >= 2 AND v2 <= 30 AND v3 < 50"}) {
+    auto *txn1 = bustub_->txn_manager_->Begin();
+    bustub_->ExecuteSqlTxn("UPDATE t1 SET v3 = 99 WHERE v1 = 2", noop_writer, txn1);
+
+    std::stringstream ss;
+    std::thread reader([&] {
+      auto *txn2 = bustub_->txn_manager_->Begin();
+      auto writer2 = SimpleStreamWriter(ss, true);
+      bustub_->ExecuteSqlTxn(query, writer2, txn2);
+      bustub_->txn_manager_->Commit(txn2);
+      delete txn2;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    bustub_->txn_manager_->Abort(txn1);
+    delete txn1;
+    reader.join();
+
+    EXPECT_EQ(ss.str(), "2\t20\t\n3\t30\t\n") << query;
+  }
+}
+
 }  // namespace bustub
@@ -19,6 +19,7 @@
 #include "storage/disk/disk_manager.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
 
 namespace bustub {
 
@@ -57,7 +58,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -114,4 +115,57 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageFullTest) {
+  using KeyType = int;
+  using ValueType = int;
+  const uint32_t bucket_size = BUCKET_ARRAY_SIZE;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  EXPECT_TRUE(bucket_page->IsEmpty());
+
+  // fill the bucket with few distinct keys, so that most tag probes hit duplicates
+  for (uint32_t i = 0; i < bucket_size; i++) {
+    EXPECT_TRUE(bucket_page->Insert(static_cast<int>(i % 7), static_cast<int>(i), IntComparator()));
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(bucket_size, bucket_page->NumReadable());
+  EXPECT_FALSE(bucket_page->Insert(7, 0, IntComparator()));
+  EXPECT_FALSE(bucket_page->Insert(0, 0, IntComparator()));
+
+  // every value of a key is found, including the ones in the last, partial tag group
+  for (int key = 0; key < 7; key++) {
+    std::vector<int> result;
+    EXPECT_TRUE(bucket_page->GetValue(key, IntComparator(), &result));
+    EXPECT_EQ((bucket_size - key + 6) / 7, result.size());
+    for (int value : result) {
+      EXPECT_EQ(key, value % 7);
+    }
+  }
+  std::vector<int> result;
+  EXPECT_FALSE(bucket_page->GetValue(7, IntComparator(), &result));
+
+  // free the last slot and reuse it
+  uint32_t last = bucket_size - 1;
+  EXPECT_TRUE(bucket_page->Remove(static_cast<int>(last % 7), static_cast<int>(last), IntComparator()));
+  EXPECT_FALSE(bucket_page->IsFull());
+  EXPECT_TRUE(bucket_page->IsOccupied(last));
+  EXPECT_FALSE(bucket_page->IsReadable(last));
+  EXPECT_TRUE(bucket_page->Insert(7, 7, IntComparator()));
+  EXPECT_EQ(7, bucket_page->KeyAt(last));
+  result.clear();
+  EXPECT_TRUE(bucket_page->GetValue(7, IntComparator(), &result));
+  EXPECT_EQ(std::vector<int>{7}, result);
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
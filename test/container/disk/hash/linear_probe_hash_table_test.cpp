@@ -0,0 +1,211 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/disk/hash/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // insert one more value for each key
+  for (int i = 0; i < 5; i++) {
+    if (i == 0) {
+      // duplicate values for the same key are not allowed
+      EXPECT_FALSE(ht.Insert(nullptr, i, 2 * i));
+    } else {
+      EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
+    }
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      EXPECT_EQ(1, res.size());
+      EXPECT_EQ(i, res[0]);
+    } else {
+      EXPECT_EQ(2, res.size());
+    }
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      EXPECT_EQ(1, res.size());
+      EXPECT_EQ(2 * i, res[0]);
+    }
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 0, 0));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, GrowTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // keep growing the table while checking everything inserted so far, including pairs under migration
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    if (i % 97 == 0) {
+      for (int j = 0; j <= i; j += 13) {
+        std::vector<int> res;
+        EXPECT_TRUE(ht.GetValue(nullptr, j, &res)) << "Failed to keep " << j << " after inserting " << i;
+        EXPECT_EQ(std::vector<int>{j}, res);
+      }
+    }
+  }
+  EXPECT_GT(ht.GetSize(), initial_size);
+  EXPECT_GE(ht.GetSize(), static_cast<size_t>(num_keys));
+
+  // remove half the keys, tombstones must not hide the rest
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+  }
+
+  // an explicit resize finishes every pending migration
+  ht.Resize(ht.GetSize());
+  for (int i = 1; i < num_keys; i += 2) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentGrowTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  // the first half of the keys is inserted up front, readers keep looking it up while writers grow the table
+  const int num_threads = 4;
+  const int keys_per_thread = 1000;
+  for (int i = 0; i < keys_per_thread; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 1; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t * keys_per_thread; i < (t + 1) * keys_per_thread; i++) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+      }
+    });
+  }
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht] {
+      for (int i = 0; i < keys_per_thread; i++) {
+        std::vector<int> res;
+        EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+        EXPECT_EQ(std::vector<int>{i}, res);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentDuplicateTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10000, HashFunction<int>());
+
+  // every thread inserts the same pairs while one more thread frees slots in their runs, exactly one insert of each
+  // pair may succeed
+  const int num_threads = 4;
+  const int num_keys = 2000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, -1));
+  }
+  std::vector<std::atomic<int>> inserted(num_keys);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_keys; i++) {
+        if (ht.Insert(nullptr, i, i)) {
+          inserted[i]++;
+        }
+      }
+    });
+  }
+  threads.emplace_back([&] {
+    for (int i = 0; i < num_keys; i++) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, -1));
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_EQ(1, inserted[i]);
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,99 @@
+/**
+ * extendible_hash_table_concurrent_test.cpp
+ */
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ExtendibleHashTableConcurrentTest, MixedTest) {
+  const int num_threads = 4;
+  const int keys_per_thread = 2000;
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+
+  // every thread owns a disjoint key range, splits triggered by one thread must not lose keys of the others
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &table]() {
+      for (int i = tid * keys_per_thread; i < (tid + 1) * keys_per_thread; i++) {
+        table->Insert(i, i);
+      }
+      for (int i = tid * keys_per_thread; i < (tid + 1) * keys_per_thread; i++) {
+        int val;
+        EXPECT_TRUE(table->Find(i, val));
+        EXPECT_EQ(i, val);
+        if (i % 2 == 0) {
+          EXPECT_TRUE(table->Remove(i));
+        } else {
+          table->Insert(i, -i);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    int val;
+    if (i % 2 == 0) {
+      EXPECT_FALSE(table->Find(i, val));
+    } else {
+      EXPECT_TRUE(table->Find(i, val));
+      EXPECT_EQ(-i, val);
+    }
+  }
+}
+
+/**
+ * A read-mostly workload over a prefilled table, like the buffer pool page table sees. Lookups racing with inserts
+ * of the same keys must never miss. tools/hash_table_bench measures the throughput of this workload.
+ */
+TEST(ExtendibleHashTableConcurrentTest, ReadMostlyTest) {
+  const int num_threads = 4;
+  const int num_keys = 10000;
+  const int ops_per_thread = 20000;
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(8);
+  for (int i = 0; i < num_keys; i++) {
+    table->Insert(i, i);
+  }
+
+  std::atomic<int> misses{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &table, &misses]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<int> dis(0, num_keys - 1);
+      for (int op = 0; op < ops_per_thread; op++) {
+        int key = dis(gen);
+        if (op % 10 == 0) {
+          // overwrite with the same value, so readers always see key == value
+          table->Insert(key, key);
+        } else {
+          int val;
+          if (!table->Find(key, val) || val != key) {
+            misses++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, misses.load());
+  for (int i = 0; i < num_keys; i++) {
+    int val;
+    EXPECT_TRUE(table->Find(i, val));
+    EXPECT_EQ(i, val);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregate_kernel_test.cpp
+//
+// Identification: test/execution/aggregate_kernel_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "query_test_util.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(AggregateKernelTest, KernelTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t2 (a int, b int, c varchar(8));", writer);
+
+  // no rows: count(*) is 0, every other aggregate is NULL
+  EXPECT_EQ("0,\n", Query(bustub.get(), "SELECT count(*) FROM t2;"));
+  EXPECT_EQ("integer_null,\n", Query(bustub.get(), "SELECT count(a) FROM t2;"));
+  EXPECT_EQ("integer_null,\n", Query(bustub.get(), "SELECT max(a) FROM t2;"));
+
+  bustub->ExecuteSql(
+      "INSERT INTO t2 VALUES (1, 1, 'x'), (NULL, 1, 'y'), (-5, 1, 'z'), (NULL, 2, 'x'), (2147483647, 3, 'y'), "
+      "(2147483646, 3, 'y'), (-2147483647, 3, 'z');",
+      writer);
+  // the integer kernels skip NULL inputs, a group of NULLs only counts them; sums may leave the range on the way
+  EXPECT_EQ(
+      "1,3,2,-4,-5,1,\n"
+      "2,1,0,integer_null,integer_null,integer_null,\n"
+      "3,3,3,2147483646,-2147483647,2147483647,\n",
+      Query(bustub.get(), "SELECT b, count(*), count(a), sum(a), min(a), max(a) FROM t2 GROUP BY b ORDER BY b;"));
+  // aggregates without a typed kernel next to ones with
+  EXPECT_EQ("x,2,1,\ny,3,2147483646,\nz,2,-2147483647,\n",
+            Query(bustub.get(), "SELECT c, count(c), min(a) FROM t2 GROUP BY c ORDER BY c;"));
+  EXPECT_EQ("2,-2147483647,\n", Query(bustub.get(), "SELECT count(*), min(a + 0) FROM t2 WHERE c = 'z';"));
+}
+
+}  // namespace bustub
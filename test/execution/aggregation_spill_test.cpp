@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_spill_test.cpp
+//
+// Identification: test/execution/aggregation_spill_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "spill_test_util.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(AggregationSpillTest, SpillTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t1 (x int, y int, z varchar(32));", writer);
+
+  // 3000 groups of x, every group but the NULL one has two rows, 50 groups of z
+  std::string insert = "INSERT INTO t1 VALUES ";
+  for (int i = 0; i < 6000; i++) {
+    insert += fmt::format("{}({}, {}, 'group {}')", i == 0 ? "" : ", ", (i * 7919) % 3000, i, i % 50);
+  }
+  insert += ", (NULL, 1, 'group 0'), (NULL, 2, 'group 1')";
+  bustub->ExecuteSql(insert, writer);
+
+  const std::vector<std::string> queries = {
+      "SELECT x, count(*), sum(y), min(y), max(y) FROM t1 GROUP BY x ORDER BY x;",
+      "SELECT z, x, count(y) FROM t1 WHERE y > 10 GROUP BY z, x ORDER BY z, x;",
+      "SELECT count(*) FROM (SELECT x, count(*) FROM t1 GROUP BY x);",
+      "SELECT z, count(*) FROM (SELECT z, y FROM t1 ORDER BY y) GROUP BY z ORDER BY z;",
+  };
+
+  // The groups take about 500 KB in memory: a few spills at 64 KB, partitions are split again at 4 KB
+  auto in_memory = ExpectSameResultsWhenSpilling(bustub.get(), queries, {64 * 1024, 4 * 1024});
+  // NULL keys form one group
+  EXPECT_EQ("integer_null,2,3,1,2,\n", in_memory[0].substr(0, in_memory[0].find('\n') + 1));
+  EXPECT_EQ("3001,\n", in_memory[2]);
+}
+
+}  // namespace bustub
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression_test.cpp
+//
+// Identification: test/execution/compiled_expression_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution/compiled_expression.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/tuple_batch.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeBatch(const Schema *schema, int num_rows) -> std::unique_ptr<TupleBatch> {
+  auto batch = std::make_unique<TupleBatch>(num_rows);
+  batch->Reset(schema);
+  for (int i = 0; i < num_rows; i++) {
+    // every third row has a NULL in the second column
+    auto b = i % 3 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i * 10);
+    auto c = ValueFactory::GetVarcharValue(std::string(i % 4, 'x'));
+    batch->Append(Tuple{{ValueFactory::GetIntegerValue(i), b, c}, schema}, RID{0, static_cast<uint32_t>(i)});
+  }
+  return batch;
+}
+
+auto ColumnRef(uint32_t col_idx, TypeId type = TypeId::INTEGER) -> AbstractExpressionRef {
+  return std::make_shared<ColumnValueExpression>(0, col_idx, type);
+}
+
+auto Constant(const Value &val) -> AbstractExpressionRef { return std::make_shared<ConstantValueExpression>(val); }
+
+auto Compare(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ComparisonType type) -> AbstractExpressionRef {
+  return std::make_shared<ComparisonExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+auto Logic(AbstractExpressionRef lhs, AbstractExpressionRef rhs, LogicType type) -> AbstractExpressionRef {
+  return std::make_shared<LogicExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+/** Check that the compiled expression agrees with the expression tree, both as values and as a filter */
+void ExpectSameAsTree(const AbstractExpressionRef &expr, const Schema &schema, bool compiled) {
+  CompiledExpression compiled_expr{expr};
+  EXPECT_EQ(compiled, compiled_expr.IsCompiled()) << expr->ToString();
+
+  auto batch = MakeBatch(&schema, 12);
+  std::vector<Value> expected;
+  std::vector<Value> actual;
+  expr->EvaluateBatch(*batch, &expected);
+  compiled_expr.EvaluateBatch(*batch, &actual);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].IsNull(), actual[i].IsNull()) << expr->ToString() << " row " << i;
+    if (!expected[i].IsNull()) {
+      EXPECT_EQ(CmpBool::CmpTrue, expected[i].CompareEquals(actual[i])) << expr->ToString() << " row " << i;
+    }
+  }
+
+  if (expr->GetReturnType() != TypeId::BOOLEAN) {
+    return;
+  }
+  auto filtered = MakeBatch(&schema, 12);
+  compiled_expr.Filter(filtered.get());
+  batch->Select(expected);
+  ASSERT_EQ(batch->Size(), filtered->Size()) << expr->ToString();
+  for (size_t i = 0; i < batch->Size(); i++) {
+    EXPECT_EQ(batch->GetRID(i), filtered->GetRID(i));
+  }
+}
+
+auto MakeNumericBatch(const Schema *schema, int num_rows) -> std::unique_ptr<TupleBatch> {
+  auto batch = std::make_unique<TupleBatch>(num_rows);
+  batch->Reset(schema);
+  for (int i = 0; i < num_rows; i++) {
+    // every column is NULL on a different set of rows, and the values cross over between the columns
+    auto null_or = [i](int period, TypeId type, const Value &value) {
+      return i % period == 0 ? ValueFactory::GetNullValueByType(type) : value;
+    };
+    std::vector<Value> values{
+        null_or(5, TypeId::TINYINT, ValueFactory::GetTinyIntValue(static_cast<int8_t>(i - 20))),
+        null_or(6, TypeId::SMALLINT, ValueFactory::GetSmallIntValue(static_cast<int16_t>(30 - i))),
+        null_or(7, TypeId::BIGINT, ValueFactory::GetBigIntValue((int64_t{1} << 40) * (i % 3) + i)),
+        null_or(4, TypeId::DECIMAL, ValueFactory::GetDecimalValue(i * 0.5 - 5)),
+        null_or(9, TypeId::INTEGER, ValueFactory::GetIntegerValue(i % 11 - 5)),
+    };
+    batch->Append(Tuple{values, schema}, RID{0, static_cast<uint32_t>(i)});
+  }
+  return batch;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(CompiledExpressionTest, MatchesTreeTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}, Column{"c", TypeId::VARCHAR, 8}}};
+  auto null_int = Constant(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+
+  auto sum = std::make_shared<ArithmeticExpression>(ColumnRef(0), ColumnRef(1), ArithmeticType::Plus);
+  auto diff = std::make_shared<ArithmeticExpression>(ColumnRef(1), Constant(ValueFactory::GetIntegerValue(25)),
+                                                     ArithmeticType::Minus);
+  ExpectSameAsTree(ColumnRef(1), schema, true);
+  ExpectSameAsTree(sum, schema, true);
+  ExpectSameAsTree(diff, schema, true);
+  ExpectSameAsTree(std::make_shared<ArithmeticExpression>(ColumnRef(0), null_int, ArithmeticType::Plus), schema,
+                   true);
+
+  for (auto type : {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan,
+                    ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual}) {
+    ExpectSameAsTree(Compare(ColumnRef(1), Constant(ValueFactory::GetIntegerValue(50)), type), schema, true);
+    ExpectSameAsTree(Compare(sum, diff, type), schema, true);
+  }
+
+  // three-valued logic: the NULLs of the second column must not turn into false too early
+  auto b_small = Compare(ColumnRef(1), Constant(ValueFactory::GetIntegerValue(60)), ComparisonType::LessThan);
+  auto a_odd_half = Compare(ColumnRef(0), Constant(ValueFactory::GetIntegerValue(5)), ComparisonType::GreaterThan);
+  auto a_null = Compare(ColumnRef(0), null_int, ComparisonType::Equal);
+  for (auto type : {LogicType::And, LogicType::Or}) {
+    ExpectSameAsTree(Logic(b_small, a_odd_half, type), schema, true);
+    ExpectSameAsTree(Logic(b_small, a_null, type), schema, true);
+    ExpectSameAsTree(Logic(Logic(b_small, a_null, LogicType::Or), a_odd_half, type), schema, true);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompiledExpressionTest, NumericTypesTest) {
+  Schema schema{{Column{"t", TypeId::TINYINT}, Column{"s", TypeId::SMALLINT}, Column{"b", TypeId::BIGINT},
+                 Column{"d", TypeId::DECIMAL}, Column{"i", TypeId::INTEGER}}};
+  std::vector<TypeId> types{TypeId::TINYINT, TypeId::SMALLINT, TypeId::BIGINT, TypeId::DECIMAL, TypeId::INTEGER};
+  std::vector<AbstractExpressionRef> constants{
+      Constant(ValueFactory::GetTinyIntValue(static_cast<int8_t>(-3))),
+      Constant(ValueFactory::GetSmallIntValue(static_cast<int16_t>(12))),
+      Constant(ValueFactory::GetBigIntValue(int64_t{1} << 40)),
+      Constant(ValueFactory::GetDecimalValue(2.5)),
+      Constant(ValueFactory::GetIntegerValue(0)),
+      Constant(ValueFactory::GetNullValueByType(TypeId::BIGINT)),
+  };
+  auto check = [&](const AbstractExpressionRef &expr) {
+    CompiledExpression compiled_expr{expr};
+    EXPECT_TRUE(compiled_expr.IsCompiled()) << expr->ToString();
+    // an empty batch, and more rows than a vector of lanes, so the kernels run both their wide loop and their tail
+    for (int num_rows : {0, 37}) {
+      auto batch = MakeNumericBatch(&schema, num_rows);
+      std::vector<Value> expected;
+      std::vector<Value> actual;
+      expr->EvaluateBatch(*batch, &expected);
+      compiled_expr.EvaluateBatch(*batch, &actual);
+      ASSERT_EQ(expected.size(), actual.size());
+      for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i].GetTypeId(), actual[i].GetTypeId());
+        EXPECT_EQ(expected[i].IsNull(), actual[i].IsNull()) << expr->ToString() << " row " << i;
+        if (!expected[i].IsNull()) {
+          EXPECT_EQ(CmpBool::CmpTrue, expected[i].CompareEquals(actual[i])) << expr->ToString() << " row " << i;
+        }
+      }
+    }
+  };
+
+  for (uint32_t col_idx = 0; col_idx < types.size(); col_idx++) {
+    check(ColumnRef(col_idx, types[col_idx]));
+  }
+  for (auto type : {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan,
+                    ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual}) {
+    // every pair of columns, each column against every constant, and constants on the left
+    for (uint32_t lhs = 0; lhs < types.size(); lhs++) {
+      for (uint32_t rhs = 0; rhs < types.size(); rhs++) {
+        check(Compare(ColumnRef(lhs, types[lhs]), ColumnRef(rhs, types[rhs]), type));
+      }
+      for (const auto &constant : constants) {
+        check(Compare(ColumnRef(lhs, types[lhs]), constant, type));
+        check(Compare(constant, ColumnRef(lhs, types[lhs]), type));
+      }
+    }
+  }
+
+  // and/or over comparisons of different widths
+  auto big = Compare(ColumnRef(2, TypeId::BIGINT), constants[2], ComparisonType::GreaterThanOrEqual);
+  auto small = Compare(constants[3], ColumnRef(0, TypeId::TINYINT), ComparisonType::GreaterThan);
+  check(Logic(big, small, LogicType::And));
+  check(Logic(big, small, LogicType::Or));
+}
+
+// NOLINTNEXTLINE
+TEST(CompiledExpressionTest, FallbackTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}, Column{"c", TypeId::VARCHAR, 8}}};
+
+  // varchar columns are not compiled, and neither is anything above them
+  auto c_short = Compare(ColumnRef(2, TypeId::VARCHAR), Constant(ValueFactory::GetVarcharValue("xx")),
+                         ComparisonType::LessThan);
+  ExpectSameAsTree(c_short, schema, false);
+  auto a_less_b = Compare(ColumnRef(0), ColumnRef(1), ComparisonType::LessThan);
+  ExpectSameAsTree(Logic(c_short, a_less_b, LogicType::And), schema, false);
+
+  // an empty expression keeps every row
+  CompiledExpression empty;
+  auto batch = MakeBatch(&schema, 12);
+  empty.Filter(batch.get());
+  EXPECT_EQ(12, batch->Size());
+}
+
+}  // namespace bustub
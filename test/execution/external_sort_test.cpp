@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort_test.cpp
+//
+// Identification: test/execution/external_sort_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/sort_key.h"
+#include "type/value_factory.h"
+#include "gtest/gtest.h"
+#include "spill_test_util.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExternalSortTest, SpillTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t1 (x int, y int, z varchar(32));", writer);
+
+  // x is a permutation of 0..4999, y has many duplicates
+  constexpr int num_rows = 5000;
+  std::string insert = "INSERT INTO t1 VALUES ";
+  for (int i = 0; i < num_rows; i++) {
+    int x = (i * 7919) % num_rows;
+    insert += fmt::format("{}({}, {}, 'row {}')", i == 0 ? "" : ", ", x, x % 13, x);
+  }
+  bustub->ExecuteSql(insert, writer);
+
+  const std::vector<std::string> queries = {
+      "SELECT x, z FROM t1 ORDER BY x;",
+      "SELECT x, y FROM t1 ORDER BY y DESC, x;",
+      "SELECT y, z FROM t1 WHERE x < 1000 ORDER BY z DESC;",
+  };
+
+  // The input takes about 500 KB in memory: ten runs at 48 KB merged at once. More than a hundred runs at 4 KB, and one
+  // batch per run at 1 byte, are merged two at a time in several passes
+  auto in_memory = ExpectSameResultsWhenSpilling(bustub.get(), queries, {48 * 1024, 4 * 1024, 1});
+  std::string expected;
+  for (int x = 0; x < num_rows; x++) {
+    expected += fmt::format("{},row {},\n", x, x);
+  }
+  EXPECT_EQ(expected, in_memory[0]);
+}
+
+// NOLINTNEXTLINE
+TEST(ExternalSortTest, SortKeyTest) {
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT}, Column{"c", TypeId::DECIMAL},
+                 Column{"d", TypeId::VARCHAR, 64}});
+  const std::string prefix = "a common prefix longer than the sort key";
+  std::vector<std::vector<Value>> rows{
+      {ValueFactory::GetIntegerValue(1), ValueFactory::GetBigIntValue(-5), ValueFactory::GetDecimalValue(2.5),
+       ValueFactory::GetVarcharValue(prefix + ", then x")},
+      {ValueFactory::GetIntegerValue(-1), ValueFactory::GetBigIntValue(5), ValueFactory::GetDecimalValue(-2.5),
+       ValueFactory::GetVarcharValue(prefix + ", then y")},
+      {ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetNullValueByType(TypeId::BIGINT),
+       ValueFactory::GetNullValueByType(TypeId::DECIMAL), ValueFactory::GetNullValueByType(TypeId::VARCHAR)},
+      {ValueFactory::GetIntegerValue(0), ValueFactory::GetBigIntValue(-9223372036854775807),
+       ValueFactory::GetDecimalValue(-0.5), ValueFactory::GetVarcharValue(prefix)},
+      {ValueFactory::GetIntegerValue(-2147483647), ValueFactory::GetBigIntValue(0), ValueFactory::GetDecimalValue(0.0),
+       ValueFactory::GetVarcharValue("")},
+      {ValueFactory::GetIntegerValue(2147483647), ValueFactory::GetBigIntValue(9223372036854775807),
+       ValueFactory::GetDecimalValue(-100.25), ValueFactory::GetVarcharValue("b")},
+  };
+  std::vector<Tuple> tuples;
+  for (const auto &row : rows) {
+    tuples.emplace_back(row, &schema);
+  }
+
+  auto column = [&](uint32_t col_idx) {
+    return std::make_shared<ColumnValueExpression>(0, col_idx, schema.GetColumn(col_idx).GetType());
+  };
+  auto sorted = [&](const std::vector<SortKeyNormalizer::OrderBy> &order_bys) {
+    SortKeyNormalizer normalizer(order_bys, &schema);
+    std::vector<SortKey> keys(tuples.size());
+    for (size_t i = 0; i < tuples.size(); i++) {
+      normalizer.Encode(tuples[i], static_cast<uint32_t>(i), &keys[i]);
+    }
+    std::sort(keys.begin(), keys.end(), [&](const SortKey &a, const SortKey &b) {
+      return normalizer.Less(a, tuples[a.row_idx_], b, tuples[b.row_idx_]);
+    });
+    std::vector<uint32_t> order;
+    for (const auto &key : keys) {
+      order.push_back(key.row_idx_);
+    }
+    return order;
+  };
+
+  // NULL sorts before any value, i.e. first for ASC and last for DESC
+  EXPECT_EQ((std::vector<uint32_t>{2, 4, 1, 3, 0, 5}), sorted({{OrderByType::ASC, column(0)}}));
+  EXPECT_EQ((std::vector<uint32_t>{5, 1, 4, 0, 3, 2}), sorted({{OrderByType::DESC, column(1)}}));
+  EXPECT_EQ((std::vector<uint32_t>{2, 5, 1, 3, 4, 0}), sorted({{OrderByType::DEFAULT, column(2)}}));
+  // strings equal on the whole prefix are told apart on their full value
+  EXPECT_EQ((std::vector<uint32_t>{5, 1, 0, 3, 4, 2}), sorted({{OrderByType::DESC, column(3)}}));
+  // keys past the prefix are compared on the full rows
+  for (double c : {1.5, 3.5}) {
+    tuples.emplace_back(std::vector<Value>{rows[0][0], rows[0][1], ValueFactory::GetDecimalValue(c), rows[0][3]},
+                        &schema);
+  }
+  EXPECT_EQ((std::vector<uint32_t>{5, 1, 4, 6, 0, 7, 3, 2}),
+            sorted({{OrderByType::DESC, column(1)},
+                    {OrderByType::DESC, column(1)},
+                    {OrderByType::DESC, column(1)},
+                    {OrderByType::ASC, column(2)}}));
+}
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_spill_test.cpp
+//
+// Identification: test/execution/hash_join_spill_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "spill_test_util.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HashJoinSpillTest, SpillTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t1 (x int, y varchar(32));", writer);
+  bustub->ExecuteSql("CREATE TABLE t2 (x int, z varchar(32));", writer);
+
+  // t2 has two rows for even keys and none for multiples of 7, t1 has keys t2 lacks
+  std::string insert1 = "INSERT INTO t1 VALUES ";
+  std::string insert2 = "INSERT INTO t2 VALUES ";
+  for (int i = 0; i < 4000; i++) {
+    insert1 += fmt::format("{}({}, 'left {}')", i == 0 ? "" : ", ", i, i);
+    if (i % 7 != 0) {
+      insert2 += fmt::format("{}({}, 'right {}')", i == 1 ? "" : ", ", i, i);
+      if (i % 2 == 0) {
+        insert2 += fmt::format(", ({}, 'again {}')", i, i);
+      }
+    }
+  }
+  bustub->ExecuteSql(insert1, writer);
+  bustub->ExecuteSql(insert2, writer);
+
+  const std::vector<std::string> queries = {
+      "SELECT count(*), sum(t1.x), min(t2.x), max(t2.x) FROM t1 INNER JOIN t2 ON t1.x = t2.x;",
+      "SELECT count(*), count(t2.x), sum(t1.x) FROM t1 LEFT JOIN t2 ON t1.x = t2.x;",
+      "SELECT t1.x, t1.y, t2.z FROM t1 INNER JOIN t2 ON t1.x = t2.x WHERE t1.x > 3980 ORDER BY t2.z;",
+      "SELECT t1.x, t2.x FROM t1 LEFT JOIN t2 ON t1.x = t2.x WHERE t1.x < 30 ORDER BY t1.x, t2.x;",
+  };
+
+  // The build side takes about 1 MB in memory. At 64 KB it spills but partition 0 stays in memory, at 1 KB partition 0
+  // spills as well. t2 spans several morsels and is built by a parallel pipeline: with one worker a round is two
+  // morsels and the rest of the table goes through the serial build once the first round crosses the limit, with four
+  // workers the whole table is a single round
+  for (size_t num_workers : {1, 4}) {
+    bustub->SetNumWorkers(num_workers);
+    auto in_memory = ExpectSameResultsWhenSpilling(bustub.get(), queries, {64 * 1024, 1024});
+    EXPECT_EQ(fmt::format("{},", 3428 + 1714), in_memory[0].substr(0, 5));
+  }
+}
+
+}  // namespace bustub
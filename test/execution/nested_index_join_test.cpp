@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// nested_index_join_test.cpp
+//
+// Identification: test/execution/nested_index_join_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "query_test_util.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(NestedIndexJoinTest, BatchedProbeTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t1 (x int, y varchar(32));", writer);
+  bustub->ExecuteSql("CREATE TABLE t2 (x int, z varchar(32));", writer);
+  bustub->ExecuteSql("CREATE INDEX t2_x ON t2(x);", writer);
+
+  // The inner side has the even keys, inserted out of order so that key order is not RID order. The outer side takes
+  // three batches, with every key twice and keys the inner side lacks.
+  std::string insert2 = "INSERT INTO t2 VALUES ";
+  for (int i = 0; i < 2000; i++) {
+    int x = (i * 1237) % 2000 * 2;
+    insert2 += fmt::format("{}({}, 'right {}')", i == 0 ? "" : ", ", x, x);
+  }
+  std::string insert1 = "INSERT INTO t1 VALUES ";
+  for (int i = 0; i < 2600; i++) {
+    int x = (i * 17) % 1300;
+    insert1 += fmt::format("{}({}, 'left {}')", i == 0 ? "" : ", ", x, i);
+  }
+  bustub->ExecuteSql(insert2, writer);
+  bustub->ExecuteSql(insert1, writer);
+
+  std::stringstream plan;
+  auto plan_writer = SimpleStreamWriter(plan, true, ",");
+  bustub->ExecuteSql("EXPLAIN (o) SELECT * FROM t1 INNER JOIN t2 ON t1.x = t2.x;", plan_writer);
+  ASSERT_NE(std::string::npos, plan.str().find("NestedIndexJoin")) << plan.str();
+
+  // every outer row is joined in outer order, odd keys only join in a LEFT join
+  std::string inner_expected;
+  std::string left_expected;
+  for (int i = 0; i < 2600; i++) {
+    int x = (i * 17) % 1300;
+    if (x % 2 == 0) {
+      inner_expected += fmt::format("{},left {},{},right {},\n", x, i, x, x);
+      left_expected += fmt::format("{},left {},{},right {},\n", x, i, x, x);
+    } else {
+      left_expected += fmt::format("{},left {},integer_null,varlen_null,\n", x, i);
+    }
+  }
+  EXPECT_EQ(inner_expected, Query(bustub.get(), "SELECT * FROM t1 INNER JOIN t2 ON t1.x = t2.x;"));
+  EXPECT_EQ(left_expected, Query(bustub.get(), "SELECT * FROM t1 LEFT JOIN t2 ON t1.x = t2.x;"));
+
+  // deleted inner rows are gone from the index and the heap
+  bustub->ExecuteSql("DELETE FROM t2 WHERE x < 1000;", writer);
+  EXPECT_EQ("300,\n", Query(bustub.get(), "SELECT count(*) FROM t1 INNER JOIN t2 ON t1.x = t2.x;"));
+  EXPECT_EQ("2600,300,\n", Query(bustub.get(), "SELECT count(*), count(t2.x) FROM t1 LEFT JOIN t2 ON t1.x = t2.x;"));
+}
+
+}  // namespace bustub
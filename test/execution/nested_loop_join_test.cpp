@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// nested_loop_join_test.cpp
+//
+// Identification: test/execution/nested_loop_join_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "query_test_util.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(NestedLoopJoinTest, BlockJoinTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t1 (x int, y varchar(32));", writer);
+  bustub->ExecuteSql("CREATE TABLE t2 (x int, z varchar(32));", writer);
+  bustub->ExecuteSql("CREATE TABLE t3 (x int);", writer);
+
+  // The right side takes three chunks
+  std::string insert1 = "INSERT INTO t1 VALUES ";
+  for (int i = 0; i < 300; i++) {
+    insert1 += fmt::format("{}({}, 'left {}')", i == 0 ? "" : ", ", i, i);
+  }
+  std::string insert2 = "INSERT INTO t2 VALUES ";
+  for (int i = 0; i < 2500; i++) {
+    insert2 += fmt::format("{}({}, 'right {}')", i == 0 ? "" : ", ", i, i);
+  }
+  bustub->ExecuteSql(insert1, writer);
+  bustub->ExecuteSql(insert2, writer);
+
+  // every left row x matches x+1..x+3
+  EXPECT_EQ(
+      "900,136350,\n",
+      Query(bustub.get(), "SELECT count(*), sum(t2.x) FROM t1 INNER JOIN t2 ON t1.x < t2.x AND t2.x <= t1.x + 3;"));
+  // left rows below 99 match 99-x rows of the last chunk, the others get NULLs
+  EXPECT_EQ("5151,4950,\n",
+            Query(bustub.get(), "SELECT count(*), count(t2.x) FROM t1 LEFT JOIN t2 ON t2.x > t1.x + 2400;"));
+  EXPECT_EQ("98,left 98,2499,right 2499,\n99,left 99,integer_null,varlen_null,\n",
+            Query(bustub.get(),
+                  "SELECT t1.x, t1.y, t2.x, t2.z FROM t1 LEFT JOIN t2 ON t2.x > t1.x + 2400 "
+                  "WHERE t1.x >= 98 AND t1.x < 100 ORDER BY t1.x;"));
+  // an empty right side still yields every left row of a LEFT join, in order
+  EXPECT_EQ("0,integer_null,\n1,integer_null,\n2,integer_null,\n",
+            Query(bustub.get(), "SELECT t1.x, t3.x FROM t1 LEFT JOIN t3 ON t1.x < t3.x WHERE t1.x < 3;"));
+  EXPECT_EQ("", Query(bustub.get(), "SELECT t1.x, t3.x FROM t1 INNER JOIN t3 ON t1.x < t3.x;"));
+}
+
+}  // namespace bustub
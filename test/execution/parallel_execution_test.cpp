@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_execution_test.cpp
+//
+// Identification: test/execution/parallel_execution_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/parallel_sort.h"
+#include "execution/task_scheduler.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr int NUM_ROWS = 6000;
+
+/** Run a query in its own transaction and return the rows, one line per row */
+auto Query(BustubInstance *bustub, const std::string &sql, IsolationLevel isolation_level) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, ",");
+  auto *txn = bustub->txn_manager_->Begin(nullptr, isolation_level);
+  bustub->ExecuteSqlTxn(sql, writer, txn);
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+  return ss.str();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ParallelExecutionTest, ParallelForTest) {
+  TaskScheduler scheduler(4);
+  ASSERT_EQ(4, scheduler.NumWorkers());
+
+  // every task runs exactly once, on a valid worker
+  std::vector<std::atomic<int>> runs(1000);
+  std::atomic<bool> bad_worker{false};
+  scheduler.ParallelFor(runs.size(), [&](size_t worker_id, size_t task_idx) {
+    if (worker_id >= scheduler.NumWorkers()) {
+      bad_worker = true;
+    }
+    runs[task_idx]++;
+  });
+  EXPECT_FALSE(bad_worker);
+  for (auto &run : runs) {
+    EXPECT_EQ(1, run.load());
+  }
+
+  // a failing task does not stop the others, its exception reaches the caller
+  std::atomic<int> finished{0};
+  EXPECT_THROW(scheduler.ParallelFor(100,
+                                     [&](size_t worker_id, size_t task_idx) {
+                                       if (task_idx == 42) {
+                                         throw std::runtime_error("task failed");
+                                       }
+                                       finished++;
+                                     }),
+               std::runtime_error);
+  EXPECT_EQ(99, finished.load());
+
+  scheduler.ParallelFor(0, [](size_t worker_id, size_t task_idx) { FAIL(); });
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelExecutionTest, ParallelSortTest) {
+  TaskScheduler scheduler(4);
+
+  // many duplicates, including runs of the same value longer than a bucket, and a descending order
+  std::vector<int> items;
+  for (int i = 0; i < 100000; i++) {
+    items.push_back(i < 30000 ? 7 : (i * 7919) % 1000);
+  }
+  auto expected = items;
+  std::sort(expected.begin(), expected.end(), std::greater<>());
+  ParallelSort(&scheduler, &items, std::greater<>());
+  EXPECT_EQ(expected, items);
+
+  // small inputs and no scheduler sort on the calling thread
+  std::vector<int> small{3, 1, 2};
+  ParallelSort(&scheduler, &small, std::less<>());
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), small);
+  ParallelSort(nullptr, &items, std::less<>());
+  EXPECT_TRUE(std::is_sorted(items.begin(), items.end()));
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelExecutionTest, PipelineTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->GenerateMockTable();
+  bustub->ExecuteSql("CREATE TABLE t1 (x int, y int);", writer);
+  bustub->ExecuteSql("CREATE TABLE t2 (x int, z int);", writer);
+
+  // t1 spans many morsels, t2 fits in one and is built serially
+  std::string insert = "INSERT INTO t1 VALUES ";
+  for (int i = 0; i < NUM_ROWS; i++) {
+    insert += fmt::format("{}({}, {})", i == 0 ? "" : ", ", i, i % 10);
+  }
+  bustub->ExecuteSql(insert, writer);
+  bustub->ExecuteSql("INSERT INTO t2 VALUES (1, 100), (2, 200), (5000, 300), (7000, 400);", writer);
+
+  for (auto isolation_level : {IsolationLevel::READ_UNCOMMITTED, IsolationLevel::READ_COMMITTED,
+                               IsolationLevel::REPEATABLE_READ}) {
+    auto *b = bustub.get();
+    EXPECT_EQ(fmt::format("{},{},0,{},{},\n", NUM_ROWS, NUM_ROWS * (NUM_ROWS - 1) / 2, NUM_ROWS - 1, NUM_ROWS * 9 / 2),
+              Query(b, "SELECT count(*), sum(x), min(x), max(x), sum(y) FROM t1;", isolation_level));
+
+    std::string expected;
+    for (int y = 0; y < 10; y++) {
+      expected += fmt::format("{},{},\n", y, NUM_ROWS / 10);
+    }
+    EXPECT_EQ(expected, Query(b, "SELECT y, count(*) FROM t1 GROUP BY y ORDER BY y;", isolation_level));
+
+    // filter and projection below the aggregation
+    EXPECT_EQ("3,\n", Query(b, "SELECT count(*) FROM (SELECT x + 1 AS v FROM t1 WHERE y = 3) WHERE v < 30;",
+                            isolation_level));
+
+    // parallel build side of a hash join, and a self-join that runs both sides in parallel
+    EXPECT_EQ("1,100,\n2,200,\n5000,300,\n",
+              Query(b, "SELECT t2.x, t2.z FROM t2 INNER JOIN t1 ON t2.x = t1.x ORDER BY t2.x;", isolation_level));
+    EXPECT_EQ(fmt::format("{},\n", NUM_ROWS),
+              Query(b, "SELECT count(*) FROM t1 a INNER JOIN t1 b ON a.x = b.x;", isolation_level));
+
+    // parallel probe side, in table order and cut short by a limit
+    EXPECT_EQ(fmt::format("{},3,\n", NUM_ROWS),
+              Query(b, "SELECT count(*), count(t2.z) FROM t1 LEFT JOIN t2 ON t1.x = t2.x;", isolation_level));
+    EXPECT_EQ("0,integer_null,\n1,100,\n2,200,\n",
+              Query(b, "SELECT t1.x, t2.z FROM t1 LEFT JOIN t2 ON t1.x = t2.x LIMIT 3;", isolation_level));
+    EXPECT_EQ(fmt::format("{},{},\n", NUM_ROWS / 10, NUM_ROWS / 10 * 7),
+              Query(b, "SELECT count(*), sum(b.y) FROM t1 a INNER JOIN t1 b ON a.x = b.x WHERE a.y = 7;",
+                    isolation_level));
+  }
+
+  // both sides of the join are mock scans split into morsels
+  EXPECT_EQ("10000,45000,\n",
+            Query(bustub.get(),
+                  "SELECT count(*), sum(b.v4) FROM __mock_agg_input_big a INNER JOIN __mock_agg_input_big b "
+                  "ON a.v2 = b.v2;",
+                  IsolationLevel::REPEATABLE_READ));
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelExecutionTest, AggregationTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto writer = NoopWriter();
+  bustub->GenerateMockTable();
+  bustub->ExecuteSql("CREATE TABLE t1 (x int, y int);", writer);
+  std::string insert = "INSERT INTO t1 VALUES ";
+  for (int i = 0; i < NUM_ROWS; i++) {
+    insert += fmt::format("{}({}, {})", i == 0 ? "" : ", ", i % (NUM_ROWS - 1000), i);
+  }
+  bustub->ExecuteSql(insert, writer);
+
+  // enough groups for the merge to be partitioned, over a table and over a mock scan
+  const std::string queries[] = {
+      "SELECT x, count(*), sum(y), min(y), max(y) FROM t1 GROUP BY x ORDER BY x;",
+      "SELECT count(*), sum(y) FROM t1 WHERE x > 100;",
+      "SELECT v2, count(*), max(v1) FROM __mock_agg_input_big GROUP BY v2 ORDER BY v2 DESC LIMIT 5;",
+  };
+  std::string serial[3];
+  for (int i = 0; i < 3; i++) {
+    serial[i] = Query(bustub.get(), queries[i], IsolationLevel::REPEATABLE_READ);
+  }
+  EXPECT_EQ("0,2,5000,0,5000,\n", serial[0].substr(0, serial[0].find('\n') + 1));
+
+  bustub->SetNumWorkers(4);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(serial[i], Query(bustub.get(), queries[i], IsolationLevel::REPEATABLE_READ)) << queries[i];
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rid_bitmap_test.cpp
+//
+// Identification: test/execution/rid_bitmap_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "execution/rid_bitmap.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(RidBitmapTest, RidsComeOutInPageOrder) {
+  RidBitmap bitmap;
+  bitmap.Set(RID{7, 3});
+  bitmap.Set(RID{2, 9});
+  bitmap.Set(RID{7, 0});
+  bitmap.Set(RID{2, 9});
+  bitmap.Set(RID{2, RidBitmap::SLOTS_PER_PAGE - 1});
+
+  std::vector<RID> expected{RID{2, 9}, RID{2, RidBitmap::SLOTS_PER_PAGE - 1}, RID{7, 0}, RID{7, 3}};
+  ASSERT_EQ(bitmap.ToRids(), expected);
+  ASSERT_EQ(bitmap.NumPages(), 2);
+}
+
+TEST(RidBitmapTest, IntersectAndUnion) {
+  RidBitmap a;
+  RidBitmap b;
+  for (uint32_t slot = 0; slot < 10; slot++) {
+    a.Set(RID{1, slot});
+    b.Set(RID{1, slot + 5});
+  }
+  a.Set(RID{3, 0});
+  b.Set(RID{4, 0});
+
+  RidBitmap both = a;
+  both.IntersectWith(b);
+  std::vector<RID> expected;
+  for (uint32_t slot = 5; slot < 10; slot++) {
+    expected.emplace_back(1, slot);
+  }
+  ASSERT_EQ(both.ToRids(), expected);
+  // Pages left without a RID are dropped
+  ASSERT_EQ(both.NumPages(), 1);
+
+  RidBitmap either = a;
+  either.UnionWith(b);
+  expected.clear();
+  for (uint32_t slot = 0; slot < 15; slot++) {
+    expected.emplace_back(1, slot);
+  }
+  expected.emplace_back(3, 0);
+  expected.emplace_back(4, 0);
+  ASSERT_EQ(either.ToRids(), expected);
+
+  RidBitmap none;
+  none.IntersectWith(a);
+  ASSERT_TRUE(none.ToRids().empty());
+}
+
+}  // namespace bustub
@@ -0,0 +1,256 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch_test.cpp
+//
+// Identification: test/execution/tuple_batch_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/tuple_batch.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple_arena.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeBatch(const Schema *schema, int num_rows) -> std::unique_ptr<TupleBatch> {
+  auto batch = std::make_unique<TupleBatch>(num_rows);
+  batch->Reset(schema);
+  for (int i = 0; i < num_rows; i++) {
+    // every third row has a NULL in the second column
+    auto b = i % 3 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i * 10);
+    batch->Append(Tuple{{ValueFactory::GetIntegerValue(i), b}, schema}, RID{0, static_cast<uint32_t>(i)});
+  }
+  return batch;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, SelectTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+  auto batch = MakeBatch(&schema, 10);
+  EXPECT_TRUE(batch->IsFull());
+  EXPECT_EQ(10, batch->Size());
+
+  // decode one column before the selection, the other one after it
+  const auto &a = batch->GetColumn(0);
+  ASSERT_EQ(10, a.size());
+  EXPECT_EQ(7, a[7].GetAs<int32_t>());
+
+  std::vector<Value> predicate;
+  for (int i = 0; i < 10; i++) {
+    predicate.push_back(i == 5 ? ValueFactory::GetNullValueByType(TypeId::BOOLEAN)
+                               : ValueFactory::GetBooleanValue(i % 2 == 1));
+  }
+  batch->Select(predicate);
+  ASSERT_EQ(4, batch->Size());
+  std::vector<int32_t> expected{1, 3, 7, 9};
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i], batch->GetColumn(0)[i].GetAs<int32_t>());
+    const auto &b = batch->GetColumn(1)[i];
+    EXPECT_EQ(expected[i] % 3 == 0, b.IsNull());
+    if (!b.IsNull()) {
+      EXPECT_EQ(expected[i] * 10, b.GetAs<int32_t>());
+    }
+    EXPECT_EQ(expected[i], batch->GetTuple(i).GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(static_cast<uint32_t>(expected[i]), batch->GetRID(i).GetSlotNum());
+  }
+
+  batch->Truncate(2);
+  EXPECT_EQ(2, batch->Size());
+  EXPECT_EQ(2, batch->GetColumn(1).size());
+
+  batch->Reset(&schema);
+  EXPECT_TRUE(batch->IsEmpty());
+  EXPECT_TRUE(batch->GetColumn(0).empty());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, EvaluateBatchTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+  auto batch = MakeBatch(&schema, 30);
+
+  // (a + b > 100) or (a = 4), over columns with NULLs
+  auto col_a = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto col_b = std::make_shared<ColumnValueExpression>(0, 1, TypeId::INTEGER);
+  auto sum = std::make_shared<ArithmeticExpression>(col_a, col_b, ArithmeticType::Plus);
+  auto gt = std::make_shared<ComparisonExpression>(
+      sum, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(100)), ComparisonType::GreaterThan);
+  auto eq = std::make_shared<ComparisonExpression>(
+      col_a, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(4)), ComparisonType::Equal);
+  auto expr = std::make_shared<LogicExpression>(gt, eq, LogicType::Or);
+
+  // the batch evaluation of every node must agree with the row by row evaluation
+  for (const AbstractExpressionRef &e : std::vector<AbstractExpressionRef>{col_b, sum, gt, expr}) {
+    std::vector<Value> result;
+    e->EvaluateBatch(*batch, &result);
+    ASSERT_EQ(batch->Size(), result.size());
+    for (size_t i = 0; i < batch->Size(); i++) {
+      auto expected = e->Evaluate(&batch->GetTuple(i), schema);
+      EXPECT_EQ(expected.IsNull(), result[i].IsNull()) << e->ToString() << " row " << i;
+      if (!expected.IsNull()) {
+        EXPECT_EQ(CmpBool::CmpTrue, expected.CompareEquals(result[i])) << e->ToString() << " row " << i;
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, ReferenceTest) {
+  Schema left_schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+  Schema right_schema{{Column{"c", TypeId::INTEGER}, Column{"d", TypeId::VARCHAR, 8}}};
+  Schema join_schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}, Column{"c", TypeId::INTEGER},
+                      Column{"d", TypeId::VARCHAR, 8}}};
+  auto left = MakeBatch(&left_schema, 12);
+  TupleBatch right{3};
+  right.Reset(&right_schema);
+  for (int i = 0; i < 3; i++) {
+    right.Append(Tuple{{ValueFactory::GetIntegerValue(i + 100), ValueFactory::GetVarcharValue(std::string(i + 1, 'x'))},
+                       &right_schema},
+                 RID{});
+  }
+
+  // left row i is joined with right row i % 3, or with NULLs if i % 4 == 0
+  TupleBatch join{12};
+  join.ResetJoin(&join_schema, *left, &right_schema);
+  EXPECT_TRUE(join.IsReference());
+  for (size_t i = 0; i < 12; i++) {
+    join.AppendReference(*left, i, i % 4 == 0 ? nullptr : &right.GetTuple(i % 3));
+  }
+  auto check_row = [&](const TupleBatch &batch, size_t row_idx, int i) {
+    EXPECT_EQ(i, batch.GetColumn(0)[row_idx].GetAs<int32_t>());
+    EXPECT_EQ(i % 3 == 0, batch.GetColumn(1)[row_idx].IsNull());
+    EXPECT_EQ(i % 4 == 0, batch.GetColumn(2)[row_idx].IsNull());
+    EXPECT_EQ(i % 4 == 0, batch.GetColumnData(row_idx, 2) == nullptr);
+    const auto &tuple = batch.GetTuple(row_idx);
+    EXPECT_EQ(i, tuple.GetValue(&join_schema, 0).GetAs<int32_t>());
+    if (i % 4 == 0) {
+      EXPECT_TRUE(tuple.GetValue(&join_schema, 3).IsNull());
+    } else {
+      EXPECT_EQ(i % 3 + 100, tuple.GetValue(&join_schema, 2).GetAs<int32_t>());
+      EXPECT_EQ(std::string(i % 3 + 1, 'x'), tuple.GetValue(&join_schema, 3).ToString());
+    }
+  };
+  for (int i = 0; i < 12; i++) {
+    check_row(join, i, i);
+  }
+
+  // the references move with the rows they belong to, materialized or not
+  std::vector<uint8_t> keep(12);
+  for (size_t i = 0; i < 12; i++) {
+    keep[i] = static_cast<uint8_t>(i % 2 == 1);
+  }
+  join.Select(keep);
+  ASSERT_EQ(6, join.Size());
+  for (int i = 0; i < 6; i++) {
+    check_row(join, i, i * 2 + 1);
+  }
+
+  // a projection of the join refers to the same tuples, and keeps the RIDs of the rows it picks
+  Schema projection_schema{{Column{"d", TypeId::VARCHAR, 8}, Column{"a", TypeId::INTEGER}}};
+  TupleBatch projection{6};
+  projection.ResetProjection(&projection_schema, join, {3, 0});
+  for (size_t i = 0; i < join.Size(); i++) {
+    projection.AppendReference(join, i);
+  }
+  ASSERT_EQ(6, projection.Size());
+  for (int i = 0; i < 6; i++) {
+    int a = i * 2 + 1;
+    EXPECT_EQ(a, projection.GetColumn(1)[i].GetAs<int32_t>());
+    EXPECT_EQ(a % 4 == 0, projection.GetTuple(i).GetValue(&projection_schema, 0).IsNull());
+    EXPECT_EQ(join.GetRID(i), projection.GetRID(i));
+  }
+  auto plain = MakeBatch(&left_schema, 2);
+  projection.Reset(&left_schema);
+  EXPECT_FALSE(projection.IsReference());
+  projection.Append(plain->GetTuple(0), RID{});
+  EXPECT_EQ(0, projection.GetColumn(0)[0].GetAs<int32_t>());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, ArenaTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 64}}};
+  TupleBatch batch{100};
+  auto fill = [&](int round) {
+    batch.Reset(&schema);
+    for (int i = 0; i < 100; i++) {
+      batch.Append(std::vector<Value>{ValueFactory::GetIntegerValue(round * 100 + i),
+                                      ValueFactory::GetVarcharValue(std::string(i % 50, 'x'))},
+                   RID{0, static_cast<uint32_t>(i)});
+    }
+  };
+
+  // the rows live in the memory of the batch, a row taken out owns its data and outlives the batch being refilled
+  fill(0);
+  EXPECT_FALSE(batch.GetTuple(7).IsAllocated());
+  auto taken = batch.TakeTuple(7);
+  EXPECT_TRUE(taken.IsAllocated());
+  fill(1);
+  EXPECT_EQ(7, taken.GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_EQ(std::string(7, 'x'), taken.GetValue(&schema, 1).ToString());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(100 + i, batch.GetTuple(i).GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::string(i % 50, 'x'), batch.GetColumn(1)[i].ToString());
+  }
+
+  // copies of rows of another batch are kept in the memory of the batch as well
+  TupleBatch copy{100};
+  copy.Reset(&schema);
+  for (size_t i = 0; i < batch.Size(); i++) {
+    copy.Append(batch.GetTuple(i), batch.GetRID(i));
+  }
+  fill(2);
+  EXPECT_EQ(142, copy.GetTuple(42).GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_EQ(batch.GetRID(42), copy.GetRID(42));
+}
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, TupleArenaReuseTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 64}}};
+  TupleArena arena;
+  auto fill = [&](size_t num_tuples, size_t length) {
+    std::vector<Tuple> tuples;
+    for (size_t i = 0; i < num_tuples; i++) {
+      tuples.push_back(arena.Store({ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                                    ValueFactory::GetVarcharValue(std::string(length, 'y'))},
+                                   &schema));
+    }
+    for (size_t i = 0; i < num_tuples; i++) {
+      EXPECT_EQ(static_cast<int32_t>(i), tuples[i].GetValue(&schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(std::string(length, 'y'), tuples[i].GetValue(&schema, 1).ToString());
+    }
+  };
+
+  // refilling a rewound arena reuses its blocks
+  fill(5000, 20);
+  auto usage = arena.MemoryUsage();
+  EXPECT_GT(usage, 5000 * 20);
+  arena.Reset();
+  fill(5000, 20);
+  EXPECT_EQ(usage, arena.MemoryUsage());
+
+  // a tuple larger than the free blocks gets a new block in place of the next one
+  arena.Reset();
+  fill(1, TupleArena::MAX_BLOCK_SIZE + 1);
+  fill(3000, 10);
+  arena.Clear();
+  EXPECT_EQ(0, arena.MemoryUsage());
+}
+
+}  // namespace bustub
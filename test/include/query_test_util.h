@@ -0,0 +1,30 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// query_test_util.h
+//
+// Identification: test/include/query_test_util.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "common/bustub_instance.h"
+
+namespace bustub {
+
+/** @return the rows of a query, values separated by commas */
+inline auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, ",");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+}  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_test_util.h
+//
+// Identification: test/include/spill_test_util.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "query_test_util.h"
+#include "storage/table/tmp_tuple_file.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Sets execution_memory_limit for the lifetime of the guard and restores the previous limit afterwards. */
+class MemoryLimitGuard {
+ public:
+  explicit MemoryLimitGuard(size_t limit) : saved_limit_(execution_memory_limit) { execution_memory_limit = limit; }
+
+  ~MemoryLimitGuard() { execution_memory_limit = saved_limit_; }
+
+  DISALLOW_COPY_AND_MOVE(MemoryLimitGuard);
+
+ private:
+  size_t saved_limit_;
+};
+
+/**
+ * Run every query within the default memory budget, where it must not spill, and once more under each of the limits,
+ * where it must spill and still return the same rows.
+ * @return the rows of every query within the default budget
+ */
+inline auto ExpectSameResultsWhenSpilling(BustubInstance *bustub, const std::vector<std::string> &queries,
+                                          const std::vector<size_t> &limits) -> std::vector<std::string> {
+  std::vector<std::string> in_memory;
+  for (const auto &query : queries) {
+    size_t pages = TmpTupleFile::NumPagesAllocated();
+    in_memory.push_back(Query(bustub, query));
+    EXPECT_EQ(pages, TmpTupleFile::NumPagesAllocated()) << query << " spilled within the default limit";
+  }
+  for (size_t limit : limits) {
+    MemoryLimitGuard guard(limit);
+    for (size_t i = 0; i < queries.size(); i++) {
+      size_t pages = TmpTupleFile::NumPagesAllocated();
+      EXPECT_EQ(in_memory[i], Query(bustub, queries[i])) << queries[i] << " limit " << limit;
+      EXPECT_LT(pages, TmpTupleFile::NumPagesAllocated()) << queries[i] << " did not spill at limit " << limit;
+    }
+  }
+  return in_memory;
+}
+
+}  // namespace bustub
@@ -17,6 +17,7 @@
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "type/value.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 //===--------------------------------------------------------------------===//
@@ -95,4 +96,46 @@ TEST(TypeTests, TemplateTest) {
   BPlusTreePage<Value, Value> node;
   node.GetInfo(val1, val2);
 }
+
+// NOLINTNEXTLINE
+TEST(TypeTests, VarcharStorageTest) {
+  EXPECT_EQ(16, sizeof(Value));
+  auto short_str = ValueFactory::GetVarcharValue("abc");
+  auto long_str = ValueFactory::GetVarcharValue(std::string(40, 'x'));
+  EXPECT_EQ("abc", short_str.ToString());
+  EXPECT_EQ(std::string(40, 'x'), long_str.ToString());
+
+  // serialize both, then read them back as copies and as views
+  std::vector<char> storage(sizeof(uint32_t) + 41);
+  long_str.SerializeTo(storage.data());
+  Value copy = Value::DeserializeFrom(storage.data(), TypeId::VARCHAR);
+  Value view = Value::DeserializeViewFrom(storage.data(), TypeId::VARCHAR);
+  EXPECT_EQ(storage.data() + sizeof(uint32_t), view.GetData());
+  EXPECT_EQ(CmpBool::CmpTrue, view.CompareEquals(copy));
+
+  // a copy of a view does not see later changes to the storage, the view does
+  Value view_copy = view;
+  Value moved = std::move(view);
+  storage[sizeof(uint32_t)] = 'y';
+  EXPECT_EQ(std::string(40, 'x'), view_copy.ToString());
+  EXPECT_EQ(std::string(40, 'x'), copy.ToString());
+  EXPECT_EQ('y', moved.ToString()[0]);
+
+  short_str.SerializeTo(storage.data());
+  Value short_view = Value::DeserializeViewFrom(storage.data(), TypeId::VARCHAR);
+  storage[sizeof(uint32_t)] = 'z';
+  EXPECT_EQ("abc", short_view.ToString());
+
+  // moving an owned string hands over the buffer and leaves a NULL behind
+  const char *data = long_str.GetData();
+  Value stolen = std::move(long_str);
+  EXPECT_EQ(data, stolen.GetData());
+  EXPECT_TRUE(long_str.IsNull());  // NOLINT
+  long_str = short_str;
+  EXPECT_EQ("abc", long_str.ToString());
+  EXPECT_EQ(std::string(40, 'x'), stolen.ToString());
+
+  ValueFactory::GetNullValueByType(TypeId::VARCHAR).SerializeTo(storage.data());
+  EXPECT_TRUE(Value::DeserializeViewFrom(storage.data(), TypeId::VARCHAR).IsNull());
+}
 }  // namespace bustub
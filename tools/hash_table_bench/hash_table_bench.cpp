@@ -0,0 +1,85 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "container/hash/extendible_hash_table.h"
+#include "fmt/core.h"
+
+static const int BUSTUB_HASH_TABLE_BENCH_KEYS = 10000;
+static const int BUSTUB_HASH_TABLE_BENCH_OPS = 50000;
+
+/**
+ * A read-mostly workload over a prefilled extendible hash table, like the buffer pool page table sees: every tenth
+ * operation of a thread is an insert, the others are lookups. Reports the throughput for 1, 2, 4 and 8 threads.
+ */
+void RunBench(bustub::ExtendibleHashTable<int, int> *table, int num_keys, int ops_per_thread, int num_threads) {
+  std::atomic<int> misses{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, table, num_keys, ops_per_thread, &misses]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<int> dis(0, num_keys - 1);
+      for (int op = 0; op < ops_per_thread; op++) {
+        int key = dis(gen);
+        if (op % 10 == 0) {
+          // overwrite with the same value, so readers always see key == value
+          table->Insert(key, key);
+        } else {
+          int val;
+          if (!table->Find(key, val) || val != key) {
+            misses++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("threads={:<4} {:>14.0f} ops/s\n", num_threads, num_threads * ops_per_thread / elapsed);
+  if (misses.load() != 0) {
+    std::cerr << "warning: " << misses.load() << " lookups missed with " << num_threads << " threads" << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-hash-table-bench");
+  program.add_argument("--keys").help("number of keys the table is prefilled with");
+  program.add_argument("--ops").help("number of operations of each thread");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  int num_keys = BUSTUB_HASH_TABLE_BENCH_KEYS;
+  int ops_per_thread = BUSTUB_HASH_TABLE_BENCH_OPS;
+  if (program.present("--keys")) {
+    num_keys = std::stoi(program.get("--keys"));
+  }
+  if (program.present("--ops")) {
+    ops_per_thread = std::stoi(program.get("--ops"));
+  }
+
+  auto table = std::make_unique<bustub::ExtendibleHashTable<int, int>>(8);
+  for (int i = 0; i < num_keys; i++) {
+    table->Insert(i, i);
+  }
+  for (int num_threads : {1, 2, 4, 8}) {
+    RunBench(table.get(), num_keys, ops_per_thread, num_threads);
+  }
+
+  return 0;
+}
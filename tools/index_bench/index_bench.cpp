@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+
+using bustub::BufferPoolManagerInstance;
+using bustub::DiskManagerUnlimitedMemory;
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::RID;
+
+using BenchKey = GenericKey<8>;
+using BenchComparator = GenericComparator<8>;
+
+static const size_t BUSTUB_INDEX_BENCH_KEYS = 100000;
+static const size_t BUSTUB_INDEX_BENCH_FRAMES = 256;
+
+auto ClockMs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+auto MakeKey(int64_t k) -> BenchKey {
+  BenchKey key;
+  key.SetFromInteger(k);
+  return key;
+}
+
+void Report(const std::string &index, const std::string &op, size_t n, uint64_t elapsed_ms) {
+  auto ops_per_sec = n / static_cast<double>(std::max<uint64_t>(elapsed_ms, 1)) * 1000;
+  fmt::print("{:<12} {:<8} {:>10} ops {:>8} ms {:>14.0f} ops/s\n", index, op, n, elapsed_ms, ops_per_sec);
+}
+
+/**
+ * Runs random-order inserts followed by random point lookups (half hits, half misses) against one index.
+ * `Index` only needs Insert(key, rid) and GetValue(key, result), which hides the argument order of the
+ * B+ tree and hash table APIs.
+ */
+template <typename Index>
+void RunBench(const std::string &name, Index *index, const std::vector<int64_t> &keys) {
+  auto start = ClockMs();
+  for (auto k : keys) {
+    index->Insert(MakeKey(k), RID(k));
+  }
+  Report(name, "insert", keys.size(), ClockMs() - start);
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<size_t> dis(0, keys.size() * 2 - 1);
+  size_t hits = 0;
+  start = ClockMs();
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<RID> result;
+    auto k = static_cast<int64_t>(dis(gen));
+    hits += index->GetValue(MakeKey(k), &result) ? 1 : 0;
+  }
+  Report(name, "lookup", keys.size(), ClockMs() - start);
+  if (hits == 0) {
+    std::cerr << "warning: no lookup hit in " << name << std::endl;
+  }
+}
+
+struct BPlusTreeBench {
+  bustub::BPlusTree<BenchKey, RID, BenchComparator> tree_;
+  bustub::Transaction txn_{0};
+  auto Insert(const BenchKey &key, const RID &rid) -> bool { return tree_.Insert(key, rid, &txn_); }
+  auto GetValue(const BenchKey &key, std::vector<RID> *result) -> bool {
+    return tree_.GetValue(key, result, &txn_);
+  }
+};
+
+struct LinearProbeBench {
+  bustub::LinearProbeHashTable<BenchKey, RID, BenchComparator> table_;
+  auto Insert(const BenchKey &key, const RID &rid) -> bool { return table_.Insert(nullptr, key, rid); }
+  auto GetValue(const BenchKey &key, std::vector<RID> *result) -> bool {
+    return table_.GetValue(nullptr, key, result);
+  }
+};
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-index-bench");
+  program.add_argument("--keys").help("number of keys to insert and look up");
+  program.add_argument("--frames").help("number of buffer pool frames given to each index");
+  program.add_argument("--hash-initial-size").help("initial number of slots of the linear probe hash table");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_keys = BUSTUB_INDEX_BENCH_KEYS;
+  size_t num_frames = BUSTUB_INDEX_BENCH_FRAMES;
+  size_t hash_initial_size = bustub::HASH_INDEX_INITIAL_SIZE;
+  if (program.present("--keys")) {
+    num_keys = std::stoul(program.get("--keys"));
+  }
+  if (program.present("--frames")) {
+    num_frames = std::stoul(program.get("--frames"));
+  }
+  if (program.present("--hash-initial-size")) {
+    hash_initial_size = std::stoul(program.get("--hash-initial-size"));
+  }
+
+  // even keys are inserted, so that odd keys in the lookup range are misses
+  std::vector<int64_t> keys(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    keys[i] = static_cast<int64_t>(i * 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937_64(0));
+
+  bustub::Schema key_schema({bustub::Column("a", bustub::TypeId::BIGINT)});
+  BenchComparator comparator(&key_schema);
+
+  {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(num_frames, disk_manager.get());
+    bustub::page_id_t header_page_id;
+    bpm->NewPage(&header_page_id);
+    BPlusTreeBench bench{bustub::BPlusTree<BenchKey, RID, BenchComparator>("bench", bpm.get(), comparator)};
+    RunBench("b_plus_tree", &bench, keys);
+    bpm->UnpinPage(header_page_id, true);
+  }
+
+  {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(num_frames, disk_manager.get());
+    LinearProbeBench bench{bustub::LinearProbeHashTable<BenchKey, RID, BenchComparator>(
+        "bench", bpm.get(), comparator, hash_initial_size, bustub::HashFunction<BenchKey>())};
+    RunBench("linear_probe", &bench, keys);
+  }
+
+  return 0;
+}
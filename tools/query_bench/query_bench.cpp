@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/bustub_instance.h"
+#include "fmt/core.h"
+
+static const size_t BUSTUB_QUERY_BENCH_RUNS = 10;
+static const size_t BUSTUB_QUERY_BENCH_COPIES = 5;
+
+/** Calls of the global operator new, which backs tuples, values, strings and containers. */
+static std::atomic<size_t> num_allocations{0};
+
+// NOLINTNEXTLINE
+void *operator new(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {  // NOLINT
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// NOLINTNEXTLINE
+void *operator new[](size_t size) { return operator new(size); }
+
+// NOLINTNEXTLINE
+void operator delete(void *ptr) noexcept { std::free(ptr); }  // NOLINT
+
+// NOLINTNEXTLINE
+void operator delete[](void *ptr) noexcept { std::free(ptr); }  // NOLINT
+
+// NOLINTNEXTLINE
+void operator delete(void *ptr, size_t size) noexcept { std::free(ptr); }  // NOLINT
+
+// NOLINTNEXTLINE
+void operator delete[](void *ptr, size_t size) noexcept { std::free(ptr); }  // NOLINT
+
+auto ClockUs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Execute(bustub::BustubInstance *bustub, const std::string &sql) {
+  bustub::NoopWriter writer;
+  if (!bustub->ExecuteSql(sql, writer)) {
+    std::cerr << "failed: " << sql << std::endl;
+    std::exit(1);
+  }
+}
+
+/**
+ * Runs one query `runs` times and reports the allocations and the median wall time of a run. Every run allocates
+ * the same, so the allocations of the last run are reported.
+ */
+auto RunQuery(bustub::BustubInstance *bustub, const std::string &name, const std::string &sql, size_t runs)
+    -> size_t {
+  std::vector<uint64_t> elapsed_us;
+  size_t allocations = 0;
+  for (size_t i = 0; i < runs; i++) {
+    auto start_allocations = num_allocations.load(std::memory_order_relaxed);
+    auto start = ClockUs();
+    Execute(bustub, sql);
+    elapsed_us.push_back(ClockUs() - start);
+    allocations = num_allocations.load(std::memory_order_relaxed) - start_allocations;
+  }
+  std::sort(elapsed_us.begin(), elapsed_us.end());
+  fmt::print("{:<20} {:>10} allocs {:>10.2f} ms\n", name, allocations, elapsed_us[runs / 2] / 1000.0);
+  return allocations;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-query-bench");
+  program.add_argument("--runs").help("number of runs of each query, of which the median time is reported");
+  program.add_argument("--copies").help("number of copies of __mock_t3_1k in the benchmark table");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t runs = BUSTUB_QUERY_BENCH_RUNS;
+  size_t copies = BUSTUB_QUERY_BENCH_COPIES;
+  if (program.present("--runs")) {
+    runs = std::max<size_t>(std::stoul(program.get("--runs")), 1);
+  }
+  if (program.present("--copies")) {
+    copies = std::stoul(program.get("--copies"));
+  }
+
+  auto bustub = std::make_unique<bustub::BustubInstance>();
+  bustub->GenerateMockTable();
+  Execute(bustub.get(), "CREATE TABLE t(x int, y int);");
+  for (size_t i = 0; i < copies; i++) {
+    Execute(bustub.get(), "INSERT INTO t SELECT * FROM __mock_t3_1k;");
+  }
+  // 50 distinct short names and 37 distinct descriptions too long to be kept inline
+  Execute(bustub.get(), "CREATE TABLE v(id int, name varchar(16), descr varchar(64));");
+  for (size_t i = 0; i < copies * 1000; i += 100) {
+    std::string sql = "INSERT INTO v VALUES ";
+    for (size_t id = i; id < i + 100; id++) {
+      sql += fmt::format("{}({}, 'n{}', 'a rather long description number {} of the row')", id == i ? "" : ", ", id,
+                         id % 50, id % 37);
+    }
+    Execute(bustub.get(), sql + ";");
+  }
+
+  // name, query
+  std::vector<std::pair<std::string, std::string>> queries = {
+      {"filter_agg", "SELECT count(*), max(y) FROM t WHERE x > 1000;"},
+      {"self_join_agg", "SELECT count(*), max(a.y) FROM t a INNER JOIN t b ON a.x = b.x;"},
+      {"join", "SELECT a.x, b.y FROM t a INNER JOIN __mock_t3_1k b ON a.x = b.x;"},
+      {"sort", "SELECT x, y FROM t WHERE x < 50000 ORDER BY y DESC;"},
+      {"varchar_group", "SELECT name, count(*) FROM v GROUP BY name;"},
+      {"varchar_group_long", "SELECT descr, count(*) FROM v GROUP BY descr;"},
+      {"varchar_join_agg", "SELECT count(*), max(a.id) FROM v a INNER JOIN v b ON a.name = b.name;"},
+      {"varchar_sort", "SELECT id, descr FROM v ORDER BY descr, id;"},
+  };
+
+  size_t total = 0;
+  for (const auto &[name, sql] : queries) {
+    total += RunQuery(bustub.get(), name, sql, runs);
+  }
+  fmt::print("{:<20} {:>10} allocs\n", "total", total);
+
+  return 0;
+}
@@ -73,6 +73,16 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
           fmt::print("IndexScan not found\n");
           return false;
         }
+      } else if (opt == "ensure:index_only_scan") {
+        if (!bustub::StringUtil::Contains(result.str(), "IndexOnlyScan")) {
+          fmt::print("IndexOnlyScan not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:bitmap_heap_scan") {
+        if (!bustub::StringUtil::Contains(result.str(), "BitmapHeapScan")) {
+          fmt::print("BitmapHeapScan not found\n");
+          return false;
+        }
       } else if (opt == "ensure:topn") {
         if (!bustub::StringUtil::Contains(result.str(), "TopN")) {
           fmt::print("TopN not found\n");
@@ -88,6 +98,16 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
           fmt::print("NestedIndexJoin not found\n");
           return false;
         }
+      } else if (opt == "ensure:hash_join") {
+        if (!bustub::StringUtil::Contains(result.str(), "HashJoin")) {
+          fmt::print("HashJoin not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:merge_join") {
+        if (!bustub::StringUtil::Contains(result.str(), "MergeJoin")) {
+          fmt::print("MergeJoin not found\n");
+          return false;
+        }
       } else {
         throw bustub::NotImplementedException(fmt::format("unsupported extra option: {}", opt));
       }